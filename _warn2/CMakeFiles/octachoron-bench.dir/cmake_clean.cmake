@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/octachoron-bench.dir/src/microbench/harness.cpp.o"
+  "CMakeFiles/octachoron-bench.dir/src/microbench/harness.cpp.o.d"
+  "CMakeFiles/octachoron-bench.dir/src/microbench/main.cpp.o"
+  "CMakeFiles/octachoron-bench.dir/src/microbench/main.cpp.o.d"
+  "octachoron-bench"
+  "octachoron-bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/octachoron-bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,54 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/analyse.cpp" "CMakeFiles/octachoron-core.dir/src/analyse.cpp.o" "gcc" "CMakeFiles/octachoron-core.dir/src/analyse.cpp.o.d"
+  "/root/repo/src/book/book.cpp" "CMakeFiles/octachoron-core.dir/src/book/book.cpp.o" "gcc" "CMakeFiles/octachoron-core.dir/src/book/book.cpp.o.d"
+  "/root/repo/src/book/builder.cpp" "CMakeFiles/octachoron-core.dir/src/book/builder.cpp.o" "gcc" "CMakeFiles/octachoron-core.dir/src/book/builder.cpp.o.d"
+  "/root/repo/src/cluster.cpp" "CMakeFiles/octachoron-core.dir/src/cluster.cpp.o" "gcc" "CMakeFiles/octachoron-core.dir/src/cluster.cpp.o.d"
+  "/root/repo/src/data/loader.cpp" "CMakeFiles/octachoron-core.dir/src/data/loader.cpp.o" "gcc" "CMakeFiles/octachoron-core.dir/src/data/loader.cpp.o.d"
+  "/root/repo/src/data/packed.cpp" "CMakeFiles/octachoron-core.dir/src/data/packed.cpp.o" "gcc" "CMakeFiles/octachoron-core.dir/src/data/packed.cpp.o.d"
+  "/root/repo/src/datagen.cpp" "CMakeFiles/octachoron-core.dir/src/datagen.cpp.o" "gcc" "CMakeFiles/octachoron-core.dir/src/datagen.cpp.o.d"
+  "/root/repo/src/dedup.cpp" "CMakeFiles/octachoron-core.dir/src/dedup.cpp.o" "gcc" "CMakeFiles/octachoron-core.dir/src/dedup.cpp.o.d"
+  "/root/repo/src/dfpn.cpp" "CMakeFiles/octachoron-core.dir/src/dfpn.cpp.o" "gcc" "CMakeFiles/octachoron-core.dir/src/dfpn.cpp.o.d"
+  "/root/repo/src/dfpn_cache.cpp" "CMakeFiles/octachoron-core.dir/src/dfpn_cache.cpp.o" "gcc" "CMakeFiles/octachoron-core.dir/src/dfpn_cache.cpp.o.d"
+  "/root/repo/src/eval.cpp" "CMakeFiles/octachoron-core.dir/src/eval.cpp.o" "gcc" "CMakeFiles/octachoron-core.dir/src/eval.cpp.o.d"
+  "/root/repo/src/games/index.cpp" "CMakeFiles/octachoron-core.dir/src/games/index.cpp.o" "gcc" "CMakeFiles/octachoron-core.dir/src/games/index.cpp.o.d"
+  "/root/repo/src/games/reader.cpp" "CMakeFiles/octachoron-core.dir/src/games/reader.cpp.o" "gcc" "CMakeFiles/octachoron-core.dir/src/games/reader.cpp.o.d"
+  "/root/repo/src/games/record.cpp" "CMakeFiles/octachoron-core.dir/src/games/record.cpp.o" "gcc" "CMakeFiles/octachoron-core.dir/src/games/record.cpp.o.d"
+  "/root/repo/src/match.cpp" "CMakeFiles/octachoron-core.dir/src/match.cpp.o" "gcc" "CMakeFiles/octachoron-core.dir/src/match.cpp.o.d"
+  "/root/repo/src/mcts/search.cpp" "CMakeFiles/octachoron-core.dir/src/mcts/search.cpp.o" "gcc" "CMakeFiles/octachoron-core.dir/src/mcts/search.cpp.o.d"
+  "/root/repo/src/mcts/tree.cpp" "CMakeFiles/octachoron-core.dir/src/mcts/tree.cpp.o" "gcc" "CMakeFiles/octachoron-core.dir/src/mcts/tree.cpp.o.d"
+  "/root/repo/src/movegen.cpp" "CMakeFiles/octachoron-core.dir/src/movegen.cpp.o" "gcc" "CMakeFiles/octachoron-core.dir/src/movegen.cpp.o.d"
+  "/root/repo/src/perft.cpp" "CMakeFiles/octachoron-core.dir/src/perft.cpp.o" "gcc" "CMakeFiles/octachoron-core.dir/src/perft.cpp.o.d"
+  "/root/repo/src/policy.cpp" "CMakeFiles/octachoron-core.dir/src/policy.cpp.o" "gcc" "CMakeFiles/octachoron-core.dir/src/policy.cpp.o.d"
+  "/root/repo/src/position.cpp" "CMakeFiles/octachoron-core.dir/src/position.cpp.o" "gcc" "CMakeFiles/octachoron-core.dir/src/position.cpp.o.d"
+  "/root/repo/src/selfplay.cpp" "CMakeFiles/octachoron-core.dir/src/selfplay.cpp.o" "gcc" "CMakeFiles/octachoron-core.dir/src/selfplay.cpp.o.d"
+  "/root/repo/src/serve.cpp" "CMakeFiles/octachoron-core.dir/src/serve.cpp.o" "gcc" "CMakeFiles/octachoron-core.dir/src/serve.cpp.o.d"
+  "/root/repo/src/sprt.cpp" "CMakeFiles/octachoron-core.dir/src/sprt.cpp.o" "gcc" "CMakeFiles/octachoron-core.dir/src/sprt.cpp.o.d"
+  "/root/repo/src/spsa.cpp" "CMakeFiles/octachoron-core.dir/src/spsa.cpp.o" "gcc" "CMakeFiles/octachoron-core.dir/src/spsa.cpp.o.d"
+  "/root/repo/src/stats.cpp" "CMakeFiles/octachoron-core.dir/src/stats.cpp.o" "gcc" "CMakeFiles/octachoron-core.dir/src/stats.cpp.o.d"
+  "/root/repo/src/tb/generator.cpp" "CMakeFiles/octachoron-core.dir/src/tb/generator.cpp.o" "gcc" "CMakeFiles/octachoron-core.dir/src/tb/generator.cpp.o.d"
+  "/root/repo/src/tb/signature.cpp" "CMakeFiles/octachoron-core.dir/src/tb/signature.cpp.o" "gcc" "CMakeFiles/octachoron-core.dir/src/tb/signature.cpp.o.d"
+  "/root/repo/src/tb/table.cpp" "CMakeFiles/octachoron-core.dir/src/tb/table.cpp.o" "gcc" "CMakeFiles/octachoron-core.dir/src/tb/table.cpp.o.d"
+  "/root/repo/src/tb/tablebase.cpp" "CMakeFiles/octachoron-core.dir/src/tb/tablebase.cpp.o" "gcc" "CMakeFiles/octachoron-core.dir/src/tb/tablebase.cpp.o.d"
+  "/root/repo/src/tb/unmovegen.cpp" "CMakeFiles/octachoron-core.dir/src/tb/unmovegen.cpp.o" "gcc" "CMakeFiles/octachoron-core.dir/src/tb/unmovegen.cpp.o.d"
+  "/root/repo/src/telemetry.cpp" "CMakeFiles/octachoron-core.dir/src/telemetry.cpp.o" "gcc" "CMakeFiles/octachoron-core.dir/src/telemetry.cpp.o.d"
+  "/root/repo/src/tune.cpp" "CMakeFiles/octachoron-core.dir/src/tune.cpp.o" "gcc" "CMakeFiles/octachoron-core.dir/src/tune.cpp.o.d"
+  "/root/repo/src/util/mapped_file.cpp" "CMakeFiles/octachoron-core.dir/src/util/mapped_file.cpp.o" "gcc" "CMakeFiles/octachoron-core.dir/src/util/mapped_file.cpp.o.d"
+  "/root/repo/src/util/split.cpp" "CMakeFiles/octachoron-core.dir/src/util/split.cpp.o" "gcc" "CMakeFiles/octachoron-core.dir/src/util/split.cpp.o.d"
+  "/root/repo/src/util/worker_pool.cpp" "CMakeFiles/octachoron-core.dir/src/util/worker_pool.cpp.o" "gcc" "CMakeFiles/octachoron-core.dir/src/util/worker_pool.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
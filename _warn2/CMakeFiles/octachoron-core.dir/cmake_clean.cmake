@@ -0,0 +1,79 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/octachoron-core.dir/src/analyse.cpp.o"
+  "CMakeFiles/octachoron-core.dir/src/analyse.cpp.o.d"
+  "CMakeFiles/octachoron-core.dir/src/book/book.cpp.o"
+  "CMakeFiles/octachoron-core.dir/src/book/book.cpp.o.d"
+  "CMakeFiles/octachoron-core.dir/src/book/builder.cpp.o"
+  "CMakeFiles/octachoron-core.dir/src/book/builder.cpp.o.d"
+  "CMakeFiles/octachoron-core.dir/src/cluster.cpp.o"
+  "CMakeFiles/octachoron-core.dir/src/cluster.cpp.o.d"
+  "CMakeFiles/octachoron-core.dir/src/data/loader.cpp.o"
+  "CMakeFiles/octachoron-core.dir/src/data/loader.cpp.o.d"
+  "CMakeFiles/octachoron-core.dir/src/data/packed.cpp.o"
+  "CMakeFiles/octachoron-core.dir/src/data/packed.cpp.o.d"
+  "CMakeFiles/octachoron-core.dir/src/datagen.cpp.o"
+  "CMakeFiles/octachoron-core.dir/src/datagen.cpp.o.d"
+  "CMakeFiles/octachoron-core.dir/src/dedup.cpp.o"
+  "CMakeFiles/octachoron-core.dir/src/dedup.cpp.o.d"
+  "CMakeFiles/octachoron-core.dir/src/dfpn.cpp.o"
+  "CMakeFiles/octachoron-core.dir/src/dfpn.cpp.o.d"
+  "CMakeFiles/octachoron-core.dir/src/dfpn_cache.cpp.o"
+  "CMakeFiles/octachoron-core.dir/src/dfpn_cache.cpp.o.d"
+  "CMakeFiles/octachoron-core.dir/src/eval.cpp.o"
+  "CMakeFiles/octachoron-core.dir/src/eval.cpp.o.d"
+  "CMakeFiles/octachoron-core.dir/src/games/index.cpp.o"
+  "CMakeFiles/octachoron-core.dir/src/games/index.cpp.o.d"
+  "CMakeFiles/octachoron-core.dir/src/games/reader.cpp.o"
+  "CMakeFiles/octachoron-core.dir/src/games/reader.cpp.o.d"
+  "CMakeFiles/octachoron-core.dir/src/games/record.cpp.o"
+  "CMakeFiles/octachoron-core.dir/src/games/record.cpp.o.d"
+  "CMakeFiles/octachoron-core.dir/src/match.cpp.o"
+  "CMakeFiles/octachoron-core.dir/src/match.cpp.o.d"
+  "CMakeFiles/octachoron-core.dir/src/mcts/search.cpp.o"
+  "CMakeFiles/octachoron-core.dir/src/mcts/search.cpp.o.d"
+  "CMakeFiles/octachoron-core.dir/src/mcts/tree.cpp.o"
+  "CMakeFiles/octachoron-core.dir/src/mcts/tree.cpp.o.d"
+  "CMakeFiles/octachoron-core.dir/src/movegen.cpp.o"
+  "CMakeFiles/octachoron-core.dir/src/movegen.cpp.o.d"
+  "CMakeFiles/octachoron-core.dir/src/perft.cpp.o"
+  "CMakeFiles/octachoron-core.dir/src/perft.cpp.o.d"
+  "CMakeFiles/octachoron-core.dir/src/policy.cpp.o"
+  "CMakeFiles/octachoron-core.dir/src/policy.cpp.o.d"
+  "CMakeFiles/octachoron-core.dir/src/position.cpp.o"
+  "CMakeFiles/octachoron-core.dir/src/position.cpp.o.d"
+  "CMakeFiles/octachoron-core.dir/src/selfplay.cpp.o"
+  "CMakeFiles/octachoron-core.dir/src/selfplay.cpp.o.d"
+  "CMakeFiles/octachoron-core.dir/src/serve.cpp.o"
+  "CMakeFiles/octachoron-core.dir/src/serve.cpp.o.d"
+  "CMakeFiles/octachoron-core.dir/src/sprt.cpp.o"
+  "CMakeFiles/octachoron-core.dir/src/sprt.cpp.o.d"
+  "CMakeFiles/octachoron-core.dir/src/spsa.cpp.o"
+  "CMakeFiles/octachoron-core.dir/src/spsa.cpp.o.d"
+  "CMakeFiles/octachoron-core.dir/src/stats.cpp.o"
+  "CMakeFiles/octachoron-core.dir/src/stats.cpp.o.d"
+  "CMakeFiles/octachoron-core.dir/src/tb/generator.cpp.o"
+  "CMakeFiles/octachoron-core.dir/src/tb/generator.cpp.o.d"
+  "CMakeFiles/octachoron-core.dir/src/tb/signature.cpp.o"
+  "CMakeFiles/octachoron-core.dir/src/tb/signature.cpp.o.d"
+  "CMakeFiles/octachoron-core.dir/src/tb/table.cpp.o"
+  "CMakeFiles/octachoron-core.dir/src/tb/table.cpp.o.d"
+  "CMakeFiles/octachoron-core.dir/src/tb/tablebase.cpp.o"
+  "CMakeFiles/octachoron-core.dir/src/tb/tablebase.cpp.o.d"
+  "CMakeFiles/octachoron-core.dir/src/tb/unmovegen.cpp.o"
+  "CMakeFiles/octachoron-core.dir/src/tb/unmovegen.cpp.o.d"
+  "CMakeFiles/octachoron-core.dir/src/telemetry.cpp.o"
+  "CMakeFiles/octachoron-core.dir/src/telemetry.cpp.o.d"
+  "CMakeFiles/octachoron-core.dir/src/tune.cpp.o"
+  "CMakeFiles/octachoron-core.dir/src/tune.cpp.o.d"
+  "CMakeFiles/octachoron-core.dir/src/util/mapped_file.cpp.o"
+  "CMakeFiles/octachoron-core.dir/src/util/mapped_file.cpp.o.d"
+  "CMakeFiles/octachoron-core.dir/src/util/split.cpp.o"
+  "CMakeFiles/octachoron-core.dir/src/util/split.cpp.o.d"
+  "CMakeFiles/octachoron-core.dir/src/util/worker_pool.cpp.o"
+  "CMakeFiles/octachoron-core.dir/src/util/worker_pool.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/octachoron-core.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/octachoron-lib.dir/src/engine_api.cpp.o"
+  "CMakeFiles/octachoron-lib.dir/src/engine_api.cpp.o.d"
+  "liboctachoron.pdb"
+  "liboctachoron.so"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/octachoron-lib.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/octachoron-loader.dir/src/data/loader_api.cpp.o"
+  "CMakeFiles/octachoron-loader.dir/src/data/loader_api.cpp.o.d"
+  "liboctachoron-loader.pdb"
+  "liboctachoron-loader.so"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/octachoron-loader.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/octachoron.dir/src/main.cpp.o"
+  "CMakeFiles/octachoron.dir/src/main.cpp.o.d"
+  "octachoron"
+  "octachoron.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/octachoron.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
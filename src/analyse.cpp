@@ -0,0 +1,217 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "analyse.h"
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "position.h"
+#include "selfplay.h"
+#include "util/mapped_file.h"
+#include "util/reorder_buffer.h"
+
+namespace octachoron::analyse {
+    namespace {
+        // results may run this far ahead of the oldest one not yet written, per worker
+        constexpr usize kResultsPerWorker = 64;
+
+        constexpr auto kProgressInterval = std::chrono::seconds{10};
+
+        // fens have 4 fields, and EPD operations follow them
+        constexpr usize kFenFields = 4;
+
+        [[nodiscard]] std::vector<std::string_view> splitLines(std::string_view data) {
+            std::vector<std::string_view> lines{};
+
+            while (!data.empty()) {
+                auto end = data.find('\n');
+
+                if (end == std::string_view::npos) {
+                    end = data.size();
+                }
+
+                auto line = data.substr(0, end);
+
+                if (line.ends_with('\r')) {
+                    line.remove_suffix(1);
+                }
+
+                lines.push_back(line);
+                data.remove_prefix(std::min(end + 1, data.size()));
+            }
+
+            return lines;
+        }
+
+        // -> the fen fields of a line, or an empty view if it has too few
+        [[nodiscard]] std::string_view fenPart(std::string_view line) {
+            usize end = 0;
+
+            for (usize field = 0; field < kFenFields; ++field) {
+                const auto start = line.find_first_not_of(' ', end);
+
+                if (start == std::string_view::npos) {
+                    return {};
+                }
+
+                end = std::min(line.find(' ', start), line.size());
+            }
+
+            return line.substr(0, end);
+        }
+
+        [[nodiscard]] std::string analyseLine(mcts::Searcher& searcher, std::string_view line,
+            const mcts::SearchLimits& limits) {
+            const auto trimmed = line.substr(std::min(line.find_first_not_of(' '), line.size()));
+
+            if (trimmed.empty() || trimmed.front() == '#') {
+                return std::string{line};
+            }
+
+            const auto pos = Position::fromFen(fenPart(trimmed));
+
+            if (!pos) {
+                return std::string{line} + " | error";
+            }
+
+            std::ostringstream result{};
+            result << pos->toFen() << " | ";
+
+            if (const auto winner = selfplay::winner(*pos); winner != Colors::kNone) {
+                result << kNullMove << " | " << (winner == pos->stm() ? "1" : "-1") << " |";
+                return result.str();
+            }
+
+            // positions in a file have nothing to do with each other
+            searcher.newGame();
+
+            const auto info = searcher.search(*pos, limits);
+
+            result << info.bestMove << " | " << info.value << " |";
+
+            for (const auto move : info.pv) {
+                result << ' ' << move;
+            }
+
+            return result.str();
+        }
+    } // namespace
+
+    bool run(const Config& config) {
+        util::MappedFile input{};
+
+        if (!input.open(config.input)) {
+            std::cerr << "failed to open " << config.input << " (or it is empty)" << std::endl;
+            return false;
+        }
+
+        std::ofstream output{config.output, std::ios::trunc};
+
+        if (!output) {
+            std::cerr << "failed to open " << config.output << std::endl;
+            return false;
+        }
+
+        telemetry::JsonLinesWriter telemetry{};
+
+        if (!config.telemetry.empty() && !telemetry.open(config.telemetry)) {
+            std::cerr << "failed to open telemetry target " << config.telemetry << std::endl;
+            return false;
+        }
+
+        const auto lines = splitLines({reinterpret_cast<const char*>(input.data().data()), input.size()});
+
+        const auto workerCount = std::max<u32>(config.threads / config.threadsPerPosition, 1);
+
+        util::ReorderBuffer<std::string> results{workerCount * kResultsPerWorker};
+        std::atomic<usize> nextLine{0};
+
+        std::vector<std::unique_ptr<mcts::Searcher>> searchers{};
+        std::vector<std::thread> threads{};
+
+        for (u32 i = 0; i < workerCount; ++i) {
+            searchers.push_back(std::make_unique<mcts::Searcher>(config.treeMb, config.threadsPerPosition));
+
+            if (telemetry.isOpen()) {
+                searchers.back()->setTelemetry(&telemetry);
+            }
+        }
+
+        // before the workers start, so that the time covers all of their searching
+        const auto start = std::chrono::steady_clock::now();
+
+        for (auto& searcher : searchers) {
+            threads.emplace_back([&, searcher = searcher.get()] {
+                while (true) {
+                    const auto lineIdx = nextLine.fetch_add(1, std::memory_order::relaxed);
+
+                    if (lineIdx >= lines.size()) {
+                        break;
+                    }
+
+                    auto result = analyseLine(*searcher, lines[lineIdx], config.limits);
+
+                    while (!results.tryPut(lineIdx, result)) {
+                        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+                    }
+                }
+            });
+        }
+
+        auto lastProgress = start;
+
+        std::string result{};
+
+        while (results.next() < lines.size()) {
+            if (!results.tryTake(result)) {
+                std::this_thread::sleep_for(std::chrono::milliseconds{1});
+                continue;
+            }
+
+            output << result << '\n';
+
+            if (const auto now = std::chrono::steady_clock::now(); now - lastProgress >= kProgressInterval) {
+                std::cout << results.next() << " of " << lines.size() << " lines" << std::endl;
+                lastProgress = now;
+            }
+        }
+
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        const auto time = std::chrono::duration<f64>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << "analysed " << lines.size() << " lines in " << time << "s" << std::endl;
+
+        if (!output.flush()) {
+            std::cerr << "failed to write " << config.output << std::endl;
+            return false;
+        }
+
+        return true;
+    }
+} // namespace octachoron::analyse
@@ -0,0 +1,51 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "types.h"
+
+#include <string>
+
+#include "mcts/search.h"
+
+namespace octachoron::analyse {
+    struct Config {
+        std::string input{};
+        std::string output{};
+
+        // per position
+        mcts::SearchLimits limits{};
+
+        u32 threads{1};
+        // threads searching each position. positions in flight are threads / threadsPerPosition
+        u32 threadsPerPosition{1};
+        // per position in flight
+        usize treeMb{16};
+
+        // file or "fd:<n>" to write a JSON line per search to, none if empty
+        std::string telemetry{};
+    };
+
+    // Searches every line of a file of fens (or EPD lines, whose operations are ignored),
+    // several positions at once, each with its own small tree. Results are written in input
+    // order as "<fen> | <bestmove> | <value> | <pv>", with the value in [-1, 1] for the side
+    // to move. Blank lines and comments starting with '#' are copied through, and invalid
+    // lines are written back with "| error" appended, so output lines match input lines.
+    bool run(const Config& config);
+} // namespace octachoron::analyse
@@ -22,6 +22,8 @@
 
 #include "types.h"
 
+#include <bit>
+
 namespace octachoron {
     namespace offsets {
         constexpr i32 kNorthWest = 6;
@@ -32,6 +34,40 @@ namespace octachoron {
         constexpr i32 kSouthEast = -6;
     } // namespace offsets
 
+    namespace detail {
+        [[nodiscard]] constexpr u64 rowMask(u32 row) {
+            u64 mask{};
+
+            for (u32 column = 0; column < Cell::rowLength(row); ++column) {
+                mask |= Cell::fromCoords(row, column).bit();
+            }
+
+            return mask;
+        }
+
+        [[nodiscard]] constexpr u64 columnMask(u32 column) {
+            u64 mask{};
+
+            for (u32 row = 0; row < 7; ++row) {
+                if (column < Cell::rowLength(row)) {
+                    mask |= Cell::fromCoords(row, column).bit();
+                }
+            }
+
+            return mask;
+        }
+
+        [[nodiscard]] constexpr u64 eastBorderMask() {
+            u64 mask{};
+
+            for (u32 row = 0; row < 7; ++row) {
+                mask |= Cell::fromCoords(row, Cell::rowLength(row) - 1).bit();
+            }
+
+            return mask;
+        }
+    } // namespace detail
+
     class Bitboard {
     public:
         constexpr Bitboard() = default;
@@ -205,6 +241,25 @@ namespace octachoron {
             return m_bb;
         }
 
+        [[nodiscard]] constexpr bool empty() const {
+            return m_bb == 0;
+        }
+
+        [[nodiscard]] constexpr u32 popcount() const {
+            return static_cast<u32>(std::popcount(m_bb));
+        }
+
+        [[nodiscard]] constexpr Cell lowestCell() const {
+            assert(m_bb != 0);
+            return Cell::fromRaw(static_cast<u8>(std::countr_zero(m_bb)));
+        }
+
+        constexpr Cell popLowestCell() {
+            const auto cell = lowestCell();
+            m_bb &= m_bb - 1;
+            return cell;
+        }
+
         [[nodiscard]] constexpr bool operator==(const Bitboard&) const = default;
 
         constexpr Bitboard& operator=(const Bitboard&) = default;
@@ -226,26 +281,27 @@ namespace octachoron {
         static constexpr u64 kAll = UINT64_C(0x1fffffffffff);
         static constexpr u64 kEmpty = 0;
 
-        static constexpr u64 kRowA = UINT64_C(0x3f);
-        static constexpr u64 kRowB = UINT64_C(0x1fc0);
-        static constexpr u64 kRowC = UINT64_C(0x7e000);
-        static constexpr u64 kRowD = UINT64_C(0x3f80000);
-        static constexpr u64 kRowE = UINT64_C(0xfc000000);
-        static constexpr u64 kRowF = UINT64_C(0x7f00000000);
-        static constexpr u64 kRowG = UINT64_C(0x1f8000000000);
-
-        static constexpr u64 kColumn1 = UINT64_C(0x8104082041);
-        static constexpr u64 kColumn2 = UINT64_C(0x10208104082);
-        static constexpr u64 kColumn3 = UINT64_C(0x20410208104);
-        static constexpr u64 kColumn4 = UINT64_C(0x40820410208);
-        static constexpr u64 kColumn5 = UINT64_C(0x81040820410);
-        static constexpr u64 kColumn6 = UINT64_C(0x102081040820);
-        static constexpr u64 kColumn7 = UINT64_C(0x4002001000);
-
-        static constexpr u64 kEastBorder = UINT64_C(0x104082041020);
-
-        static constexpr u64 kBdf1 = UINT64_C(0x100080040);
-        static constexpr u64 kBdf7 = UINT64_C(0x4002001000);
+        static constexpr u64 kRowA = detail::rowMask(0);
+        static constexpr u64 kRowB = detail::rowMask(1);
+        static constexpr u64 kRowC = detail::rowMask(2);
+        static constexpr u64 kRowD = detail::rowMask(3);
+        static constexpr u64 kRowE = detail::rowMask(4);
+        static constexpr u64 kRowF = detail::rowMask(5);
+        static constexpr u64 kRowG = detail::rowMask(6);
+
+        static constexpr u64 kColumn1 = detail::columnMask(0);
+        static constexpr u64 kColumn2 = detail::columnMask(1);
+        static constexpr u64 kColumn3 = detail::columnMask(2);
+        static constexpr u64 kColumn4 = detail::columnMask(3);
+        static constexpr u64 kColumn5 = detail::columnMask(4);
+        static constexpr u64 kColumn6 = detail::columnMask(5);
+        static constexpr u64 kColumn7 = detail::columnMask(6);
+
+        static constexpr u64 kEastBorder = detail::eastBorderMask();
+
+        // first and last cells of the 7-cell rows b, d and f
+        static constexpr u64 kBdf1 = kColumn1 & (kRowB | kRowD | kRowF);
+        static constexpr u64 kBdf7 = kColumn7;
 
         friend struct Bitboards;
     };
@@ -0,0 +1,154 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "book.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+
+#include "../movegen.h"
+#include "../symmetry.h"
+
+namespace octachoron::book {
+    namespace {
+        constexpr std::array kMagic = {'O', 'C', 'B', 'K'};
+        constexpr u32 kVersion = 1;
+
+        struct FileHeader {
+            std::array<char, 4> magic;
+            u32 version;
+            u64 entryCount;
+        };
+
+        static_assert(sizeof(FileHeader) % alignof(Entry) == 0);
+    } // namespace
+
+    bool writeBook(const std::string& path, std::vector<Entry> entries) {
+        std::ranges::sort(entries, [](const Entry& a, const Entry& b) {
+            return a.key != b.key ? a.key < b.key : a.weight > b.weight;
+        });
+
+        FileHeader header{};
+
+        header.magic = kMagic;
+        header.version = kVersion;
+        header.entryCount = entries.size();
+
+        std::ofstream stream{path, std::ios::binary | std::ios::trunc};
+
+        if (!stream) {
+            return false;
+        }
+
+        stream.write(reinterpret_cast<const char*>(&header), sizeof(FileHeader));
+        stream.write(reinterpret_cast<const char*>(entries.data()),
+            static_cast<std::streamsize>(entries.size() * sizeof(Entry)));
+
+        return static_cast<bool>(stream);
+    }
+
+    bool Book::open(const std::string& path) {
+        close();
+
+        if (!m_file.open(path)) {
+            return false;
+        }
+
+        const auto data = m_file.data();
+
+        FileHeader header{};
+
+        if (data.size() >= sizeof(FileHeader)) {
+            std::memcpy(&header, data.data(), sizeof(FileHeader));
+        }
+
+        if (header.magic != kMagic || header.version != kVersion
+            || data.size() != sizeof(FileHeader) + header.entryCount * sizeof(Entry))
+        {
+            m_file.close();
+            return false;
+        }
+
+        // the header is a multiple of the entry alignment and mappings are page aligned
+        m_entries = {reinterpret_cast<const Entry*>(data.data() + sizeof(FileHeader)), header.entryCount};
+
+        return true;
+    }
+
+    void Book::close() {
+        m_file.close();
+        m_entries = {};
+    }
+
+    std::vector<BookMove> Book::probe(const Position& pos) const {
+        std::vector<BookMove> moves{};
+
+        const auto symmetry = pos.canonicalSymmetry();
+        const auto key = pos.canonicalKey();
+
+        const auto first =
+            std::ranges::lower_bound(m_entries, key, std::ranges::less{}, [](const Entry& entry) { return entry.key; });
+
+        if (first == m_entries.end() || first->key != key) {
+            return moves;
+        }
+
+        MoveList legal{};
+        generateAll(legal, pos);
+
+        for (auto entry = first; entry != m_entries.end() && entry->key == key; ++entry) {
+            // symmetries are their own inverses
+            const auto move = transform(Move::fromRaw(entry->move), symmetry);
+
+            // guards against key collisions and corrupt files
+            if (std::ranges::find(legal, move) != legal.end()) {
+                moves.push_back({move, entry->weight, entry->learn});
+            }
+        }
+
+        return moves;
+    }
+
+    Move Book::pick(const Position& pos, util::rng::Jsf64Rng& rng) const {
+        const auto moves = probe(pos);
+
+        u32 total = 0;
+
+        for (const auto& move : moves) {
+            total += move.weight;
+        }
+
+        if (total == 0) {
+            return kNullMove;
+        }
+
+        auto target = rng.nextU32(total);
+
+        for (const auto& move : moves) {
+            if (target < move.weight) {
+                return move.move;
+            }
+
+            target -= move.weight;
+        }
+
+        return kNullMove;
+    }
+} // namespace octachoron::book
@@ -0,0 +1,83 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "../types.h"
+
+#include <span>
+#include <string>
+#include <vector>
+
+#include "../move.h"
+#include "../position.h"
+#include "../util/mapped_file.h"
+#include "../util/rng.h"
+
+namespace octachoron::book {
+    // Book files hold a header and then entries sorted by key, then by descending weight.
+    // Positions are stored under their canonical key (see Position::canonicalKey), with
+    // moves in the canonical orientation, so one entry covers all symmetric positions.
+    struct Entry {
+        u64 key;
+        u32 move;
+        // relative to the position's other moves. zero weight moves are never picked
+        u16 weight;
+        // free for book learning. built books store the games or share of playouts behind a move
+        u16 learn;
+    };
+
+    static_assert(sizeof(Entry) == 16);
+
+    constexpr const char* kFileExtension = ".obk";
+
+    // sorts the entries first. keys must not repeat a move
+    bool writeBook(const std::string& path, std::vector<Entry> entries);
+
+    struct BookMove {
+        Move move;
+        u16 weight;
+        u16 learn;
+    };
+
+    // Maps a book file and binary searches it, so opening a book costs nothing however
+    // large it is. Read-only, safe to probe from any number of threads.
+    class Book {
+    public:
+        bool open(const std::string& path);
+        void close();
+
+        [[nodiscard]] inline bool isOpen() const {
+            return m_file.isOpen();
+        }
+
+        [[nodiscard]] inline usize size() const {
+            return m_entries.size();
+        }
+
+        // legal book moves for the position, highest weight first
+        [[nodiscard]] std::vector<BookMove> probe(const Position& pos) const;
+
+        // a book move picked at random in proportion to the weights, or a null move
+        [[nodiscard]] Move pick(const Position& pos, util::rng::Jsf64Rng& rng) const;
+
+    private:
+        util::MappedFile m_file{};
+        std::span<const Entry> m_entries{};
+    };
+} // namespace octachoron::book
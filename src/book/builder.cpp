@@ -0,0 +1,170 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "builder.h"
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "../mcts/search.h"
+#include "../selfplay.h"
+#include "../symmetry.h"
+
+namespace octachoron::book {
+    namespace {
+        constexpr usize kSearchTreeMb = 64;
+    } // namespace
+
+    void Builder::add(const Position& pos, Move move, u64 weight, u64 learn) {
+        const auto canonicalMove = transform(move, pos.canonicalSymmetry());
+
+        const std::scoped_lock lock{m_mutex};
+
+        auto& totals = m_moves[{pos.canonicalKey(), canonicalMove.raw()}];
+
+        totals.weight += weight;
+        totals.learn += learn;
+    }
+
+    void Builder::addGame(const Position& start, std::span<const Move> moves, data::Outcome outcome, u32 maxPlies) {
+        auto pos = start;
+
+        for (usize ply = 0; ply < moves.size() && ply < maxPlies; ++ply) {
+            // outcomes are half points for white
+            const auto whitePoints = static_cast<u64>(outcome);
+            const auto points = pos.stm() == Colors::kWhite ? whitePoints : 2 - whitePoints;
+
+            add(pos, moves[ply], points, 1);
+            pos = pos.applyMove(moves[ply]);
+        }
+    }
+
+    void Builder::addSearch(const Position& root, u32 depth, u64 playouts, f64 minShare, u32 threads) {
+        std::vector<Position> frontier{root};
+        std::unordered_set<u64> searched{root.canonicalKey()};
+
+        std::vector<std::unique_ptr<mcts::Searcher>> searchers{};
+
+        for (u32 i = 0; i < threads; ++i) {
+            searchers.push_back(std::make_unique<mcts::Searcher>(kSearchTreeMb, 1));
+        }
+
+        for (u32 ply = 0; ply < depth && !frontier.empty(); ++ply) {
+            std::vector<std::vector<Position>> children(threads);
+            std::atomic<usize> next{0};
+
+            std::vector<std::thread> workers{};
+
+            for (u32 i = 0; i < threads; ++i) {
+                workers.emplace_back([&, i] {
+                    auto& searcher = *searchers[i];
+
+                    for (auto idx = next.fetch_add(1); idx < frontier.size(); idx = next.fetch_add(1)) {
+                        const auto& pos = frontier[idx];
+
+                        searcher.newGame();
+                        static_cast<void>(searcher.search(pos, {playouts, {}}));
+
+                        for (const auto& rootMove : searcher.rootMoves()) {
+                            const auto share = static_cast<f64>(rootMove.visits) / static_cast<f64>(playouts);
+
+                            if (share < minShare) {
+                                break;
+                            }
+
+                            add(pos, rootMove.move, rootMove.visits, static_cast<u64>(share * 1000.0));
+
+                            const auto child = pos.applyMove(rootMove.move);
+
+                            if (!selfplay::isOver(child)) {
+                                children[i].push_back(child);
+                            }
+                        }
+                    }
+                });
+            }
+
+            for (auto& worker : workers) {
+                worker.join();
+            }
+
+            frontier.clear();
+
+            for (const auto& list : children) {
+                for (const auto& child : list) {
+                    if (searched.insert(child.canonicalKey()).second) {
+                        frontier.push_back(child);
+                    }
+                }
+            }
+
+            std::cout << "ply " << (ply + 1) << ": " << size() << " book moves" << std::endl;
+        }
+    }
+
+    usize Builder::size() {
+        const std::scoped_lock lock{m_mutex};
+        return m_moves.size();
+    }
+
+    bool Builder::write(const std::string& path) {
+        constexpr u64 kMaxValue = std::numeric_limits<u16>::max();
+
+        const std::scoped_lock lock{m_mutex};
+
+        std::vector<Entry> entries{};
+        entries.reserve(m_moves.size());
+
+        // the map is ordered by key, so each position's moves are contiguous
+        for (auto begin = m_moves.begin(); begin != m_moves.end();) {
+            auto end = begin;
+
+            u64 maxWeight = 0;
+            u64 maxLearn = 0;
+
+            for (; end != m_moves.end() && end->first.first == begin->first.first; ++end) {
+                maxWeight = std::max(maxWeight, end->second.weight);
+                maxLearn = std::max(maxLearn, end->second.learn);
+            }
+
+            const auto scale = [](u64 value, u64 max) {
+                if (max <= kMaxValue) {
+                    return static_cast<u16>(value);
+                }
+
+                // anything non-zero stays non-zero
+                return static_cast<u16>(value == 0 ? 0 : std::max<u64>(value * kMaxValue / max, 1));
+            };
+
+            for (auto it = begin; it != end; ++it) {
+                const auto [key, move] = it->first;
+                entries.push_back({key, move, scale(it->second.weight, maxWeight), scale(it->second.learn, maxLearn)});
+            }
+
+            begin = end;
+        }
+
+        return writeBook(path, std::move(entries));
+    }
+} // namespace octachoron::book
@@ -0,0 +1,66 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "../types.h"
+
+#include <map>
+#include <mutex>
+#include <span>
+#include <string>
+#include <utility>
+
+#include "../data/packed.h"
+#include "../move.h"
+#include "../position.h"
+#include "book.h"
+
+namespace octachoron::book {
+    // Accumulates weighted moves from any number of sources, then writes them out as a book.
+    // Weights are scaled down per position where they would not fit. Safe to feed from
+    // several threads.
+    class Builder {
+    public:
+        void add(const Position& pos, Move move, u64 weight, u64 learn);
+
+        // Every move of a game within maxPlies, weighted by the half points the side that
+        // played it went on to score. learn counts the games through each move.
+        void addGame(const Position& start, std::span<const Move> moves, data::Outcome outcome, u32 maxPlies);
+
+        // Searches every position up to depth plies from root along book moves: a move is kept,
+        // and followed, if it gets at least minShare of the root playouts. Weights are playouts
+        // and learn is the share in permille. Transpositions and symmetric positions are only
+        // searched once.
+        void addSearch(const Position& root, u32 depth, u64 playouts, f64 minShare, u32 threads);
+
+        [[nodiscard]] usize size();
+
+        bool write(const std::string& path);
+
+    private:
+        struct Totals {
+            u64 weight;
+            u64 learn;
+        };
+
+        std::mutex m_mutex{};
+        // keyed by canonical key and move in the canonical orientation
+        std::map<std::pair<u64, u32>, Totals> m_moves{};
+    };
+} // namespace octachoron::book
@@ -0,0 +1,602 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "cluster.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "selfplay.h"
+
+namespace octachoron::cluster {
+    namespace {
+        enum class MessageType : u8 {
+            // worker -> coordinator: u32 threads
+            kHello = 1,
+            // coordinator -> worker: fen, u64 playouts, u64 movetime in ms, u64 root noise seed
+            kSearch,
+            // worker -> coordinator: u64 playouts, f64 time in seconds,
+            // root moves as u32 count then (u32 move, u32 visits, f64 value), pv as u32 count then u32 moves
+            kReport,
+            // coordinator -> worker
+            kQuit,
+        };
+
+        // every frame is a u32 length, covering the type and the payload, then a u8 type
+        constexpr usize kMaxFrameSize = 1 << 20;
+
+        constexpr i32 kBacklog = 16;
+
+        class Socket {
+        public:
+            explicit Socket(i32 fd = -1) :
+                    m_fd{fd} {}
+
+            ~Socket() {
+                if (m_fd >= 0) {
+                    ::close(m_fd);
+                }
+            }
+
+            Socket(Socket&& other) noexcept :
+                    m_fd{std::exchange(other.m_fd, -1)} {}
+
+            Socket(const Socket&) = delete;
+
+            Socket& operator=(const Socket&) = delete;
+            Socket& operator=(Socket&&) = delete;
+
+            [[nodiscard]] i32 fd() const {
+                return m_fd;
+            }
+
+        private:
+            i32 m_fd;
+        };
+
+        class Writer {
+        public:
+            explicit Writer(MessageType type) {
+                m_data.resize(sizeof(u32));
+                put(static_cast<u8>(type));
+            }
+
+            template <typename T>
+            void put(T value) {
+                static_assert(std::is_trivially_copyable_v<T>);
+
+                const auto offset = m_data.size();
+
+                m_data.resize(offset + sizeof(T));
+                std::memcpy(&m_data[offset], &value, sizeof(T));
+            }
+
+            void putString(std::string_view str) {
+                put(static_cast<u32>(str.size()));
+                m_data += str;
+            }
+
+            // -> the whole frame, with its length filled in
+            [[nodiscard]] std::string_view finish() {
+                const auto length = static_cast<u32>(m_data.size() - sizeof(u32));
+                std::memcpy(m_data.data(), &length, sizeof(u32));
+
+                return m_data;
+            }
+
+        private:
+            std::string m_data{};
+        };
+
+        class Reader {
+        public:
+            explicit Reader(std::string_view data) :
+                    m_data{data} {}
+
+            template <typename T>
+            [[nodiscard]] bool get(T& dst) {
+                static_assert(std::is_trivially_copyable_v<T>);
+
+                if (m_data.size() < sizeof(T)) {
+                    return false;
+                }
+
+                std::memcpy(&dst, m_data.data(), sizeof(T));
+                m_data.remove_prefix(sizeof(T));
+
+                return true;
+            }
+
+            [[nodiscard]] bool getString(std::string& dst) {
+                u32 size{};
+
+                if (!get(size) || m_data.size() < size) {
+                    return false;
+                }
+
+                dst = m_data.substr(0, size);
+                m_data.remove_prefix(size);
+
+                return true;
+            }
+
+            // bytes not yet read
+            [[nodiscard]] inline usize remaining() const {
+                return m_data.size();
+            }
+
+        private:
+            std::string_view m_data;
+        };
+
+        struct Report {
+            u64 playouts{};
+            f64 timeSec{};
+            std::vector<mcts::RootMove> rootMoves{};
+            std::vector<Move> pv{};
+        };
+
+        bool sendAll(const Socket& socket, std::string_view data) {
+            while (!data.empty()) {
+                const auto result = ::send(socket.fd(), data.data(), data.size(), MSG_NOSIGNAL);
+
+                if (result < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+
+                    return false;
+                }
+
+                data.remove_prefix(static_cast<usize>(result));
+            }
+
+            return true;
+        }
+
+        bool recvAll(const Socket& socket, char* dst, usize size) {
+            while (size > 0) {
+                const auto result = ::recv(socket.fd(), dst, size, 0);
+
+                if (result < 0 && errno == EINTR) {
+                    continue;
+                }
+
+                if (result <= 0) {
+                    return false;
+                }
+
+                dst += result;
+                size -= static_cast<usize>(result);
+            }
+
+            return true;
+        }
+
+        bool sendFrame(const Socket& socket, Writer& writer) {
+            return sendAll(socket, writer.finish());
+        }
+
+        // -> false if the peer has gone away or sent something malformed
+        bool recvFrame(const Socket& socket, MessageType& type, std::string& payload) {
+            u32 length{};
+
+            if (!recvAll(socket, reinterpret_cast<char*>(&length), sizeof(length)) || length == 0
+                || length > kMaxFrameSize) {
+                return false;
+            }
+
+            payload.resize(length);
+
+            if (!recvAll(socket, payload.data(), length)) {
+                return false;
+            }
+
+            type = static_cast<MessageType>(payload.front());
+            payload.erase(0, 1);
+
+            return true;
+        }
+
+        // results are small and sent once per search, so waiting for more is pointless
+        void setNoDelay(const Socket& socket) {
+            const i32 enable = 1;
+            ::setsockopt(socket.fd(), IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+        }
+
+        [[nodiscard]] Socket connectTo(const std::string& host, u16 port) {
+            addrinfo hints{};
+            hints.ai_family = AF_UNSPEC;
+            hints.ai_socktype = SOCK_STREAM;
+
+            addrinfo* addresses{};
+
+            if (const auto error = ::getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &addresses);
+                error != 0) {
+                std::cerr << "failed to resolve " << host << ": " << ::gai_strerror(error) << std::endl;
+                return Socket{};
+            }
+
+            for (auto* address = addresses; address; address = address->ai_next) {
+                Socket socket{::socket(address->ai_family, address->ai_socktype | SOCK_CLOEXEC, address->ai_protocol)};
+
+                if (socket.fd() >= 0 && ::connect(socket.fd(), address->ai_addr, address->ai_addrlen) == 0) {
+                    ::freeaddrinfo(addresses);
+                    return socket;
+                }
+            }
+
+            std::cerr << "failed to connect to " << host << ":" << port << ": " << std::strerror(errno) << std::endl;
+
+            ::freeaddrinfo(addresses);
+            return Socket{};
+        }
+
+        [[nodiscard]] Socket listenOn(u16 port) {
+            Socket socket{::socket(AF_INET6, SOCK_STREAM | SOCK_CLOEXEC, 0)};
+
+            if (socket.fd() < 0) {
+                std::cerr << "failed to create socket: " << std::strerror(errno) << std::endl;
+                return Socket{};
+            }
+
+            // accept ipv4 as well, and do not wait out TIME_WAIT from a previous run
+            const i32 disable = 0;
+            const i32 enable = 1;
+
+            ::setsockopt(socket.fd(), IPPROTO_IPV6, IPV6_V6ONLY, &disable, sizeof(disable));
+            ::setsockopt(socket.fd(), SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+
+            sockaddr_in6 address{};
+            address.sin6_family = AF_INET6;
+            address.sin6_port = htons(port);
+            address.sin6_addr = in6addr_any;
+
+            if (::bind(socket.fd(), reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0
+                || ::listen(socket.fd(), kBacklog) != 0) {
+                std::cerr << "failed to listen on port " << port << ": " << std::strerror(errno) << std::endl;
+                return Socket{};
+            }
+
+            return socket;
+        }
+
+        [[nodiscard]] bool readReport(std::string_view payload, Report& report) {
+            // move, visits, value
+            constexpr usize kRootMoveSize = sizeof(u32) + sizeof(u32) + sizeof(f64);
+            constexpr usize kPvMoveSize = sizeof(u32);
+
+            Reader reader{payload};
+
+            u32 rootMoveCount{};
+
+            if (!reader.get(report.playouts) || !reader.get(report.timeSec) || !reader.get(rootMoveCount)) {
+                return false;
+            }
+
+            // counts come from the peer, so check them against the frame before allocating
+            if (rootMoveCount > reader.remaining() / kRootMoveSize) {
+                return false;
+            }
+
+            report.rootMoves.resize(rootMoveCount);
+
+            for (auto& rootMove : report.rootMoves) {
+                u32 move{};
+
+                if (!reader.get(move) || !reader.get(rootMove.visits) || !reader.get(rootMove.value)) {
+                    return false;
+                }
+
+                rootMove.move = Move::fromRaw(move);
+            }
+
+            u32 pvLength{};
+
+            if (!reader.get(pvLength) || pvLength > reader.remaining() / kPvMoveSize) {
+                return false;
+            }
+
+            report.pv.resize(pvLength);
+
+            for (auto& move : report.pv) {
+                u32 raw{};
+
+                if (!reader.get(raw)) {
+                    return false;
+                }
+
+                move = Move::fromRaw(raw);
+            }
+
+            return true;
+        }
+
+        [[nodiscard]] bool search(const Socket& socket, mcts::Searcher& searcher, std::string_view payload) {
+            Reader reader{payload};
+
+            std::string fen{};
+            u64 playouts{};
+            u64 movetime{};
+            u64 noiseSeed{};
+
+            if (!reader.getString(fen) || !reader.get(playouts) || !reader.get(movetime) || !reader.get(noiseSeed)) {
+                std::cerr << "malformed search request" << std::endl;
+                return false;
+            }
+
+            const auto pos = Position::fromFen(fen);
+
+            if (!pos) {
+                std::cerr << "invalid position " << fen << std::endl;
+                return false;
+            }
+
+            mcts::SearchLimits limits{};
+            limits.maxPlayouts = playouts;
+            limits.maxTime = std::chrono::milliseconds{movetime};
+            limits.noiseSeed = noiseSeed;
+
+            const auto info = searcher.search(*pos, limits);
+            const auto rootMoves = searcher.rootMoves();
+
+            std::cout << "searched " << fen << ": " << info.playouts << " playouts, bestmove " << info.bestMove
+                      << std::endl;
+
+            Writer writer{MessageType::kReport};
+
+            writer.put(info.playouts);
+            writer.put(info.timeSec);
+
+            writer.put(static_cast<u32>(rootMoves.size()));
+
+            for (const auto& rootMove : rootMoves) {
+                writer.put(rootMove.move.raw());
+                writer.put(rootMove.visits);
+                writer.put(rootMove.value);
+            }
+
+            writer.put(static_cast<u32>(info.pv.size()));
+
+            for (const auto move : info.pv) {
+                writer.put(move.raw());
+            }
+
+            return sendFrame(socket, writer);
+        }
+    } // namespace
+
+    bool runWorker(const WorkerConfig& config) {
+        const auto socket = connectTo(config.host, config.port);
+
+        if (socket.fd() < 0) {
+            return false;
+        }
+
+        setNoDelay(socket);
+
+        std::cout << "connected to " << config.host << ":" << config.port << std::endl;
+
+        Writer hello{MessageType::kHello};
+        hello.put(config.threads);
+
+        if (!sendFrame(socket, hello)) {
+            std::cerr << "failed to reach coordinator" << std::endl;
+            return false;
+        }
+
+        mcts::Searcher searcher{config.treeMb, config.threads};
+
+        MessageType type{};
+        std::string payload{};
+
+        // the coordinator closing the connection is as good as a quit
+        while (recvFrame(socket, type, payload) && type != MessageType::kQuit) {
+            if (type != MessageType::kSearch) {
+                std::cerr << "unexpected message " << static_cast<u32>(type) << std::endl;
+                return false;
+            }
+
+            if (!search(socket, searcher, payload)) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool runCoordinator(const CoordinatorConfig& config) {
+        if (selfplay::winner(config.pos) != Colors::kNone) {
+            std::cerr << "game already over" << std::endl;
+            return false;
+        }
+
+        const auto listener = listenOn(config.port);
+
+        if (listener.fd() < 0) {
+            return false;
+        }
+
+        std::cout << "waiting for " << config.workers << " workers on port " << config.port << std::endl;
+
+        std::vector<Socket> workers{};
+        std::vector<u32> workerThreads{};
+
+        u64 totalThreads = 0;
+
+        MessageType type{};
+        std::string payload{};
+
+        while (workers.size() < config.workers) {
+            Socket worker{::accept4(listener.fd(), nullptr, nullptr, SOCK_CLOEXEC)};
+
+            if (worker.fd() < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+
+                std::cerr << "accept failed: " << std::strerror(errno) << std::endl;
+                return false;
+            }
+
+            u32 threads{};
+
+            if (!recvFrame(worker, type, payload) || type != MessageType::kHello || !Reader{payload}.get(threads)
+                || threads == 0) {
+                std::cerr << "worker failed to introduce itself" << std::endl;
+                continue;
+            }
+
+            setNoDelay(worker);
+
+            totalThreads += threads;
+
+            workers.push_back(std::move(worker));
+            workerThreads.push_back(threads);
+
+            std::cout << "worker " << workers.size() << " joined with " << threads << " threads" << std::endl;
+        }
+
+        // shared out by threads, so that every worker takes about as long
+        const auto playoutsFor = [&](u64 threads) -> u64 {
+            if (config.limits.maxPlayouts == 0) {
+                return 0;
+            }
+
+            return std::max<u64>(config.limits.maxPlayouts * threads / totalThreads, 1);
+        };
+
+        const auto fen = config.pos.toFen();
+
+        std::vector<bool> searching(workers.size());
+
+        for (usize i = 0; i < workers.size(); ++i) {
+            Writer writer{MessageType::kSearch};
+
+            writer.putString(fen);
+            writer.put(playoutsFor(workerThreads[i]));
+            writer.put(static_cast<u64>(config.limits.maxTime.count()));
+            // the search is deterministic, so every worker but the first is
+            // perturbed differently, or they would all build the same tree
+            writer.put(static_cast<u64>(i));
+
+            searching[i] = sendFrame(workers[i], writer);
+        }
+
+        std::vector<Report> reports{};
+
+        for (usize i = 0; i < workers.size(); ++i) {
+            if (!searching[i]) {
+                std::cerr << "lost worker " << i + 1 << std::endl;
+                continue;
+            }
+
+            Report report{};
+
+            if (!recvFrame(workers[i], type, payload) || type != MessageType::kReport || !readReport(payload, report)) {
+                std::cerr << "lost worker " << i + 1 << std::endl;
+                continue;
+            }
+
+            reports.push_back(std::move(report));
+        }
+
+        for (const auto& worker : workers) {
+            Writer quit{MessageType::kQuit};
+            sendFrame(worker, quit);
+        }
+
+        if (reports.empty()) {
+            std::cerr << "no results" << std::endl;
+            return false;
+        }
+
+        struct MoveTotals {
+            u64 visits{};
+            f64 weightedValue{};
+        };
+
+        std::unordered_map<u32, MoveTotals> totals{};
+
+        u64 playouts = 0;
+        f64 timeSec = 0.0;
+
+        for (const auto& report : reports) {
+            playouts += report.playouts;
+            timeSec = std::max(timeSec, report.timeSec);
+
+            for (const auto& rootMove : report.rootMoves) {
+                auto& moveTotals = totals[rootMove.move.raw()];
+
+                moveTotals.visits += rootMove.visits;
+                moveTotals.weightedValue += rootMove.value * rootMove.visits;
+            }
+        }
+
+        const auto best = std::ranges::max_element(
+            totals, [](const auto& a, const auto& b) { return a.second.visits < b.second.visits; });
+
+        if (best == totals.end() || best->second.visits == 0) {
+            std::cerr << "no results" << std::endl;
+            return false;
+        }
+
+        const auto bestMove = Move::fromRaw(best->first);
+        const auto value = best->second.weightedValue / static_cast<f64>(best->second.visits);
+
+        // the line from the worker that looked hardest at the chosen move
+        std::vector<Move> pv{bestMove};
+        u32 mostVisits = 0;
+
+        for (const auto& report : reports) {
+            for (const auto& rootMove : report.rootMoves) {
+                if (rootMove.move == bestMove && rootMove.visits > mostVisits && !report.pv.empty()
+                    && report.pv.front() == bestMove) {
+                    pv = report.pv;
+                    mostVisits = rootMove.visits;
+                }
+            }
+        }
+
+        const auto pps = timeSec > 0.0 ? static_cast<u64>(static_cast<f64>(playouts) / timeSec) : 0;
+
+        std::cout << "info workers " << reports.size() << " playouts " << playouts << " time "
+                  << static_cast<u64>(timeSec * 1000.0) << " pps " << pps << " value " << value << " pv";
+
+        for (const auto move : pv) {
+            std::cout << ' ' << move;
+        }
+
+        std::cout << std::endl;
+        std::cout << "bestmove " << bestMove << std::endl;
+
+        return true;
+    }
+} // namespace octachoron::cluster
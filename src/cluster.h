@@ -0,0 +1,59 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "types.h"
+
+#include <string>
+
+#include "mcts/search.h"
+#include "position.h"
+
+namespace octachoron::cluster {
+    struct WorkerConfig {
+        std::string host{};
+        u16 port{};
+
+        u32 threads{1};
+        usize treeMb{64};
+    };
+
+    struct CoordinatorConfig {
+        u16 port{};
+        // waited for before searching
+        u32 workers{1};
+
+        Position pos{};
+        // playouts are for the whole cluster, and shared out between workers
+        mcts::SearchLimits limits{};
+    };
+
+    // Root-parallel search across processes, possibly on other hosts. Workers connect to the
+    // coordinator over TCP, and each searches the whole root with its own tree, every worker
+    // after the first with differently seeded noise in its root priors so that the trees
+    // differ. Their root move statistics come back in one message each at the end, and the
+    // coordinator adds up the visits per move to pick the best one. Messages use the native
+    // byte order, so all hosts must share it.
+
+    // connects and serves searches until the coordinator goes away
+    bool runWorker(const WorkerConfig& config);
+
+    // waits for the workers, runs one search across them and prints the result
+    bool runCoordinator(const CoordinatorConfig& config);
+} // namespace octachoron::cluster
@@ -211,7 +211,12 @@ namespace octachoron {
             assert(other.m_id != kNoneId);
             assert(other.m_id <= kScissorsId);
 
-            return fromRaw(0b10000 | (other.m_id << 2) | m_id);
+            // stacks on a wise come last, after the (mostly unused) stacks on rock, paper and scissors
+            if (other.m_id == kWiseId) {
+                return fromRaw(0b10000 | m_id);
+            }
+
+            return fromRaw((other.m_id << 2) | m_id);
         }
 
         [[nodiscard]] static constexpr PieceType fromRaw(u8 id) {
@@ -364,20 +369,20 @@ namespace octachoron {
 
         [[nodiscard]] constexpr Piece stackedOn(PieceType other) const {
             assert(m_id != kNoneId);
-            assert(m_id != kWhiteWiseId);
-            assert(m_id != kBlackWiseId);
             assert(m_id <= kBlackScissorsId);
 
-            assert(other != PieceTypes::kNone);
-            assert(other.raw() <= PieceTypes::kScissors.raw());
-
-            return fromRaw((other.raw() << 3) | m_id);
+            return type().stackedOn(other).withColor(color());
         }
 
         [[nodiscard]] constexpr Piece stackedOn(Piece other) const {
             return stackedOn(other.type());
         }
 
+        [[nodiscard]] constexpr Piece flipColor() const {
+            assert(m_id != kNoneId);
+            return Piece{static_cast<u8>(m_id ^ 1)};
+        }
+
         [[nodiscard]] static constexpr Piece fromRaw(u8 id) {
             assert(id <= kNoneId);
             return Piece{id};
@@ -566,6 +571,14 @@ namespace octachoron {
         static constexpr usize kCount = kNone.idx();
     };
 
+    static_assert(Pieces::kWhiteRock.stackedOn(Pieces::kWhitePaper) == Pieces::kWhiteRockOnPaper);
+    static_assert(Pieces::kBlackScissors.stackedOn(Pieces::kBlackRock) == Pieces::kBlackScissorsOnRock);
+    static_assert(Pieces::kWhiteWise.stackedOn(Pieces::kWhiteWise) == Pieces::kWhiteWiseOnWise);
+    static_assert(Pieces::kBlackPaper.stackedOn(Pieces::kBlackWise) == Pieces::kBlackPaperOnWise);
+    static_assert(Pieces::kBlackPaperOnWise.lower() == Pieces::kBlackWise);
+    static_assert(Pieces::kWhiteRockOnScissors.upper() == Pieces::kWhiteRock);
+    static_assert(Pieces::kWhiteRockOnScissors.lower() == Pieces::kWhiteScissors);
+
     class Cell {
     public:
         constexpr Cell() = default;
@@ -596,11 +609,55 @@ namespace octachoron {
             return fromRaw(kNoneId - m_id - 1);
         }
 
+        // left-right mirror image within the same row
+        [[nodiscard]] constexpr Cell mirror() const {
+            assert(m_id != kNoneId);
+            return fromCoords(row(), rowLength(row()) - 1 - column());
+        }
+
+        // rows alternate between 6 and 7 cells, starting from a, so every pair of rows is 13 cells
+        [[nodiscard]] constexpr u32 row() const {
+            assert(m_id != kNoneId);
+            return (m_id / 13) * 2 + (m_id % 13 >= 6);
+        }
+
+        [[nodiscard]] constexpr u32 column() const {
+            assert(m_id != kNoneId);
+            const u32 rem = m_id % 13;
+            return rem >= 6 ? rem - 6 : rem;
+        }
+
+        [[nodiscard]] static constexpr u32 rowLength(u32 row) {
+            assert(row < 7);
+            return 6 + (row & 1);
+        }
+
         [[nodiscard]] static constexpr Cell fromRaw(u8 id) {
             assert(id <= kNoneId);
             return Cell{id};
         }
 
+        [[nodiscard]] static constexpr Cell fromCoords(u32 row, u32 column) {
+            assert(row < 7);
+            assert(column < rowLength(row));
+            return Cell{static_cast<u8>((row / 2) * 13 + (row & 1) * 6 + column)};
+        }
+
+        // the inverse of operator<<, e.g. "d4". kNone if str is not a cell
+        [[nodiscard]] static constexpr Cell fromStr(std::string_view str) {
+            if (str.length() != 2 || str[0] < 'a' || str[0] > 'g') {
+                return Cell{kNoneId};
+            }
+
+            const auto row = static_cast<u32>(str[0] - 'a');
+
+            if (str[1] < '1' || static_cast<u32>(str[1] - '1') >= rowLength(row)) {
+                return Cell{kNoneId};
+            }
+
+            return fromCoords(row, static_cast<u32>(str[1] - '1'));
+        }
+
         [[nodiscard]] constexpr explicit operator bool() const {
             return m_id != kNoneId;
         }
@@ -0,0 +1,259 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "loader.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+#include "../nnue/features.h"
+#include "../util/rng.h"
+
+namespace octachoron::data {
+    namespace {
+        constexpr auto kIdleWait = std::chrono::microseconds{100};
+    } // namespace
+
+    Loader::~Loader() {
+        stop();
+    }
+
+    bool Loader::start(const LoaderConfig& config) {
+        stop();
+
+        if (config.files.empty() || config.batchSize == 0 || config.threads == 0) {
+            std::cerr << "invalid loader config" << std::endl;
+            return false;
+        }
+
+        m_config = config;
+        m_totalRecords = 0;
+        m_validRecords = 0;
+
+        for (const auto& file : config.files) {
+            auto& shard = m_shards.emplace_back(std::make_unique<PackedReader>());
+
+            if (!shard->open(file)) {
+                std::cerr << "failed to open " << file << std::endl;
+                m_shards.clear();
+                return false;
+            }
+
+            m_totalRecords += shard->size();
+
+            // invalid records are skipped as they are drawn. counted here so that they can be
+            // reported, and so that drawing knows there is something valid to find
+            const auto invalid = std::ranges::count_if(
+                shard->records(), [](const PackedPosition& record) { return !record.isValid(); });
+
+            if (invalid > 0) {
+                std::cerr << "skipping " << invalid << " invalid records in " << file << std::endl;
+            }
+
+            m_validRecords += shard->size() - static_cast<usize>(invalid);
+        }
+
+        if (m_validRecords == 0) {
+            std::cerr << "no valid records" << std::endl;
+            m_shards.clear();
+            return false;
+        }
+
+        // two batches in flight per decoding thread, plus one held by the trainer
+        const auto batchCount = config.threads * 2 + 1;
+
+        m_records = std::make_unique<util::BoundedQueue<RecordBatch>>(config.threads * 2);
+        m_free = std::make_unique<util::BoundedQueue<Batch*>>(batchCount);
+        m_ready = std::make_unique<util::BoundedQueue<Batch*>>(batchCount);
+
+        for (u32 i = 0; i < batchCount; ++i) {
+            auto& batch = m_batches.emplace_back(std::make_unique<Batch>());
+
+            batch->stmFeatures.resize(config.batchSize * nnue::kMaxActiveFeatures);
+            batch->nstmFeatures.resize(config.batchSize * nnue::kMaxActiveFeatures);
+            batch->scores.resize(config.batchSize);
+            batch->results.resize(config.batchSize);
+
+            auto* ptr = batch.get();
+            m_free->tryPush(ptr);
+        }
+
+        m_epoch.store(0, std::memory_order::relaxed);
+        m_stop.store(false, std::memory_order::relaxed);
+
+        m_threads.emplace_back([this] { shuffleRecords(); });
+
+        for (u32 i = 0; i < config.threads; ++i) {
+            m_threads.emplace_back([this] { decodeBatches(); });
+        }
+
+        return true;
+    }
+
+    void Loader::stop() {
+        m_stop.store(true, std::memory_order::relaxed);
+
+        for (auto& thread : m_threads) {
+            thread.join();
+        }
+
+        m_threads.clear();
+
+        m_current = nullptr;
+        m_batches.clear();
+
+        m_records.reset();
+        m_free.reset();
+        m_ready.reset();
+
+        m_shards.clear();
+    }
+
+    const Batch& Loader::next() {
+        assert(!m_threads.empty());
+
+        if (m_current) {
+            m_free->tryPush(m_current);
+        }
+
+        while (!m_ready->tryPop(m_current)) {
+            std::this_thread::sleep_for(kIdleWait);
+        }
+
+        return *m_current;
+    }
+
+    void Loader::shuffleRecords() {
+        util::rng::Jsf64Rng rng{m_config.seed};
+
+        std::vector<usize> cursors(m_shards.size());
+        u64 remaining = 0;
+
+        // picks a shard with probability proportional to what it has left, so every
+        // shard runs dry at about the same time, and takes its next record
+        const auto drawAny = [&] {
+            if (remaining == 0) {
+                std::ranges::fill(cursors, 0);
+                remaining = m_totalRecords;
+
+                m_epoch.fetch_add(1, std::memory_order::relaxed);
+            }
+
+            auto r = static_cast<u64>((static_cast<u128>(rng.nextU64()) * remaining) >> 64);
+
+            --remaining;
+
+            for (usize i = 0;; ++i) {
+                const auto left = m_shards[i]->size() - cursors[i];
+
+                if (r < left) {
+                    return m_shards[i]->records()[cursors[i]++];
+                }
+
+                r -= left;
+            }
+        };
+
+        // every epoch holds at least one valid record, so this always ends
+        const auto draw = [&] {
+            while (true) {
+                if (const auto record = drawAny(); record.isValid()) {
+                    return record;
+                }
+            }
+        };
+
+        std::vector<PackedPosition> window(std::clamp<u64>(m_config.shuffleWindow, 1, m_validRecords));
+
+        for (auto& record : window) {
+            record = draw();
+        }
+
+        const auto windowSize = static_cast<u32>(std::min<usize>(window.size(), UINT32_MAX));
+
+        RecordBatch batch{};
+
+        while (!m_stop.load(std::memory_order::relaxed)) {
+            batch.resize(m_config.batchSize);
+
+            for (auto& record : batch) {
+                auto& slot = window[rng.nextU32(windowSize)];
+
+                record = slot;
+                slot = draw();
+            }
+
+            while (!m_records->tryPush(batch)) {
+                if (m_stop.load(std::memory_order::relaxed)) {
+                    return;
+                }
+
+                std::this_thread::sleep_for(kIdleWait);
+            }
+        }
+    }
+
+    void Loader::decodeBatches() {
+        RecordBatch records{};
+        Batch* batch{};
+
+        while (!m_stop.load(std::memory_order::relaxed)) {
+            if (!m_records->tryPop(records)) {
+                std::this_thread::sleep_for(kIdleWait);
+                continue;
+            }
+
+            while (!m_free->tryPop(batch)) {
+                if (m_stop.load(std::memory_order::relaxed)) {
+                    return;
+                }
+
+                std::this_thread::sleep_for(kIdleWait);
+            }
+
+            batch->size = static_cast<u32>(records.size());
+
+            std::ranges::fill(batch->stmFeatures, -1);
+            std::ranges::fill(batch->nstmFeatures, -1);
+
+            for (usize i = 0; i < records.size(); ++i) {
+                const auto& record = records[i];
+                const auto pos = record.unpack();
+
+                const auto stm = pos.stm();
+
+                auto* stmFeatures = &batch->stmFeatures[i * nnue::kMaxActiveFeatures];
+                auto* nstmFeatures = &batch->nstmFeatures[i * nnue::kMaxActiveFeatures];
+
+                nnue::forEachFeature(pos, stm, [&](u32 feature) { *stmFeatures++ = static_cast<i32>(feature); });
+                nnue::forEachFeature(
+                    pos, stm.flip(), [&](u32 feature) { *nstmFeatures++ = static_cast<i32>(feature); });
+
+                // both are stored from white's point of view
+                const auto score = static_cast<f32>(record.score());
+                const auto result = static_cast<f32>(record.outcome()) / 2.0F;
+
+                batch->scores[i] = stm == Colors::kWhite ? score : -score;
+                batch->results[i] = stm == Colors::kWhite ? result : 1.0F - result;
+            }
+
+            m_ready->tryPush(batch);
+        }
+    }
+} // namespace octachoron::data
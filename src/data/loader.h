@@ -0,0 +1,113 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "../types.h"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../util/bounded_queue.h"
+#include "packed.h"
+
+namespace octachoron::data {
+    struct LoaderConfig {
+        std::vector<std::string> files{};
+
+        u32 batchSize{16384};
+        // records held back for shuffling. larger windows mix shards better at 32 bytes each
+        usize shuffleWindow{1 << 22};
+        // decoding threads, on top of the one reading and shuffling records
+        u32 threads{4};
+
+        u64 seed{};
+    };
+
+    // One batch of training positions. Feature lists hold nnue::kMaxActiveFeatures
+    // entries per position, padded with -1; scores and results are from the side to
+    // move's point of view, with results 0, 0.5 or 1.
+    struct Batch {
+        u32 size{};
+
+        std::vector<i32> stmFeatures{};
+        std::vector<i32> nstmFeatures{};
+
+        std::vector<f32> scores{};
+        std::vector<f32> results{};
+    };
+
+    // Streams shuffled batches from a set of packed files, endlessly. One thread draws records
+    // from the shards in proportion to what each has left, through a shuffle window, and the
+    // decoding threads turn whole batches of records into features. Each epoch visits every
+    // record exactly once.
+    class Loader {
+    public:
+        Loader() = default;
+        ~Loader();
+
+        Loader(const Loader&) = delete;
+        Loader(Loader&&) = delete;
+
+        // fails if no files are given or any of them cannot be read
+        bool start(const LoaderConfig& config);
+        void stop();
+
+        // blocks until a batch is ready. the batch stays valid until the next call
+        [[nodiscard]] const Batch& next();
+
+        [[nodiscard]] inline u64 totalRecords() const {
+            return m_totalRecords;
+        }
+
+        // epochs the shuffling thread has started
+        [[nodiscard]] inline u64 epoch() const {
+            return m_epoch.load(std::memory_order::relaxed);
+        }
+
+        Loader& operator=(const Loader&) = delete;
+        Loader& operator=(Loader&&) = delete;
+
+    private:
+        using RecordBatch = std::vector<PackedPosition>;
+
+        LoaderConfig m_config{};
+
+        std::vector<std::unique_ptr<PackedReader>> m_shards{};
+        u64 m_totalRecords{};
+        u64 m_validRecords{};
+
+        std::unique_ptr<util::BoundedQueue<RecordBatch>> m_records{};
+        std::unique_ptr<util::BoundedQueue<Batch*>> m_free{};
+        std::unique_ptr<util::BoundedQueue<Batch*>> m_ready{};
+
+        std::vector<std::unique_ptr<Batch>> m_batches{};
+        Batch* m_current{};
+
+        std::atomic<u64> m_epoch{};
+        std::atomic_bool m_stop{};
+
+        std::vector<std::thread> m_threads{};
+
+        void shuffleRecords();
+        void decodeBatches();
+    };
+} // namespace octachoron::data
@@ -0,0 +1,84 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "loader_api.h"
+
+#include "../types.h"
+
+#include <exception>
+#include <iostream>
+#include <memory>
+
+#include "../nnue/features.h"
+#include "loader.h"
+
+using namespace octachoron;
+
+struct OcLoader {
+    data::Loader loader{};
+};
+
+uint32_t oc_loader_input_size(void) {
+    return nnue::kInputSize;
+}
+
+OcLoader* oc_loader_create(const char* const* files, uint32_t fileCount, uint32_t batchSize, uint64_t shuffleWindow,
+    uint32_t threads, uint64_t seed) {
+    // exceptions must not unwind through the C interface
+    try {
+        data::LoaderConfig config{};
+
+        config.files.assign(files, files + fileCount);
+        config.batchSize = batchSize;
+        config.shuffleWindow = shuffleWindow;
+        config.threads = threads;
+        config.seed = seed;
+
+        auto loader = std::make_unique<OcLoader>();
+
+        if (!loader->loader.start(config)) {
+            return nullptr;
+        }
+
+        return loader.release();
+    } catch (const std::exception& e) {
+        std::cerr << "failed to create loader: " << e.what() << std::endl;
+        return nullptr;
+    }
+}
+
+void oc_loader_next(OcLoader* loader, OcBatch* batch) {
+    const auto& next = loader->loader.next();
+
+    batch->size = next.size;
+    batch->maxFeatures = nnue::kMaxActiveFeatures;
+
+    batch->stmFeatures = next.stmFeatures.data();
+    batch->nstmFeatures = next.nstmFeatures.data();
+
+    batch->scores = next.scores.data();
+    batch->results = next.results.data();
+}
+
+uint64_t oc_loader_epoch(const OcLoader* loader) {
+    return loader->loader.epoch();
+}
+
+void oc_loader_destroy(OcLoader* loader) {
+    delete loader;
+}
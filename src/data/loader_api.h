@@ -0,0 +1,69 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+// C interface to the training data loader, built as the octachoron-loader shared
+// library so trainers can load it through ctypes or cffi. See data/loader.h.
+
+#include <stdint.h>
+
+// the only symbols the shared library exports
+#ifndef OC_API
+    #if defined(__GNUC__)
+        #define OC_API __attribute__((visibility("default")))
+    #else
+        #define OC_API
+    #endif
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct OcLoader OcLoader;
+
+typedef struct OcBatch {
+    uint32_t size;
+    // entries per position in each feature array, unused entries are -1
+    uint32_t maxFeatures;
+
+    const int32_t* stmFeatures;
+    const int32_t* nstmFeatures;
+
+    const float* scores;
+    const float* results;
+} OcBatch;
+
+// number of distinct input features
+OC_API uint32_t oc_loader_input_size(void);
+
+// -> null on failure, with the reason printed to stderr
+OC_API OcLoader* oc_loader_create(const char* const* files, uint32_t fileCount, uint32_t batchSize,
+    uint64_t shuffleWindow, uint32_t threads, uint64_t seed);
+
+// blocks until the next batch is ready. its arrays stay valid until the next call
+OC_API void oc_loader_next(OcLoader* loader, OcBatch* batch);
+
+OC_API uint64_t oc_loader_epoch(const OcLoader* loader);
+
+OC_API void oc_loader_destroy(OcLoader* loader);
+
+#ifdef __cplusplus
+}
+#endif
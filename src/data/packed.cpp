@@ -0,0 +1,200 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "packed.h"
+
+#include <algorithm>
+
+namespace octachoron::data {
+    PackedPosition PackedPosition::pack(const Position& pos, i16 score, Outcome outcome) {
+        PackedPosition packed{};
+
+        auto occupied = pos.occupancyBb();
+        assert(occupied.popcount() <= kMaxUnits);
+
+        packed.m_occupancy = occupied.raw() | (static_cast<u64>(outcome) << kOutcomeShift);
+
+        if (pos.stm() == Colors::kBlack) {
+            packed.m_occupancy |= UINT64_C(1) << kStmShift;
+        }
+
+        packed.m_pieces = {};
+
+        for (usize bit = 0; !occupied.empty(); bit += 6) {
+            const u32 id = pos.pieceOn(occupied.popLowestCell()).raw();
+
+            packed.m_pieces[bit / 8] |= static_cast<u8>(id << (bit % 8));
+
+            if (bit % 8 > 2) {
+                packed.m_pieces[bit / 8 + 1] |= static_cast<u8>(id >> (8 - bit % 8));
+            }
+        }
+
+        packed.m_halfmoves = static_cast<u8>(std::min<u32>(pos.halfmoves(), 255));
+        packed.m_score = score;
+
+        return packed;
+    }
+
+    bool PackedPosition::isValid() const {
+        if ((m_occupancy & kUnusedMask) != 0 || outcome() > Outcome::kWhiteWin) {
+            return false;
+        }
+
+        const auto units = occupancy().popcount();
+
+        if (units > kMaxUnits) {
+            return false;
+        }
+
+        for (usize idx = 0; idx < units; ++idx) {
+            const auto id = pieceId(idx);
+
+            if (id >= Pieces::kNone.raw()) {
+                return false;
+            }
+
+            // ids are set aside for a wise on top of anything but another wise, which cannot happen
+            const auto piece = Piece::fromRaw(id);
+
+            if (piece.isStack() && piece.upper().role() == Roles::kWise && piece.lower().role() != Roles::kWise) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    Position PackedPosition::unpack() const {
+        assert(isValid());
+
+        std::array<Piece, Cells::kCount> mailbox{};
+        mailbox.fill(Pieces::kNone);
+
+        auto occupied = occupancy();
+
+        for (usize idx = 0; !occupied.empty(); ++idx) {
+            mailbox[occupied.popLowestCell().idx()] = Piece::fromRaw(pieceId(idx));
+        }
+
+        return Position::fromMailbox(mailbox, stm(), m_halfmoves);
+    }
+
+    u8 PackedPosition::pieceId(usize idx) const {
+        const auto bit = idx * 6;
+
+        u32 bits = m_pieces[bit / 8] >> (bit % 8);
+
+        if (bit % 8 > 2) {
+            bits |= static_cast<u32>(m_pieces[bit / 8 + 1]) << (8 - bit % 8);
+        }
+
+        return static_cast<u8>(bits & 0b111111);
+    }
+
+    PackedWriter::~PackedWriter() {
+        close();
+    }
+
+    bool PackedWriter::open(const std::string& path) {
+        close();
+
+        m_file = std::fopen(path.c_str(), "ab");
+        m_buffer.reserve(kBufferedRecords);
+
+        return m_file != nullptr;
+    }
+
+    bool PackedWriter::close() {
+        if (!m_file) {
+            return true;
+        }
+
+        const auto flushed = flush();
+        const auto closed = std::fclose(m_file) == 0;
+
+        m_file = nullptr;
+
+        return flushed && closed;
+    }
+
+    bool PackedWriter::write(const PackedPosition& record) {
+        assert(m_file);
+
+        m_buffer.push_back(record);
+
+        if (m_buffer.size() >= kBufferedRecords) {
+            return flush();
+        }
+
+        return true;
+    }
+
+    bool PackedWriter::write(std::span<const PackedPosition> records) {
+        assert(m_file);
+
+        if (m_buffer.size() + records.size() < kBufferedRecords) {
+            m_buffer.insert(m_buffer.end(), records.begin(), records.end());
+            return true;
+        }
+
+        if (!flush()) {
+            return false;
+        }
+
+        return std::fwrite(records.data(), sizeof(PackedPosition), records.size(), m_file) == records.size();
+    }
+
+    bool PackedWriter::flush() {
+        if (!m_file) {
+            return false;
+        }
+
+        const auto written = std::fwrite(m_buffer.data(), sizeof(PackedPosition), m_buffer.size(), m_file);
+        const auto success = written == m_buffer.size() && std::fflush(m_file) == 0;
+
+        m_buffer.clear();
+
+        return success;
+    }
+
+    bool PackedReader::open(const std::string& path) {
+        close();
+
+        if (!m_file.open(path)) {
+            return false;
+        }
+
+        const auto data = m_file.data();
+
+        if (data.size() % sizeof(PackedPosition) != 0) {
+            m_file.close();
+            return false;
+        }
+
+        // mappings are page aligned
+        m_records = {reinterpret_cast<const PackedPosition*>(data.data()), data.size() / sizeof(PackedPosition)};
+
+        return true;
+    }
+
+    void PackedReader::close() {
+        m_file.close();
+        m_records = {};
+    }
+} // namespace octachoron::data
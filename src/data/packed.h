@@ -0,0 +1,153 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "../types.h"
+
+#include <array>
+#include <cstdio>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "../position.h"
+#include "../util/mapped_file.h"
+
+namespace octachoron::data {
+    // game result from white's point of view
+    enum class Outcome : u8 {
+        kBlackWin = 0,
+        kDraw,
+        kWhiteWin,
+    };
+
+    // One training position in 32 bytes, against roughly 60 for a fen:
+    //  - occupancy, with the result in bits 61-62 and the side to move in bit 63 (set for black)
+    //  - the piece id of every occupied cell as 6 bits, lowest cell first
+    //  - the halfmove counter
+    //  - the score, from white's point of view
+    // Files are plain arrays of these, little endian, with no header.
+    class PackedPosition {
+    public:
+        // the most units legal play can leave on the board: every piece unstacked
+        static constexpr usize kMaxUnits = 28;
+
+        [[nodiscard]] static PackedPosition pack(const Position& pos, i16 score, Outcome outcome);
+
+        // Records are read straight from files, so a corrupt one could hold more units than the
+        // board allows or piece ids that do not exist. Readers check this before unpacking.
+        [[nodiscard]] bool isValid() const;
+
+        // the record must be valid
+        [[nodiscard]] Position unpack() const;
+
+        [[nodiscard]] inline Bitboard occupancy() const {
+            return Bitboard{m_occupancy & kOccupancyMask};
+        }
+
+        [[nodiscard]] inline Color stm() const {
+            return (m_occupancy >> kStmShift) ? Colors::kBlack : Colors::kWhite;
+        }
+
+        [[nodiscard]] inline Outcome outcome() const {
+            return static_cast<Outcome>((m_occupancy >> kOutcomeShift) & 0b11);
+        }
+
+        [[nodiscard]] inline i16 score() const {
+            return m_score;
+        }
+
+        [[nodiscard]] inline u32 halfmoves() const {
+            return m_halfmoves;
+        }
+
+    private:
+        static constexpr u64 kOccupancyMask = (UINT64_C(1) << Cells::kCount) - 1;
+        static constexpr i32 kOutcomeShift = 61;
+        static constexpr i32 kStmShift = 63;
+
+        // bits between the occupancy and the result, always clear
+        static constexpr u64 kUnusedMask = ((UINT64_C(1) << kOutcomeShift) - 1) & ~kOccupancyMask;
+
+        u64 m_occupancy;
+        std::array<u8, kMaxUnits * 6 / 8> m_pieces;
+        u8 m_halfmoves;
+        i16 m_score;
+
+        // raw piece id of the idx-th occupied cell, lowest first
+        [[nodiscard]] u8 pieceId(usize idx) const;
+    };
+
+    static_assert(sizeof(PackedPosition) == 32);
+
+    // Buffers records and writes them out in large blocks.
+    class PackedWriter {
+    public:
+        PackedWriter() = default;
+        ~PackedWriter();
+
+        PackedWriter(const PackedWriter&) = delete;
+        PackedWriter(PackedWriter&&) = delete;
+
+        // appends to the file if it exists
+        bool open(const std::string& path);
+        bool close();
+
+        [[nodiscard]] inline bool isOpen() const {
+            return m_file != nullptr;
+        }
+
+        bool write(const PackedPosition& record);
+        bool write(std::span<const PackedPosition> records);
+        bool flush();
+
+        PackedWriter& operator=(const PackedWriter&) = delete;
+        PackedWriter& operator=(PackedWriter&&) = delete;
+
+    private:
+        static constexpr usize kBufferedRecords = 1 << 16;
+
+        std::FILE* m_file{};
+        std::vector<PackedPosition> m_buffer{};
+    };
+
+    // Maps a file and hands out its records in place.
+    class PackedReader {
+    public:
+        // fails if the file cannot be mapped or is not a whole number of records
+        bool open(const std::string& path);
+        void close();
+
+        [[nodiscard]] inline std::span<const PackedPosition> records() const {
+            return m_records;
+        }
+
+        [[nodiscard]] inline usize size() const {
+            return m_records.size();
+        }
+
+        [[nodiscard]] inline Position operator[](usize idx) const {
+            return m_records[idx].unpack();
+        }
+
+    private:
+        util::MappedFile m_file{};
+        std::span<const PackedPosition> m_records{};
+    };
+} // namespace octachoron::data
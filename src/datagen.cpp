@@ -0,0 +1,251 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "datagen.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "book/book.h"
+#include "data/packed.h"
+#include "mcts/search.h"
+#include "position.h"
+#include "selfplay.h"
+#include "util/bounded_queue.h"
+#include "util/rng.h"
+
+namespace octachoron::datagen {
+    namespace {
+        constexpr usize kQueueCapacity = 1024;
+
+        constexpr auto kProgressInterval = std::chrono::seconds{10};
+
+        struct Sample {
+            Position pos;
+            // white's point of view
+            i32 score;
+        };
+
+        struct Game {
+            std::vector<Sample> samples;
+            // white's point of view: 0 for a loss, 1 for a draw, 2 for a win
+            u8 result;
+        };
+
+        [[nodiscard]] bool isNoisy(const Position& pos, Move move) {
+            const auto child = pos.applyMove(move);
+            const auto them = pos.stm().flip();
+
+            return child.winner() != Colors::kNone
+                || child.colorBb(them).popcount() < pos.colorBb(them).popcount();
+        }
+
+        class Worker {
+        public:
+            Worker(const Config& config, u32 idx, util::BoundedQueue<Game>& queue, const book::Book* book) :
+                    m_config{config},
+                    m_queue{queue},
+                    m_book{book},
+                    m_rng{config.seed + idx * UINT64_C(0x9e3779b97f4a7c15)},
+                    m_searcher{config.treeMb, 1},
+                    m_quota{(config.positions + config.threads - 1) / config.threads} {}
+
+            void run() {
+                u64 produced = 0;
+
+                while (produced < m_quota) {
+                    auto game = playGame();
+                    produced += game.samples.size();
+
+                    while (!m_queue.tryPush(game)) {
+                        std::this_thread::yield();
+                    }
+                }
+            }
+
+        private:
+            const Config& m_config;
+            util::BoundedQueue<Game>& m_queue;
+
+            const book::Book* m_book;
+
+            util::rng::Jsf64Rng m_rng;
+            mcts::Searcher m_searcher;
+
+            u64 m_quota;
+
+            [[nodiscard]] Game playGame() {
+                Game game{};
+
+                m_searcher.newGame();
+
+                auto pos = selfplay::randomOpening(m_rng, m_config.randomPlies, m_book);
+
+                // drawn unless someone wins before the ply limit
+                game.result = 1;
+
+                for (u32 ply = 0; ply < m_config.maxPlies; ++ply) {
+                    if (const auto winner = selfplay::winner(pos); winner != Colors::kNone) {
+                        game.result = winner == Colors::kWhite ? 2 : 0;
+                        break;
+                    }
+
+                    const auto info = m_searcher.search(pos, {m_config.playouts, {}});
+
+                    if (!isNoisy(pos, info.bestMove)) {
+                        // invert the search's tanh mapping to get back to eval units
+                        const auto value = std::clamp(info.value, -0.999, 0.999);
+                        const auto score = static_cast<i32>(
+                            std::lround(std::atanh(value) * m_searcher.params().valueScale()));
+
+                        game.samples.push_back({pos, pos.stm() == Colors::kWhite ? score : -score});
+                    }
+
+                    pos = pos.applyMove(info.bestMove);
+                }
+
+                return game;
+            }
+        };
+    } // namespace
+
+    bool run(const Config& config) {
+        std::ofstream text{};
+        data::PackedWriter packed{};
+
+        if (config.format == Format::kText) {
+            text.open(config.output, std::ios::app);
+        } else {
+            packed.open(config.output);
+        }
+
+        if (!text.is_open() && !packed.isOpen()) {
+            std::cerr << "failed to open " << config.output << std::endl;
+            return false;
+        }
+
+        book::Book book{};
+
+        if (!config.book.empty() && !book.open(config.book)) {
+            std::cerr << "failed to open book " << config.book << std::endl;
+            return false;
+        }
+
+        util::BoundedQueue<Game> queue{kQueueCapacity};
+
+        std::vector<std::unique_ptr<Worker>> workers{};
+        std::vector<std::thread> threads{};
+
+        std::atomic<u32> finished{0};
+
+        for (u32 i = 0; i < config.threads; ++i) {
+            workers.push_back(std::make_unique<Worker>(config, i, queue, book.isOpen() ? &book : nullptr));
+        }
+
+        for (auto& worker : workers) {
+            threads.emplace_back([&worker, &finished] {
+                worker->run();
+                finished.fetch_add(1, std::memory_order::release);
+            });
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        auto lastProgress = start;
+
+        u64 positions = 0;
+        u64 games = 0;
+
+        const auto printProgress = [&] {
+            const auto time = std::chrono::duration<f64>(std::chrono::steady_clock::now() - start).count();
+            const auto rate = time > 0.0 ? static_cast<u64>(static_cast<f64>(positions) / time) : 0;
+
+            std::cout << games << " games, " << positions << " positions, " << rate << " positions/s" << std::endl;
+        };
+
+        constexpr std::array kResults = {"0.0", "0.5", "1.0"};
+
+        bool success = true;
+
+        const auto write = [&](const Game& game) {
+            for (const auto& sample : game.samples) {
+                if (config.format == Format::kText) {
+                    text << sample.pos.toFen() << " | " << sample.score << " | " << kResults[game.result] << '\n';
+                } else {
+                    const auto score = static_cast<i16>(std::clamp<i32>(sample.score, INT16_MIN, INT16_MAX));
+                    const auto outcome = static_cast<data::Outcome>(game.result);
+
+                    success &= packed.write(data::PackedPosition::pack(sample.pos, score, outcome));
+                }
+            }
+
+            positions += game.samples.size();
+            ++games;
+
+            if (const auto now = std::chrono::steady_clock::now(); now - lastProgress >= kProgressInterval) {
+                printProgress();
+                lastProgress = now;
+            }
+        };
+
+        Game game{};
+
+        while (true) {
+            if (queue.tryPop(game)) {
+                write(game);
+                continue;
+            }
+
+            // everything a worker pushed is visible once its finish is
+            if (finished.load(std::memory_order::acquire) == config.threads) {
+                while (queue.tryPop(game)) {
+                    write(game);
+                }
+
+                break;
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds{1});
+        }
+
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        printProgress();
+
+        if (config.format == Format::kText) {
+            success &= static_cast<bool>(text.flush());
+        } else {
+            success &= packed.close();
+        }
+
+        if (!success) {
+            std::cerr << "failed to write " << config.output << std::endl;
+        }
+
+        return success;
+    }
+} // namespace octachoron::datagen
@@ -0,0 +1,60 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "types.h"
+
+#include <string>
+
+namespace octachoron::datagen {
+    enum class Format : u8 {
+        kPacked,
+        kText,
+    };
+
+    struct Config {
+        std::string output{};
+        Format format{Format::kPacked};
+
+        u32 threads{1};
+        // stop once at least this many positions have been written
+        u64 positions{1000000};
+
+        // per move
+        u64 playouts{400};
+        usize treeMb{16};
+
+        // openings are drawn from this book first, if given
+        std::string book{};
+        // uniformly random legal moves at the start of each game, after any book moves
+        u32 randomPlies{8};
+        // games this long are scored as draws
+        u32 maxPlies{400};
+
+        u64 seed{};
+    };
+
+    // Every thread plays self-play games with its own MCTS searcher at a fixed number of
+    // playouts per move, and hands finished games to a lock-free queue drained by the calling
+    // thread. Positions where the game is over, or where the move played captures or wins,
+    // are not recorded. Output is appended either as packed records (see data/packed.h) or as
+    // "<fen> | <score> | <result>" lines, with the score and result (1.0, 0.5 or 0.0) from
+    // white's point of view.
+    bool run(const Config& config);
+} // namespace octachoron::datagen
@@ -0,0 +1,376 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "dedup.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "data/packed.h"
+#include "util/bloom_filter.h"
+
+namespace octachoron::dedup {
+    namespace {
+        constexpr usize kChunkSize = 1 << 16;
+
+        // Open addressed hash set of 64-bit keys, split into independently locked shards.
+        // The low two bits of every slot are flags, so keys differing only in those are
+        // treated as equal, which is harmless at one in 2^62.
+        class KeySet {
+        public:
+            enum class InsertResult {
+                kInserted,
+                kPresent,
+                kFull,
+            };
+
+            enum class ClaimResult {
+                kAbsent,
+                kClaimed,
+                kAlreadyClaimed,
+            };
+
+            explicit KeySet(usize bytes) :
+                    m_slotsPerShard{std::bit_floor(std::max<usize>(bytes / sizeof(u64) / kShardCount, 64))},
+                    m_shards{std::make_unique<Shard[]>(kShardCount)} {
+                for (usize i = 0; i < kShardCount; ++i) {
+                    m_shards[i].slots = std::make_unique<u64[]>(m_slotsPerShard);
+                }
+            }
+
+            [[nodiscard]] usize capacity() const {
+                return kShardCount * maxShardSize();
+            }
+
+            void clear() {
+                for (usize i = 0; i < kShardCount; ++i) {
+                    std::fill_n(m_shards[i].slots.get(), m_slotsPerShard, 0);
+                    m_shards[i].size = 0;
+                }
+            }
+
+            InsertResult insert(u64 key) {
+                auto& shard = shardFor(key);
+                const std::scoped_lock lock{shard.mutex};
+
+                auto& slot = find(shard, key);
+
+                if (slot != 0) {
+                    return InsertResult::kPresent;
+                }
+
+                if (shard.size == maxShardSize()) {
+                    return InsertResult::kFull;
+                }
+
+                slot = (key & kKeyMask) | kOccupiedFlag;
+                ++shard.size;
+
+                return InsertResult::kInserted;
+            }
+
+            // marks a key already in the set as seen, exactly once
+            ClaimResult claim(u64 key) {
+                auto& shard = shardFor(key);
+                const std::scoped_lock lock{shard.mutex};
+
+                auto& slot = find(shard, key);
+
+                if (slot == 0) {
+                    return ClaimResult::kAbsent;
+                }
+
+                if ((slot & kClaimedFlag) != 0) {
+                    return ClaimResult::kAlreadyClaimed;
+                }
+
+                slot |= kClaimedFlag;
+                return ClaimResult::kClaimed;
+            }
+
+        private:
+            static constexpr usize kShardCount = 256;
+
+            static constexpr u64 kOccupiedFlag = 1;
+            static constexpr u64 kClaimedFlag = 2;
+            static constexpr u64 kKeyMask = ~(kOccupiedFlag | kClaimedFlag);
+
+            struct alignas(64) Shard {
+                std::mutex mutex{};
+                std::unique_ptr<u64[]> slots{};
+                usize size{};
+            };
+
+            usize m_slotsPerShard;
+            std::unique_ptr<Shard[]> m_shards;
+
+            // linear probing degrades quickly past this
+            [[nodiscard]] usize maxShardSize() const {
+                return m_slotsPerShard / 4 * 3;
+            }
+
+            // the top bits pick the shard and the bottom ones the slot
+            [[nodiscard]] Shard& shardFor(u64 key) const {
+                return m_shards[key >> 56];
+            }
+
+            // -> the slot holding the key, or the empty slot where it belongs
+            [[nodiscard]] u64& find(Shard& shard, u64 key) const {
+                const auto mask = m_slotsPerShard - 1;
+
+                for (auto idx = static_cast<usize>(key >> 2) & mask;; idx = (idx + 1) & mask) {
+                    auto& slot = shard.slots[idx];
+
+                    if (slot == 0 || (slot & kKeyMask) == (key & kKeyMask)) {
+                        return slot;
+                    }
+                }
+            }
+        };
+
+        struct Chunk {
+            const data::PackedReader* reader;
+            usize begin;
+            usize end;
+        };
+
+        struct FilterResult {
+            u64 kept;
+            // records that failed validation, which are never kept
+            u64 invalid;
+            bool success;
+        };
+
+        // Runs keep(record, key) over every input record, with threads pulling chunks from a shared
+        // counter, and writes out the records it returns true for, in no particular order. keep
+        // must be thread safe. The writer may be null if nothing is kept.
+        template <typename F>
+        FilterResult filterRecords(
+            const std::vector<Chunk>& chunks, u32 threadCount, data::PackedWriter* writer, const F& keep) {
+            std::atomic<usize> nextChunk{0};
+            std::atomic<u64> kept{0};
+            std::atomic<u64> invalid{0};
+            std::atomic_bool success{true};
+
+            std::mutex writerMutex{};
+
+            const auto flush = [&](std::vector<data::PackedPosition>& buffer) {
+                if (buffer.empty()) {
+                    return;
+                }
+
+                kept.fetch_add(buffer.size(), std::memory_order::relaxed);
+
+                const std::scoped_lock lock{writerMutex};
+
+                if (!writer->write(buffer)) {
+                    success.store(false, std::memory_order::relaxed);
+                }
+
+                buffer.clear();
+            };
+
+            std::vector<std::thread> threads{};
+
+            for (u32 i = 0; i < threadCount; ++i) {
+                threads.emplace_back([&] {
+                    std::vector<data::PackedPosition> buffer{};
+
+                    for (auto idx = nextChunk.fetch_add(1, std::memory_order::relaxed); idx < chunks.size();
+                         idx = nextChunk.fetch_add(1, std::memory_order::relaxed)) {
+                        const auto& chunk = chunks[idx];
+                        const auto records = chunk.reader->records();
+
+                        for (usize r = chunk.begin; r < chunk.end; ++r) {
+                            if (!records[r].isValid()) {
+                                invalid.fetch_add(1, std::memory_order::relaxed);
+                                continue;
+                            }
+
+                            if (keep(records[r], records[r].unpack().canonicalKey())) {
+                                buffer.push_back(records[r]);
+                            }
+                        }
+
+                        if (buffer.size() >= kChunkSize) {
+                            flush(buffer);
+                        }
+                    }
+
+                    flush(buffer);
+                });
+            }
+
+            for (auto& thread : threads) {
+                thread.join();
+            }
+
+            return {kept.load(), invalid.load(), success.load()};
+        }
+
+        // spreads keys over partitions independently of the bits the key set uses
+        [[nodiscard]] u32 partition(u64 key, u32 partitions) {
+            const auto mixed = static_cast<u32>((key * UINT64_C(0x9e3779b97f4a7c15)) >> 32);
+            return static_cast<u32>((static_cast<u64>(mixed) * partitions) >> 32);
+        }
+    } // namespace
+
+    bool run(const Config& config) {
+        if (std::filesystem::exists(config.output)) {
+            std::cerr << config.output << " already exists" << std::endl;
+            return false;
+        }
+
+        std::vector<std::unique_ptr<data::PackedReader>> readers{};
+        std::vector<Chunk> chunks{};
+
+        u64 total = 0;
+
+        for (const auto& input : config.inputs) {
+            auto& reader = readers.emplace_back(std::make_unique<data::PackedReader>());
+
+            if (!reader->open(input)) {
+                std::cerr << "failed to open " << input << std::endl;
+                return false;
+            }
+
+            for (usize begin = 0; begin < reader->size(); begin += kChunkSize) {
+                chunks.push_back({reader.get(), begin, std::min(begin + kChunkSize, reader->size())});
+            }
+
+            total += reader->size();
+        }
+
+        data::PackedWriter writer{};
+
+        if (!writer.open(config.output)) {
+            std::cerr << "failed to open " << config.output << std::endl;
+            return false;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+
+        KeySet keys{config.hashMb * 1024 * 1024};
+
+        std::atomic_bool full{false};
+        u64 unique = 0;
+        // counted on the first pass only, as every pass sees the same records
+        u64 invalid = 0;
+        bool success = true;
+
+        if (config.bloomMb > 0) {
+            util::BlockedBloomFilter filter{config.bloomMb * 1024 * 1024};
+
+            // the second sighting of any key puts it in the set
+            const auto first = filterRecords(chunks, config.threads, nullptr, [&](const auto&, u64 key) {
+                if (filter.testAndSet(key) && keys.insert(key) == KeySet::InsertResult::kFull) {
+                    full.store(true, std::memory_order::relaxed);
+                }
+
+                return false;
+            });
+
+            invalid = first.invalid;
+            success &= first.success;
+
+            if (!full) {
+                const auto second = filterRecords(chunks, config.threads, &writer, [&](const auto&, u64 key) {
+                    return keys.claim(key) != KeySet::ClaimResult::kAlreadyClaimed;
+                });
+
+                unique = second.kept;
+                success &= second.success;
+            }
+        } else {
+            // no partition can have more distinct keys than records. leave some slack
+            // for partitions, and the shards of the set, filling unevenly
+            const auto budget = keys.capacity() / 8 * 7;
+            const auto partitions = static_cast<u32>(std::max<u64>((total + budget - 1) / budget, 1));
+
+            for (u32 current = 0; current < partitions && !full; ++current) {
+                if (current > 0) {
+                    keys.clear();
+                }
+
+                const auto result = filterRecords(chunks, config.threads, &writer, [&](const auto&, u64 key) {
+                    if (partition(key, partitions) != current) {
+                        return false;
+                    }
+
+                    const auto inserted = keys.insert(key);
+
+                    if (inserted == KeySet::InsertResult::kFull) {
+                        full.store(true, std::memory_order::relaxed);
+                    }
+
+                    return inserted == KeySet::InsertResult::kInserted;
+                });
+
+                if (current == 0) {
+                    invalid = result.invalid;
+                }
+
+                unique += result.kept;
+                success &= result.success;
+            }
+
+            if (partitions > 1) {
+                std::cout << "read the input " << partitions << " times to stay within the hash size" << std::endl;
+            }
+        }
+
+        const auto fail = [&](const std::string& message) {
+            std::cerr << message << std::endl;
+
+            // a partial output would only make the next run refuse to start
+            writer.close();
+
+            std::error_code error{};
+            std::filesystem::remove(config.output, error);
+
+            return false;
+        };
+
+        if (full) {
+            return fail("hash full, raise the hash size");
+        }
+
+        if (!writer.close() || !success) {
+            return fail("failed to write " + config.output);
+        }
+
+        const auto time = std::chrono::duration<f64>(std::chrono::steady_clock::now() - start).count();
+        const auto rate = time > 0.0 ? static_cast<u64>(static_cast<f64>(total) / time) : 0;
+
+        if (invalid > 0) {
+            std::cerr << "skipped " << invalid << " invalid records" << std::endl;
+        }
+
+        std::cout << total << " positions, " << unique << " unique, " << (total - unique - invalid)
+                  << " duplicates removed, " << rate << " positions/s" << std::endl;
+
+        return true;
+    }
+} // namespace octachoron::dedup
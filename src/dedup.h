@@ -0,0 +1,48 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "types.h"
+
+#include <string>
+#include <vector>
+
+namespace octachoron::dedup {
+    struct Config {
+        std::vector<std::string> inputs{};
+        std::string output{};
+
+        u32 threads{1};
+        usize hashMb{256};
+        // zero disables the bloom filter
+        usize bloomMb{};
+    };
+
+    // Writes one occurrence of every position in the packed input files, comparing
+    // positions by canonical key so that symmetric positions are duplicates of each other.
+    // With more than one thread, which occurrence is kept is arbitrary. The output is removed
+    // again if anything fails.
+    // Threads share a sharded hash set of keys with a fixed memory budget. When every key
+    // would not fit, the inputs are read once per partition of the key space instead.
+    //
+    // With a bloom filter, a first pass only remembers, exactly, keys the filter has seen
+    // before: positions outside that set are unique and written without touching the hash
+    // set. This needs far less memory when most positions occur only once.
+    bool run(const Config& config);
+} // namespace octachoron::dedup
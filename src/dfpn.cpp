@@ -0,0 +1,505 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "dfpn.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "dfpn_cache.h"
+#include "movegen.h"
+
+namespace octachoron::dfpn {
+    namespace {
+        constexpr u32 kInfinity = std::numeric_limits<u32>::max() / 2;
+
+        // xored into table keys when black is the side trying to win,
+        // as the same position has different results for each attacker
+        constexpr u64 kBlackAttackerKey = UINT64_C(0x9e3779b97f4a7c15);
+
+        constexpr usize kMaxPvLength = 128;
+
+        constexpr u64 kTimeCheckInterval = 1024;
+
+        [[nodiscard]] constexpr u32 clampedSum(u64 a, u64 b) {
+            if (a >= kInfinity || b >= kInfinity) {
+                return kInfinity;
+            }
+
+            return static_cast<u32>(std::min<u64>(a + b, kInfinity - 1));
+        }
+    } // namespace
+
+    Solver::Solver(usize hashMb) {
+        resize(hashMb);
+    }
+
+    void Solver::resize(usize hashMb) {
+        const auto bucketCount = std::max<usize>(hashMb * 1024 * 1024 / sizeof(Bucket), 1);
+
+        m_buckets.clear();
+        m_buckets.shrink_to_fit();
+
+        m_buckets.resize(bucketCount);
+    }
+
+    void Solver::clear() {
+        std::ranges::fill(m_buckets, Bucket{});
+    }
+
+    SolveResult Solver::solve(const Position& pos, const SolveLimits& limits) {
+        m_attacker = pos.stm();
+
+        m_limits = limits;
+        m_start = std::chrono::steady_clock::now();
+        m_stopped = false;
+
+        m_nodes = 0;
+        m_path.clear();
+
+        m_stats.reset();
+
+        SolveResult result{};
+
+        if (m_cache) {
+            if (const auto cached = m_cache->probe(pos)) {
+                result.outcome = cached->proof == Proof::kWin ? Outcome::kWin : Outcome::kNoWin;
+                result.bestMove = cached->move;
+                result.hashfull = hashfull();
+
+                // as much of the line as the cache has
+                auto current = pos;
+
+                for (auto next = cached; next && result.pv.size() < kCachePlies; next = m_cache->probe(current)) {
+                    result.pv.push_back(next->move);
+                    current = current.applyMove(next->move);
+                }
+
+                return result;
+            }
+        }
+
+        const auto rootKey = entryKey(pos.key(), m_attacker);
+
+        bool terminal = false;
+        const auto root = evaluate(pos, terminal);
+
+        if (!terminal) {
+            mid(pos, kInfinity, kInfinity);
+        }
+
+        result.outcome = Outcome::kUnknown;
+
+        if (terminal) {
+            result.outcome = root.phi == 0 ? Outcome::kWin : Outcome::kNoWin;
+        } else if (const auto* entry = find(rootKey)) {
+            if (entry->phi == 0) {
+                result.outcome = Outcome::kWin;
+            } else if (entry->delta == 0 && !entry->pathDependent) {
+                result.outcome = Outcome::kNoWin;
+            }
+        }
+
+        auto current = pos;
+
+        m_path.clear();
+
+        while (result.pv.size() < kMaxPvLength) {
+            const auto key = entryKey(current.key(), m_attacker);
+            const auto* entry = find(key);
+
+            // a root settled without searching has no entry, so its line is read from the tablebases
+            auto move = entry ? entry->best : terminal ? settledMove(current) : kNullMove;
+
+            // near the root, the line may go on through a cached proof
+            if (!entry && m_cache && m_path.size() <= kCachePlies) {
+                if (const auto cached = m_cache->probe(current)) {
+                    move = cached->move;
+                }
+            }
+
+            if (move.isNull() || isOnPath(key)) {
+                break;
+            }
+
+            m_path.push_back(key);
+            result.pv.push_back(move);
+
+            current = current.applyMove(move);
+        }
+
+        result.bestMove = result.pv.empty() ? kNullMove : result.pv.front();
+
+        result.nodes = m_nodes;
+        result.timeSec = std::chrono::duration<f64>(std::chrono::steady_clock::now() - m_start).count();
+        result.hashfull = hashfull();
+
+        return result;
+    }
+
+    Move Solver::settledMove(const Position& pos) const {
+        constexpr i32 kWinScore = 1 << 20;
+
+        if (pos.winner() != Colors::kNone) {
+            return kNullMove;
+        }
+
+        MoveList moves{};
+        generateAll(moves, pos);
+
+        auto best = kNullMove;
+        auto bestScore = std::numeric_limits<i32>::min();
+
+        for (const auto move : moves) {
+            const auto child = pos.applyMove(move);
+
+            // for the side to move at pos: the quickest win, then a draw, then the slowest loss
+            std::optional<i32> score{};
+
+            if (const auto winner = child.winner(); winner != Colors::kNone) {
+                score = winner == pos.stm() ? kWinScore : -kWinScore;
+            } else if (countMoves(child) == 0) {
+                score = kWinScore;
+            } else if (m_tablebases) {
+                if (const auto result = m_tablebases->probe(child)) {
+                    const auto plies = static_cast<i32>(result->plies) + 1;
+
+                    switch (result->wdl) {
+                        case tb::Wdl::kWin:
+                            score = -kWinScore + plies;
+                            break;
+                        case tb::Wdl::kDraw:
+                            score = 0;
+                            break;
+                        case tb::Wdl::kLoss:
+                            score = kWinScore - plies;
+                            break;
+                    }
+                }
+            }
+
+            if (score && *score > bestScore) {
+                best = move;
+                bestScore = *score;
+            }
+        }
+
+        return best;
+    }
+
+    void Solver::exportProofs(const Position& root, AnalysisCache& cache) const {
+        exportProofs(root, kExportPlies, cache);
+    }
+
+    std::optional<std::pair<Proof, const Solver::Entry*>> Solver::findProof(const Position& pos) const {
+        const auto us = pos.stm();
+
+        // proofs hold for the side to move when it was the attacker,
+        // and disproofs of holding on when it was the defender
+        if (const auto* entry = find(entryKey(pos.key(), us)); entry && entry->phi == 0) {
+            return std::pair{Proof::kWin, entry};
+        }
+
+        if (const auto* entry = find(entryKey(pos.key(), us.flip())); entry && entry->delta == 0) {
+            return std::pair{Proof::kLoss, entry};
+        }
+
+        return {};
+    }
+
+    void Solver::exportProofs(const Position& pos, usize plies, AnalysisCache& cache) const {
+        if (const auto proof = findProof(pos)) {
+            const auto [result, entry] = *proof;
+
+            if (entry->work >= kMinCachedWork && !entry->best.isNull()) {
+                cache.add(pos, result, entry->best, entry->work);
+            }
+        }
+
+        if (plies == 0 || pos.winner() != Colors::kNone) {
+            return;
+        }
+
+        MoveList moves{};
+        generateAll(moves, pos);
+
+        for (const auto move : moves) {
+            const auto child = pos.applyMove(move);
+
+            // the last solve never reached positions it has no entry for
+            if (find(entryKey(child.key(), m_attacker))) {
+                exportProofs(child, plies - 1, cache);
+            }
+        }
+    }
+
+    bool Solver::isOnPath(u64 key) const {
+        return std::ranges::find(m_path, key) != m_path.end();
+    }
+
+    u64 Solver::entryKey(u64 key, Color attacker) const {
+        return attacker == Colors::kBlack ? key ^ kBlackAttackerKey : key;
+    }
+
+    const Solver::Entry* Solver::find(u64 key) const {
+        const auto idx = static_cast<usize>((static_cast<u128>(key) * m_buckets.size()) >> 64);
+
+        for (const auto& entry : m_buckets[idx].entries) {
+            if (entry.key == key) {
+                return &entry;
+            }
+        }
+
+        return nullptr;
+    }
+
+    void Solver::store(u64 key, const Node& node, u32 work, Move best) {
+        const auto idx = static_cast<usize>((static_cast<u128>(key) * m_buckets.size()) >> 64);
+        auto& entries = m_buckets[idx].entries;
+
+        auto* replace = &entries[0];
+
+        for (auto& entry : entries) {
+            if (entry.key == key) {
+                replace = &entry;
+                break;
+            }
+
+            if (entry.work < replace->work) {
+                replace = &entry;
+            }
+        }
+
+        // numbers from evaluate() alone only go into room nothing searched needs
+        if (work == 0 && replace->work > 0) {
+            return;
+        }
+
+        *replace = {key, node.phi, node.delta, work, best, node.pathDependent};
+    }
+
+    Solver::Node Solver::evaluate(const Position& pos, bool& terminal) {
+        const bool attacking = pos.stm() == m_attacker;
+
+        terminal = true;
+
+        if (const auto winner = pos.winner(); winner != Colors::kNone) {
+            return winner == pos.stm() ? Node{0, kInfinity} : Node{kInfinity, 0};
+        }
+
+        // the root is looked up by solve itself
+        if (m_cache && !m_path.empty() && m_path.size() <= kCachePlies) {
+            if (const auto cached = m_cache->probe(pos)) {
+                return cached->proof == Proof::kWin ? Node{0, kInfinity} : Node{kInfinity, 0};
+            }
+        }
+
+        if (m_tablebases) {
+            if (const auto result = m_tablebases->probe(pos)) {
+                switch (result->wdl) {
+                    case tb::Wdl::kWin:
+                        return {0, kInfinity};
+                    case tb::Wdl::kLoss:
+                        return {kInfinity, 0};
+                    case tb::Wdl::kDraw:
+                        return attacking ? Node{kInfinity, 0} : Node{0, kInfinity};
+                }
+            }
+        }
+
+        const auto moves = countMoves(pos);
+
+        if (moves == 0) {
+            return {kInfinity, 0};
+        }
+
+        terminal = false;
+
+        // one move is enough to succeed, but every one must fail for the mover to fail
+        return {1, static_cast<u32>(moves)};
+    }
+
+    void Solver::mid(const Position& pos, u32 thresholdPhi, u32 thresholdDelta) {
+        ++m_nodes;
+        m_stats.node(pos.stm() == m_attacker ? stats::NodeType::kCut : stats::NodeType::kAll);
+
+        const auto nodesBefore = m_nodes;
+        const auto key = entryKey(pos.key(), m_attacker);
+
+        const auto ply = m_path.size();
+
+        if (ply >= m_frames.size()) {
+            m_frames.push_back(std::make_unique<Frame>());
+        }
+
+        auto& [moves, childKeys, initial, states] = *m_frames[ply];
+
+        moves.clear();
+        childKeys.clear();
+        initial.clear();
+        states.clear();
+
+        generateAll(moves, pos);
+
+        // a repetition is good enough for the defender, but not for the attacker
+        const auto repetition = pos.stm() == m_attacker ? Node{0, kInfinity, true} : Node{kInfinity, 0, true};
+
+        for (const auto move : moves) {
+            childKeys.push(entryKey(pos.applyMove(move).key(), m_attacker));
+        }
+
+        // every lookup first, so that their misses overlap instead of waiting on evaluations
+        for (usize i = 0; i < moves.size(); ++i) {
+            states.push(find(childKeys[i]) ? ChildState::kUnevaluated : ChildState::kEvaluated);
+        }
+
+        for (usize i = 0; i < moves.size(); ++i) {
+            if (isOnPath(childKeys[i])) {
+                initial.push(repetition);
+                states[i] = ChildState::kFixed;
+            } else if (states[i] == ChildState::kUnevaluated) {
+                initial.push({});
+            } else {
+                bool terminal = false;
+
+                initial.push(evaluate(pos.applyMove(moves[i]), terminal));
+                states[i] = terminal ? ChildState::kFixed : ChildState::kEvaluated;
+
+                // kept for when this node is entered again, which is about half the time
+                if (!terminal) {
+                    store(childKeys[i], initial[i], 0, kNullMove);
+                }
+            }
+        }
+
+        m_path.push_back(key);
+
+        const auto childNode = [&](usize i) {
+            if (states[i] == ChildState::kFixed) {
+                return initial[i];
+            }
+
+            const auto* entry = find(childKeys[i]);
+            m_stats.ttProbe(entry != nullptr);
+
+            if (entry) {
+                return Node{entry->phi, entry->delta, entry->pathDependent};
+            }
+
+            // replaced since, so evaluated after all
+            if (states[i] == ChildState::kUnevaluated) {
+                bool terminal = false;
+
+                initial[i] = evaluate(pos.applyMove(moves[i]), terminal);
+                states[i] = terminal ? ChildState::kFixed : ChildState::kEvaluated;
+            }
+
+            return initial[i];
+        };
+
+        const bool attacking = pos.stm() == m_attacker;
+
+        while (true) {
+            u32 phi = kInfinity;
+            u32 delta = 0;
+
+            // among the children the defender holds on in
+            bool anyDependent = false;
+            bool anyIndependent = false;
+
+            usize best = 0;
+            u32 bestDelta = kInfinity;
+            u32 bestPhi = kInfinity;
+            u32 secondDelta = kInfinity;
+
+            for (usize i = 0; i < moves.size(); ++i) {
+                const auto node = childNode(i);
+
+                phi = std::min(phi, node.delta);
+                delta = clampedSum(delta, node.phi);
+
+                if ((attacking ? node.phi : node.delta) == 0) {
+                    anyDependent |= node.pathDependent;
+                    anyIndependent |= !node.pathDependent;
+                }
+
+                if (node.delta < bestDelta) {
+                    secondDelta = bestDelta;
+
+                    best = i;
+                    bestDelta = node.delta;
+                    bestPhi = node.phi;
+                } else if (node.delta < secondDelta) {
+                    secondDelta = node.delta;
+                }
+            }
+
+            if (phi >= thresholdPhi || delta >= thresholdDelta || shouldStop()) {
+                // the attacker fails here if it fails after every move, but the
+                // defender holds on here if it holds on after any one of them
+                const bool pathDependent = attacking ? delta == 0 && anyDependent : phi == 0 && !anyIndependent;
+
+                const auto work = static_cast<u32>(std::min<u64>(m_nodes - nodesBefore + 1, kInfinity));
+                store(key, {phi, delta, pathDependent}, work, moves.empty() ? kNullMove : moves[best]);
+
+                break;
+            }
+
+            // the best child may use all of the margin left by its siblings,
+            // and may stay best only until it is worse than the runner up
+            const auto childThresholdPhi =
+                thresholdDelta >= kInfinity ? kInfinity : clampedSum(thresholdDelta - delta, bestPhi);
+            const auto childThresholdDelta = std::min(thresholdPhi, clampedSum(secondDelta, 1));
+
+            m_stats.movePlayed(moves[best]);
+            mid(pos.applyMove(moves[best]), childThresholdPhi, childThresholdDelta);
+        }
+
+        m_path.pop_back();
+    }
+
+    bool Solver::shouldStop() {
+        if (m_stopped) {
+            return true;
+        }
+
+        if (m_limits.maxNodes > 0 && m_nodes >= m_limits.maxNodes) {
+            m_stopped = true;
+        } else if (m_limits.maxTime.count() > 0 && m_nodes % kTimeCheckInterval == 0
+                   && std::chrono::steady_clock::now() - m_start >= m_limits.maxTime)
+        {
+            m_stopped = true;
+        }
+
+        return m_stopped;
+    }
+
+    u32 Solver::hashfull() const {
+        const auto sampled = std::min<usize>(m_buckets.size(), 1000);
+
+        usize used = 0;
+
+        for (usize i = 0; i < sampled; ++i) {
+            for (const auto& entry : m_buckets[i].entries) {
+                used += entry.key != 0;
+            }
+        }
+
+        return static_cast<u32>(used * 1000 / (sampled * kBucketSize));
+    }
+} // namespace octachoron::dfpn
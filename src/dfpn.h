@@ -0,0 +1,202 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "types.h"
+
+#include <array>
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "move.h"
+#include "movegen.h"
+#include "position.h"
+#include "stats.h"
+#include "tb/tablebase.h"
+
+namespace octachoron::dfpn {
+    // result of a solve, for the side to move at the root
+    enum class Outcome : u8 {
+        // the side to move can force a win
+        kWin = 0,
+        // the side to move cannot force a win: it loses, or the game is drawn
+        kNoWin,
+        // a limit was hit first, or the root was only disproved through repetitions
+        kUnknown,
+    };
+
+    // proven results for any position the solver has settled, from the side to move's view
+    enum class Proof : u8 {
+        kWin = 0,
+        kLoss,
+    };
+
+    class AnalysisCache;
+
+    struct SolveLimits {
+        // 0 for no limit
+        u64 maxNodes{};
+        std::chrono::milliseconds maxTime{};
+    };
+
+    struct SolveResult {
+        Outcome outcome;
+        Move bestMove;
+        // a winning line if the root is won, otherwise the most promising line so far
+        std::vector<Move> pv;
+        u64 nodes;
+        f64 timeSec;
+        // permille of the table in use
+        u32 hashfull;
+    };
+
+    // Depth-first proof-number search (Nagai's df-pn) over Position::applyMove, proving or
+    // disproving that the side to move at the root can force a win. Proof and disproof
+    // numbers live in the solver's own hashed table, whose size bounds the memory used;
+    // when it is full the entries with the least work behind them are replaced.
+    //
+    // Repeating a position on the current path counts as a failure for the side trying to
+    // win, as does a side having no legal moves count as a loss for it, as in the tablebases.
+    // Disproofs resting on a repetition only hold for the path they were found on, so they
+    // are marked as such in the table and never reported as a result.
+    class Solver {
+    public:
+        explicit Solver(usize hashMb = 64);
+
+        void resize(usize hashMb);
+        void clear();
+
+        // probed at every node if set, must stay loaded for as long as the solver uses it
+        inline void setTablebases(const tb::Tablebases* tablebases) {
+            m_tablebases = tablebases;
+        }
+
+        // probed at the root and near it if set, as cache lookups cost more than table ones
+        inline void setCache(const AnalysisCache* cache) {
+            m_cache = cache;
+        }
+
+        SolveResult solve(const Position& pos, const SolveLimits& limits);
+
+        // Adds the proofs the last solve left in the table for the root and positions near it
+        // to the cache, if enough work went into them to be worth keeping.
+        void exportProofs(const Position& root, AnalysisCache& cache) const;
+
+        [[nodiscard]] inline const stats::ThreadStats& threadStats() const {
+            return m_stats;
+        }
+
+    private:
+        // plies from the root within which the cache is probed
+        static constexpr usize kCachePlies = 4;
+        // and within which proofs are exported. every move of every position is tried, so keep it low
+        static constexpr usize kExportPlies = 2;
+        // nodes below a proof for it to be exported
+        static constexpr u32 kMinCachedWork = 256;
+
+        struct Entry {
+            u64 key;
+            u32 phi;
+            u32 delta;
+            // nodes searched below this entry, for replacement. 0 if only evaluated
+            u32 work;
+            Move best;
+            // a disproof that relies on a repetition somewhere below
+            bool pathDependent;
+        };
+
+        static constexpr usize kBucketSize = 4;
+
+        struct alignas(64) Bucket {
+            std::array<Entry, kBucketSize> entries;
+        };
+
+        struct Node {
+            u32 phi;
+            u32 delta;
+            bool pathDependent{};
+        };
+
+        enum class ChildState : u8 {
+            // the table already had numbers for it
+            kUnevaluated = 0,
+            // initial numbers filled in
+            kEvaluated,
+            // settled by the position alone or its place on the path, so never looked up
+            kFixed,
+        };
+
+        // expansion of the node at one ply, kept off the stack. children
+        // are only evaluated if the table has nothing for them
+        struct Frame {
+            MoveList moves;
+            StaticVector<u64, kMaxMoves> childKeys;
+            StaticVector<Node, kMaxMoves> initial;
+            StaticVector<ChildState, kMaxMoves> states;
+        };
+
+        std::vector<Bucket> m_buckets{};
+        std::vector<std::unique_ptr<Frame>> m_frames{};
+
+        const tb::Tablebases* m_tablebases{};
+        const AnalysisCache* m_cache{};
+
+        Color m_attacker{};
+
+        SolveLimits m_limits{};
+        std::chrono::steady_clock::time_point m_start{};
+        bool m_stopped{};
+
+        u64 m_nodes{};
+
+        // keys of the positions on the current path, for repetition detection
+        std::vector<u64> m_path{};
+
+        stats::ThreadStats m_stats{};
+
+        [[nodiscard]] bool isOnPath(u64 key) const;
+
+        [[nodiscard]] u64 entryKey(u64 key, Color attacker) const;
+
+        [[nodiscard]] const Entry* find(u64 key) const;
+
+        // -> the proof for the side to move, if any, and the entry that holds it
+        [[nodiscard]] std::optional<std::pair<Proof, const Entry*>> findProof(const Position& pos) const;
+
+        void exportProofs(const Position& pos, usize plies, AnalysisCache& cache) const;
+        void store(u64 key, const Node& node, u32 work, Move best);
+
+        // -> (phi, delta) for a position the solver has not expanded and that is not a
+        // repetition, settling terminals
+        [[nodiscard]] Node evaluate(const Position& pos, bool& terminal);
+
+        // For positions evaluate() settles by their children or the tablebases rather than by
+        // search: the move keeping the result, null if the game is over or nothing is known.
+        [[nodiscard]] Move settledMove(const Position& pos) const;
+
+        void mid(const Position& pos, u32 thresholdPhi, u32 thresholdDelta);
+
+        [[nodiscard]] bool shouldStop();
+
+        [[nodiscard]] u32 hashfull() const;
+    };
+} // namespace octachoron::dfpn
@@ -0,0 +1,196 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "dfpn_cache.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#include "movegen.h"
+#include "symmetry.h"
+
+namespace octachoron::dfpn {
+    namespace {
+        constexpr std::array kMagic = {'O', 'C', 'A', 'C'};
+        constexpr u32 kVersion = 1;
+
+        struct FileHeader {
+            std::array<char, 4> magic;
+            u32 version;
+            u64 entryCount;
+        };
+
+        static_assert(sizeof(FileHeader) % 8 == 0);
+    } // namespace
+
+    bool AnalysisCache::open(const std::string& path) {
+        close();
+
+        m_path = path;
+
+        if (!std::filesystem::exists(path)) {
+            return true;
+        }
+
+        if (!map()) {
+            m_path.clear();
+            return false;
+        }
+
+        return true;
+    }
+
+    void AnalysisCache::close() {
+        m_path.clear();
+
+        m_file.close();
+        m_entries = {};
+
+        const std::scoped_lock lock{m_pendingMutex};
+        m_pending.clear();
+    }
+
+    std::optional<CachedProof> AnalysisCache::probe(const Position& pos) const {
+        const auto key = pos.canonicalKey();
+
+        const auto entry =
+            std::ranges::lower_bound(m_entries, key, std::ranges::less{}, [](const Entry& entry) { return entry.key; });
+
+        if (entry == m_entries.end() || entry->key != key) {
+            return {};
+        }
+
+        // symmetries are their own inverses
+        const auto move = transform(Move::fromRaw(entry->move & ~kLossFlag), pos.canonicalSymmetry());
+        const auto proof = (entry->move & kLossFlag) != 0 ? Proof::kLoss : Proof::kWin;
+
+        // guards against key collisions and corrupt files
+        if (!isLegal(pos, move)) {
+            return {};
+        }
+
+        return CachedProof{proof, move, entry->work};
+    }
+
+    void AnalysisCache::add(const Position& pos, Proof proof, Move move, u32 work) {
+        const auto canonicalMove = transform(move, pos.canonicalSymmetry());
+
+        Entry entry{pos.canonicalKey(), canonicalMove.raw(), work};
+
+        if (proof == Proof::kLoss) {
+            entry.move |= kLossFlag;
+        }
+
+        const std::scoped_lock lock{m_pendingMutex};
+        m_pending.push_back(entry);
+    }
+
+    bool AnalysisCache::save() {
+        assert(isOpen());
+
+        std::vector<Entry> merged{};
+
+        {
+            const std::scoped_lock lock{m_pendingMutex};
+
+            merged.reserve(m_entries.size() + m_pending.size());
+
+            merged.insert(merged.end(), m_entries.begin(), m_entries.end());
+            merged.insert(merged.end(), m_pending.begin(), m_pending.end());
+
+            m_pending.clear();
+        }
+
+        // most work first within a key, then keep only that
+        std::ranges::sort(merged, [](const Entry& a, const Entry& b) {
+            return a.key != b.key ? a.key < b.key : a.work > b.work;
+        });
+
+        const auto [first, last] = std::ranges::unique(merged, {}, [](const Entry& entry) { return entry.key; });
+        merged.erase(first, last);
+
+        FileHeader header{};
+
+        header.magic = kMagic;
+        header.version = kVersion;
+        header.entryCount = merged.size();
+
+        const auto tmpPath = m_path + ".tmp";
+
+        std::error_code error{};
+
+        {
+            std::ofstream stream{tmpPath, std::ios::binary | std::ios::trunc};
+
+            if (!stream) {
+                return false;
+            }
+
+            stream.write(reinterpret_cast<const char*>(&header), sizeof(FileHeader));
+            stream.write(reinterpret_cast<const char*>(merged.data()),
+                static_cast<std::streamsize>(merged.size() * sizeof(Entry)));
+
+            if (!stream.flush()) {
+                stream.close();
+                std::filesystem::remove(tmpPath, error);
+                return false;
+            }
+        }
+
+        // the old mapping stays valid after the rename, until it is replaced below
+        std::filesystem::rename(tmpPath, m_path, error);
+
+        if (error) {
+            std::filesystem::remove(tmpPath, error);
+            return false;
+        }
+
+        return map();
+    }
+
+    bool AnalysisCache::map() {
+        m_entries = {};
+
+        if (!m_file.open(m_path)) {
+            return false;
+        }
+
+        const auto data = m_file.data();
+
+        FileHeader header{};
+
+        if (data.size() >= sizeof(FileHeader)) {
+            std::memcpy(&header, data.data(), sizeof(FileHeader));
+        }
+
+        if (header.magic != kMagic || header.version != kVersion
+            || data.size() != sizeof(FileHeader) + header.entryCount * sizeof(Entry))
+        {
+            m_file.close();
+            return false;
+        }
+
+        // the header is a multiple of the entry alignment and mappings are page aligned
+        m_entries = {reinterpret_cast<const Entry*>(data.data() + sizeof(FileHeader)), header.entryCount};
+
+        return true;
+    }
+} // namespace octachoron::dfpn
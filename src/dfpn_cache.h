@@ -0,0 +1,96 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "types.h"
+
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "dfpn.h"
+#include "move.h"
+#include "position.h"
+#include "util/mapped_file.h"
+
+namespace octachoron::dfpn {
+    struct CachedProof {
+        Proof proof;
+        // the winning move for wins, the longest resistance found for losses
+        Move move;
+        // nodes the solver spent on the proof, saturating
+        u32 work;
+    };
+
+    // Proven results kept across runs. Files hold a header and then 16-byte entries sorted by
+    // canonical key, with moves in the canonical orientation, so symmetric positions share
+    // an entry. Opening maps the file, so only the pages actually probed are ever read.
+    //
+    // Results added during a run are held back until save(), which merges them into the file,
+    // keeping the entry with the most work behind it for positions found in both.
+    class AnalysisCache {
+    public:
+        // a missing file is an empty cache, created on the first save
+        bool open(const std::string& path);
+        void close();
+
+        [[nodiscard]] inline bool isOpen() const {
+            return !m_path.empty();
+        }
+
+        // entries in the file, not counting unsaved ones
+        [[nodiscard]] inline usize size() const {
+            return m_entries.size();
+        }
+
+        // looks in the file only, so safe from any number of threads. entries
+        // whose move is not legal in pos are treated as missing
+        [[nodiscard]] std::optional<CachedProof> probe(const Position& pos) const;
+
+        // safe from any number of threads
+        void add(const Position& pos, Proof proof, Move move, u32 work);
+
+        // writes the merged file next to the old one and renames it into place
+        bool save();
+
+    private:
+        struct Entry {
+            u64 key;
+            // Move::raw() in the low bits, set bit 31 for losses
+            u32 move;
+            u32 work;
+        };
+
+        static_assert(sizeof(Entry) == 16);
+
+        static constexpr u32 kLossFlag = 1U << 31;
+
+        std::string m_path{};
+
+        util::MappedFile m_file{};
+        std::span<const Entry> m_entries{};
+
+        std::mutex m_pendingMutex{};
+        std::vector<Entry> m_pending{};
+
+        bool map();
+    };
+} // namespace octachoron::dfpn
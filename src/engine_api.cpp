@@ -0,0 +1,262 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "engine_api.h"
+
+#include "types.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <sstream>
+#include <type_traits>
+
+#include "eval.h"
+#include "mcts/search.h"
+#include "movegen.h"
+#include "position.h"
+#include "selfplay.h"
+
+using namespace octachoron;
+
+namespace {
+    static_assert(std::is_trivially_copyable_v<Position>);
+    static_assert(sizeof(Position) <= sizeof(OcPosition) && alignof(Position) <= alignof(OcPosition));
+
+    [[nodiscard]] Position load(const OcPosition* pos) {
+        Position result{};
+        std::memcpy(&result, pos->opaque, sizeof(Position));
+        return result;
+    }
+
+    void store(OcPosition* dst, const Position& pos) {
+        std::memcpy(dst->opaque, &pos, sizeof(Position));
+    }
+
+    // Exceptions must not unwind through the C interface, so every entry point that may
+    // allocate runs its body through this. -> fallback if it throws
+    template <typename T, typename F>
+    [[nodiscard]] T guard(T fallback, F&& body) noexcept {
+        try {
+            return body();
+        } catch (const std::exception& e) {
+            std::cerr << "octachoron: " << e.what() << std::endl;
+            return fallback;
+        }
+    }
+
+    void fillInfo(OcSearchInfo& dst, const mcts::SearchInfo& info) {
+        dst.playouts = info.playouts;
+        dst.timeSec = info.timeSec;
+        dst.value = info.value;
+        dst.bestMove = info.bestMove.raw();
+
+        dst.pvLength = static_cast<u32>(std::min<usize>(info.pv.size(), OC_MAX_PV));
+
+        for (u32 i = 0; i < dst.pvLength; ++i) {
+            dst.pv[i] = info.pv[i].raw();
+        }
+    }
+} // namespace
+
+struct OcEngine {
+    mcts::Searcher searcher;
+    Position pos{Position::startpos()};
+
+    std::atomic<bool> stop{};
+};
+
+void oc_position_startpos(OcPosition* pos) {
+    store(pos, Position::startpos());
+}
+
+int oc_position_from_fen(OcPosition* pos, const char* fen) {
+    return guard(0, [&] {
+        const auto parsed = Position::fromFen(fen);
+
+        if (!parsed) {
+            return 0;
+        }
+
+        store(pos, *parsed);
+        return 1;
+    });
+}
+
+int oc_position_play(OcPosition* pos, const char* move) {
+    return guard(0, [&] {
+        const auto current = load(pos);
+
+        if (selfplay::winner(current) != Colors::kNone) {
+            return 0;
+        }
+
+        const auto parsed = parseMove(current, move);
+
+        if (!parsed) {
+            return 0;
+        }
+
+        store(pos, current.applyMove(*parsed));
+        return 1;
+    });
+}
+
+size_t oc_position_fen(const OcPosition* pos, char* buffer, size_t size) {
+    if (size > 0) {
+        buffer[0] = '\0';
+    }
+
+    return guard<size_t>(0, [&] {
+        const auto fen = load(pos).toFen();
+
+        if (size > 0) {
+            const auto length = std::min(fen.size(), size - 1);
+
+            std::memcpy(buffer, fen.data(), length);
+            buffer[length] = '\0';
+        }
+
+        return fen.size();
+    });
+}
+
+int oc_position_winner(const OcPosition* pos) {
+    const auto winner = selfplay::winner(load(pos));
+
+    if (winner == Colors::kNone) {
+        return 0;
+    }
+
+    return winner == Colors::kWhite ? 1 : -1;
+}
+
+void oc_evaluate(const OcPosition* positions, size_t count, int32_t* scores) {
+    for (usize i = 0; i < count; ++i) {
+        scores[i] = eval::evaluate(load(&positions[i]));
+    }
+}
+
+void oc_move_string(OcMove move, char buffer[OC_MOVE_STRING_SIZE]) {
+    try {
+        std::ostringstream str{};
+        str << Move::fromRaw(move);
+
+        const auto result = str.str();
+
+        std::memcpy(buffer, result.c_str(), result.size() + 1);
+    } catch (const std::exception& e) {
+        std::cerr << "octachoron: " << e.what() << std::endl;
+        buffer[0] = '\0';
+    }
+}
+
+OcEngine* oc_engine_create(uint32_t threads, uint64_t treeMb) {
+    if (threads == 0 || treeMb == 0) {
+        std::cerr << "invalid engine config" << std::endl;
+        return nullptr;
+    }
+
+    return guard<OcEngine*>(nullptr, [&] { return new OcEngine{.searcher = mcts::Searcher{treeMb, threads}}; });
+}
+
+void oc_engine_destroy(OcEngine* engine) {
+    delete engine;
+}
+
+void oc_engine_new_game(OcEngine* engine) {
+    engine->searcher.newGame();
+}
+
+void oc_engine_set_position(OcEngine* engine, const OcPosition* pos) {
+    engine->pos = load(pos);
+}
+
+int oc_engine_set_fen(OcEngine* engine, const char* fen) {
+    return guard(0, [&] {
+        const auto parsed = Position::fromFen(fen);
+
+        if (!parsed) {
+            return 0;
+        }
+
+        engine->pos = *parsed;
+        return 1;
+    });
+}
+
+int oc_engine_set_moves(OcEngine* engine, const char* fen, const char* const* moves, size_t count) {
+    OcPosition pos{};
+
+    if (fen) {
+        if (!oc_position_from_fen(&pos, fen)) {
+            return 0;
+        }
+    } else {
+        oc_position_startpos(&pos);
+    }
+
+    for (usize i = 0; i < count; ++i) {
+        if (!oc_position_play(&pos, moves[i])) {
+            return 0;
+        }
+    }
+
+    oc_engine_set_position(engine, &pos);
+    return 1;
+}
+
+int oc_engine_search(OcEngine* engine, const OcSearchLimits* limits, OcInfoCallback callback, void* userData,
+    OcSearchInfo* result) {
+    if (selfplay::winner(engine->pos) != Colors::kNone) {
+        return 0;
+    }
+
+    engine->stop.store(false, std::memory_order::relaxed);
+
+    mcts::SearchLimits searchLimits{};
+
+    searchLimits.maxPlayouts = limits->playouts;
+    searchLimits.maxTime = std::chrono::milliseconds{limits->movetimeMs};
+    searchLimits.cancel = &engine->stop;
+
+    return guard(0, [&] {
+        if (callback) {
+            engine->searcher.setInfoCallback(
+                [callback, userData](const mcts::SearchInfo& info) {
+                    OcSearchInfo converted{};
+                    fillInfo(converted, info);
+                    callback(&converted, userData);
+                },
+                std::chrono::milliseconds{std::max<u32>(limits->infoIntervalMs, 1)});
+        } else {
+            engine->searcher.setInfoCallback({}, std::chrono::milliseconds{1000});
+        }
+
+        const auto info = engine->searcher.search(engine->pos, searchLimits);
+
+        fillInfo(*result, info);
+        return 1;
+    });
+}
+
+void oc_engine_stop(OcEngine* engine) {
+    engine->stop.store(true, std::memory_order::relaxed);
+}
@@ -0,0 +1,120 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+// C interface to the engine, built as the liboctachoron shared library so that other
+// programs can embed it without going through a text protocol. See mcts/search.h.
+//
+// Functions taking a position or engine may be called from several threads at once as long
+// as each thread uses its own engine, apart from oc_engine_stop, which may be called from
+// any thread. Functions returning int return 1 on success and 0 on failure.
+
+#include <stddef.h>
+#include <stdint.h>
+
+// the only symbols the shared library exports
+#ifndef OC_API
+    #if defined(__GNUC__)
+        #define OC_API __attribute__((visibility("default")))
+    #else
+        #define OC_API
+    #endif
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define OC_MAX_PV 64
+// longest move string, including the terminator
+#define OC_MOVE_STRING_SIZE 8
+
+typedef struct OcEngine OcEngine;
+
+// A position held by value, so that callers can keep arrays of them and copy them freely
+// without allocating. Only meaningful to the functions below.
+typedef struct OcPosition {
+    uint64_t opaque[48];
+} OcPosition;
+
+// 0 is the null move, printed as "0000"
+typedef uint32_t OcMove;
+
+typedef struct OcSearchLimits {
+    // 0 for no limit. with neither, the search runs until oc_engine_stop
+    uint64_t playouts;
+    uint64_t movetimeMs;
+    // between calls to the info callback, if there is one
+    uint32_t infoIntervalMs;
+} OcSearchLimits;
+
+typedef struct OcSearchInfo {
+    uint64_t playouts;
+    double timeSec;
+    // expected result for the side to move, in [-1, 1]
+    double value;
+    OcMove bestMove;
+    uint32_t pvLength;
+    OcMove pv[OC_MAX_PV];
+} OcSearchInfo;
+
+// called from the searching thread every infoIntervalMs, and once at the end
+typedef void (*OcInfoCallback)(const OcSearchInfo* info, void* userData);
+
+OC_API void oc_position_startpos(OcPosition* pos);
+OC_API int oc_position_from_fen(OcPosition* pos, const char* fen);
+
+// plays a move given as a string, if it is legal. pos is left alone otherwise
+OC_API int oc_position_play(OcPosition* pos, const char* move);
+
+// writes the fen, truncated if it does not fit, and returns its full length like snprintf
+OC_API size_t oc_position_fen(const OcPosition* pos, char* buffer, size_t size);
+
+// 1 if white has won, -1 if black has, 0 if the game goes on
+OC_API int oc_position_winner(const OcPosition* pos);
+
+// static evaluation of each position for its side to move, about 100 per piece
+OC_API void oc_evaluate(const OcPosition* positions, size_t count, int32_t* scores);
+
+OC_API void oc_move_string(OcMove move, char buffer[OC_MOVE_STRING_SIZE]);
+
+// -> null on failure, with the reason printed to stderr
+OC_API OcEngine* oc_engine_create(uint32_t threads, uint64_t treeMb);
+OC_API void oc_engine_destroy(OcEngine* engine);
+
+// forget the tree, so that nothing is reused by the next search
+OC_API void oc_engine_new_game(OcEngine* engine);
+
+OC_API void oc_engine_set_position(OcEngine* engine, const OcPosition* pos);
+OC_API int oc_engine_set_fen(OcEngine* engine, const char* fen);
+// from the given fen, or startpos if it is null. the engine's position is unchanged on failure
+OC_API int oc_engine_set_moves(OcEngine* engine, const char* fen, const char* const* moves, size_t count);
+
+// Searches the engine's position and blocks until done. The tree is kept, so searching a
+// position one or two plies on from the last one reuses the work already done for it.
+// Fails if the game is already over. callback may be null.
+OC_API int oc_engine_search(
+    OcEngine* engine, const OcSearchLimits* limits, OcInfoCallback callback, void* userData, OcSearchInfo* result);
+
+// ends the search in progress, if any
+OC_API void oc_engine_stop(OcEngine* engine);
+
+#ifdef __cplusplus
+}
+#endif
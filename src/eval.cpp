@@ -0,0 +1,54 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "eval.h"
+
+namespace octachoron::eval {
+    namespace {
+        constexpr Weights kWeights = {
+            // role values: wise, rock, paper, scissors
+            40,
+            kPieceValue,
+            kPieceValue,
+            kPieceValue,
+            // advancement, by distance to the goal row. 0 means the game is already over
+            0,
+            90,
+            45,
+            25,
+            12,
+            5,
+            0,
+        };
+
+        [[nodiscard]] Score evaluateColor(const Position& pos, Color color) {
+            Score score = 0;
+            forEachTerm(pos, color, [&](usize term) { score += kWeights[term]; });
+            return score;
+        }
+    } // namespace
+
+    const Weights& weights() {
+        return kWeights;
+    }
+
+    Score evaluate(const Position& pos) {
+        const auto us = pos.stm();
+        return evaluateColor(pos, us) - evaluateColor(pos, us.flip());
+    }
+} // namespace octachoron::eval
@@ -0,0 +1,74 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "types.h"
+
+#include <array>
+
+#include "geometry.h"
+#include "position.h"
+
+namespace octachoron::eval {
+    using Score = i32;
+
+    // roughly one non-wise piece
+    constexpr Score kPieceValue = 100;
+
+    // The evaluation is a weighted sum of integer terms, each counted for the side to
+    // move minus the other side, which is what lets the tuner fit the weights linearly.
+    namespace terms {
+        // per role, counting both pieces of a stack
+        constexpr usize kRoleValue = 0;
+        // per distance to the goal row, for units without a wise on top
+        constexpr usize kAdvancement = kRoleValue + Roles::kCount;
+
+        constexpr usize kCount = kAdvancement + 7;
+    } // namespace terms
+
+    using Weights = std::array<Score, terms::kCount>;
+
+    [[nodiscard]] const Weights& weights();
+
+    // calls f(term) once per occurrence of a term among the given side's units
+    template <typename F>
+    inline void forEachTerm(const Position& pos, Color color, F&& f) {
+        auto units = pos.colorBb(color);
+
+        while (!units.empty()) {
+            const auto cell = units.popLowestCell();
+            const auto piece = pos.pieceOn(cell);
+
+            if (piece.isStack()) {
+                f(terms::kRoleValue + piece.upper().role().idx());
+                f(terms::kRoleValue + piece.lower().role().idx());
+            } else {
+                f(terms::kRoleValue + piece.role().idx());
+            }
+
+            if (piece.role() != Roles::kWise) {
+                f(terms::kAdvancement + geometry::goalDistance(color, cell));
+            }
+        }
+    }
+
+    // Static evaluation from the side to move's point of view: material, counting
+    // both pieces of a stack, and how close each non-wise-topped unit is to its goal row.
+    [[nodiscard]] Score evaluate(const Position& pos);
+} // namespace octachoron::eval
@@ -0,0 +1,389 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "index.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include "../movegen.h"
+#include "../symmetry.h"
+#include "reader.h"
+
+namespace octachoron::games {
+    namespace {
+        constexpr std::array kMagic = {'O', 'C', 'G', 'I'};
+        constexpr u32 kVersion = 1;
+
+        struct FileHeader {
+            std::array<char, 4> magic;
+            u32 version;
+            u64 entryCount;
+            u64 gamesSize;
+        };
+
+        static_assert(sizeof(FileHeader) % alignof(IndexEntry) == 0);
+
+        constexpr usize kMergeBufferEntries = 1 << 16;
+
+        [[nodiscard]] bool writeEntries(std::FILE* file, std::span<const IndexEntry> entries) {
+            return std::fwrite(entries.data(), sizeof(IndexEntry), entries.size(), file) == entries.size();
+        }
+
+        // Sorted runs spilled to disk by the indexing threads. Run files sit next to the
+        // output and are removed once merged, or on failure.
+        class Runs {
+        public:
+            explicit Runs(std::string prefix) :
+                    m_prefix{std::move(prefix)} {}
+
+            ~Runs() {
+                for (const auto& path : m_paths) {
+                    std::error_code error{};
+                    std::filesystem::remove(path, error);
+                }
+            }
+
+            Runs(const Runs&) = delete;
+            Runs(Runs&&) = delete;
+
+            // sorts the entries and writes them out as a new run
+            bool spill(std::vector<IndexEntry>& entries) {
+                std::ranges::sort(entries);
+
+                std::string path{};
+
+                {
+                    const std::scoped_lock lock{m_mutex};
+
+                    path = m_prefix + ".run" + std::to_string(m_paths.size());
+                    m_paths.push_back(path);
+                }
+
+                auto* file = std::fopen(path.c_str(), "wb");
+
+                if (!file) {
+                    return false;
+                }
+
+                const auto written = writeEntries(file, entries);
+                const auto closed = std::fclose(file) == 0;
+
+                entries.clear();
+
+                return written && closed;
+            }
+
+            [[nodiscard]] const std::vector<std::string>& paths() const {
+                return m_paths;
+            }
+
+            Runs& operator=(const Runs&) = delete;
+            Runs& operator=(Runs&&) = delete;
+
+        private:
+            std::string m_prefix;
+
+            std::mutex m_mutex{};
+            std::vector<std::string> m_paths{};
+        };
+
+        // k-way merge of the sorted runs into the index, after the header
+        bool mergeRuns(std::FILE* output, const std::vector<std::string>& paths, u64& entryCount) {
+            std::vector<util::MappedFile> files(paths.size());
+            std::vector<std::span<const IndexEntry>> runs{};
+
+            for (usize i = 0; i < paths.size(); ++i) {
+                if (!files[i].open(paths[i])) {
+                    return false;
+                }
+
+                const auto data = files[i].data();
+                runs.emplace_back(reinterpret_cast<const IndexEntry*>(data.data()), data.size() / sizeof(IndexEntry));
+            }
+
+            using Head = std::pair<IndexEntry, usize>;
+            std::priority_queue<Head, std::vector<Head>, std::greater<>> heads{};
+
+            std::vector<usize> cursors(runs.size());
+
+            for (usize i = 0; i < runs.size(); ++i) {
+                heads.emplace(runs[i][0], i);
+            }
+
+            std::vector<IndexEntry> buffer{};
+            buffer.reserve(kMergeBufferEntries);
+
+            entryCount = 0;
+
+            while (!heads.empty()) {
+                const auto [entry, run] = heads.top();
+                heads.pop();
+
+                buffer.push_back(entry);
+
+                if (++cursors[run] < runs[run].size()) {
+                    heads.emplace(runs[run][cursors[run]], run);
+                }
+
+                if (buffer.size() == kMergeBufferEntries) {
+                    if (!writeEntries(output, buffer)) {
+                        return false;
+                    }
+
+                    entryCount += buffer.size();
+                    buffer.clear();
+                }
+            }
+
+            entryCount += buffer.size();
+
+            return writeEntries(output, buffer);
+        }
+    } // namespace
+
+    bool buildIndex(const IndexConfig& config) {
+        if (std::filesystem::exists(config.output)) {
+            std::cerr << config.output << " already exists" << std::endl;
+            return false;
+        }
+
+        GameReader reader{};
+
+        if (!reader.open(config.games)) {
+            std::cerr << "failed to open " << config.games << std::endl;
+            return false;
+        }
+
+        if (reader.size() > IndexEntry::kOffsetMask) {
+            std::cerr << config.games << " is too large to index" << std::endl;
+            return false;
+        }
+
+        const auto ranges = reader.split(config.threads);
+
+        const auto bufferEntries =
+            std::max<usize>(config.memoryMb * 1024 * 1024 / sizeof(IndexEntry) / ranges.size(), 1024);
+
+        Runs runs{config.output};
+
+        std::atomic_bool failed{false};
+
+        std::atomic<u64> games{0};
+        std::atomic<u64> errors{0};
+
+        std::vector<std::thread> threads{};
+
+        for (const auto range : ranges) {
+            threads.emplace_back([&, range] {
+                std::vector<IndexEntry> entries{};
+                entries.reserve(bufferEntries);
+
+                const auto stats = reader.read(range, [&](const GameView& game) {
+                    const auto plies = std::min<usize>(game.moves.size(), config.maxPlies);
+                    const auto resultBits = static_cast<u64>(game.result) << IndexEntry::kResultShift;
+
+                    for (usize ply = 0; ply < plies; ++ply) {
+                        const auto& pos = game.positions[ply];
+                        const auto move = transform(game.moves[ply], pos.canonicalSymmetry());
+
+                        const auto moveBits = static_cast<u64>(move.raw()) << IndexEntry::kMoveShift;
+
+                        entries.push_back({pos.canonicalKey(), moveBits | resultBits | game.offset});
+                    }
+
+                    if (entries.size() >= bufferEntries && !runs.spill(entries)) {
+                        failed.store(true, std::memory_order::relaxed);
+                    }
+
+                    return !failed.load(std::memory_order::relaxed);
+                });
+
+                if (!entries.empty() && !runs.spill(entries)) {
+                    failed.store(true, std::memory_order::relaxed);
+                }
+
+                games.fetch_add(stats.games, std::memory_order::relaxed);
+                errors.fetch_add(stats.errors, std::memory_order::relaxed);
+            });
+        }
+
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        if (failed.load()) {
+            std::cerr << "failed to write sorted runs" << std::endl;
+            return false;
+        }
+
+        std::cout << "indexed " << games.load() << " games, skipped " << errors.load() << ", merging "
+                  << runs.paths().size() << " runs" << std::endl;
+
+        auto* output = std::fopen(config.output.c_str(), "wb");
+
+        if (!output) {
+            std::cerr << "failed to open " << config.output << std::endl;
+            return false;
+        }
+
+        FileHeader header{};
+
+        header.magic = kMagic;
+        header.version = kVersion;
+        header.gamesSize = reader.size();
+
+        // rewritten with the entry count once merged
+        bool success = std::fwrite(&header, sizeof(FileHeader), 1, output) == 1;
+
+        success = success && mergeRuns(output, runs.paths(), header.entryCount);
+
+        success = success && std::fseek(output, 0, SEEK_SET) == 0
+               && std::fwrite(&header, sizeof(FileHeader), 1, output) == 1;
+
+        success &= std::fclose(output) == 0;
+
+        if (!success) {
+            std::cerr << "failed to write " << config.output << std::endl;
+
+            std::error_code error{};
+            std::filesystem::remove(config.output, error);
+
+            return false;
+        }
+
+        std::cout << "wrote " << header.entryCount << " entries" << std::endl;
+
+        return true;
+    }
+
+    bool Index::open(const std::string& path) {
+        close();
+
+        if (!m_file.open(path)) {
+            return false;
+        }
+
+        const auto data = m_file.data();
+
+        FileHeader header{};
+
+        if (data.size() >= sizeof(FileHeader)) {
+            std::memcpy(&header, data.data(), sizeof(FileHeader));
+        }
+
+        if (header.magic != kMagic || header.version != kVersion
+            || data.size() != sizeof(FileHeader) + header.entryCount * sizeof(IndexEntry))
+        {
+            m_file.close();
+            return false;
+        }
+
+        // the header is a multiple of the entry alignment and mappings are page aligned
+        m_entries = {reinterpret_cast<const IndexEntry*>(data.data() + sizeof(FileHeader)), header.entryCount};
+        m_gamesSize = header.gamesSize;
+
+        return true;
+    }
+
+    void Index::close() {
+        m_file.close();
+        m_entries = {};
+        m_gamesSize = 0;
+    }
+
+    std::vector<MoveStats> Index::probe(const Position& pos) const {
+        std::vector<MoveStats> moves{};
+
+        const auto entries = find(pos.canonicalKey());
+
+        if (entries.empty()) {
+            return moves;
+        }
+
+        const auto symmetry = pos.canonicalSymmetry();
+
+        // the first entry whose data is at least bound
+        const auto lowerBound = [](std::span<const IndexEntry> range, u64 bound) {
+            return std::ranges::lower_bound(range, bound, std::ranges::less{}, &IndexEntry::data);
+        };
+
+        auto first = entries.begin();
+
+        while (first != entries.end()) {
+            const auto moveBits = first->data >> IndexEntry::kMoveShift;
+            const auto moveEnd = lowerBound({first, entries.end()}, (moveBits + 1) << IndexEntry::kMoveShift);
+
+            // symmetries are their own inverses
+            const auto move = transform(first->move(), symmetry);
+
+            // guards against key collisions and corrupt files
+            if (isLegal(pos, move)) {
+                MoveStats stats{move, static_cast<u64>(moveEnd - first), {}, first->offset()};
+
+                auto resultStart = first;
+
+                for (u64 result = 0; result < stats.results.size(); ++result) {
+                    const auto bound =
+                        (moveBits << IndexEntry::kMoveShift) | ((result + 1) << IndexEntry::kResultShift);
+                    const auto resultEnd = lowerBound({resultStart, moveEnd}, bound);
+
+                    stats.results[result] = static_cast<u64>(resultEnd - resultStart);
+                    resultStart = resultEnd;
+                }
+
+                moves.push_back(stats);
+            }
+
+            first = moveEnd;
+        }
+
+        std::ranges::stable_sort(moves, std::ranges::greater{}, &MoveStats::games);
+
+        return moves;
+    }
+
+    std::vector<u64> Index::games(const Position& pos, usize limit) const {
+        const auto entries = find(pos.canonicalKey());
+
+        std::vector<u64> offsets{};
+        offsets.reserve(std::min(entries.size(), limit));
+
+        for (const auto& entry : entries.first(std::min(entries.size(), limit))) {
+            offsets.push_back(entry.offset());
+        }
+
+        return offsets;
+    }
+
+    std::span<const IndexEntry> Index::find(u64 key) const {
+        const auto [first, last] =
+            std::ranges::equal_range(m_entries, key, std::ranges::less{}, &IndexEntry::key);
+
+        return {first, last};
+    }
+} // namespace octachoron::games
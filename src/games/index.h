@@ -0,0 +1,126 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "../types.h"
+
+#include <array>
+#include <compare>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "../data/packed.h"
+#include "../move.h"
+#include "../position.h"
+#include "../util/mapped_file.h"
+
+namespace octachoron::games {
+    // Index files hold a header and then one entry for every move played in the indexed part
+    // of every game, sorted. As in books, positions are stored under their canonical key with
+    // moves in the canonical orientation, so symmetric positions share their statistics.
+    struct IndexEntry {
+        u64 key;
+        // move (Move::raw()) in bits 42-63, result in bits 40-41 and the game's byte offset
+        // in its file in bits 0-39, so that sorting groups entries by move and then by result
+        u64 data;
+
+        static constexpr i32 kMoveShift = 42;
+        static constexpr i32 kResultShift = 40;
+
+        static constexpr u64 kOffsetMask = (UINT64_C(1) << kResultShift) - 1;
+
+        [[nodiscard]] inline Move move() const {
+            return Move::fromRaw(static_cast<u32>(data >> kMoveShift));
+        }
+
+        [[nodiscard]] inline data::Outcome result() const {
+            return static_cast<data::Outcome>((data >> kResultShift) & 0b11);
+        }
+
+        [[nodiscard]] inline u64 offset() const {
+            return data & kOffsetMask;
+        }
+
+        [[nodiscard]] constexpr auto operator<=>(const IndexEntry&) const = default;
+    };
+
+    static_assert(sizeof(IndexEntry) == 16);
+
+    constexpr const char* kIndexExtension = ".ogi";
+
+    struct IndexConfig {
+        std::string games{};
+        std::string output{};
+
+        u32 threads{1};
+        // plies indexed from the start of each game
+        u32 maxPlies{40};
+        // for sorting. entries beyond it are sorted in runs on disk, then merged
+        usize memoryMb{1024};
+    };
+
+    // Scans a game file once and writes its index. Refuses to overwrite an existing index.
+    bool buildIndex(const IndexConfig& config);
+
+    struct MoveStats {
+        Move move;
+        u64 games;
+        // indexed by data::Outcome
+        std::array<u64, 3> results;
+        // byte offset of one game with the move, to look it up
+        u64 sampleOffset;
+    };
+
+    // Maps an index and answers queries by binary search, so queries take microseconds
+    // however many games it covers. Read-only, safe to query from any number of threads.
+    class Index {
+    public:
+        bool open(const std::string& path);
+        void close();
+
+        [[nodiscard]] inline bool isOpen() const {
+            return m_file.isOpen();
+        }
+
+        [[nodiscard]] inline usize size() const {
+            return m_entries.size();
+        }
+
+        // size of the game file that was indexed, to catch mismatched files
+        [[nodiscard]] inline u64 gamesSize() const {
+            return m_gamesSize;
+        }
+
+        // every legal move played in the position, most played first. Each is a handful of
+        // binary searches within the position's entries, however many games reached it
+        [[nodiscard]] std::vector<MoveStats> probe(const Position& pos) const;
+
+        // byte offsets of up to limit games that reached the position, grouped by the move played
+        [[nodiscard]] std::vector<u64> games(const Position& pos, usize limit) const;
+
+    private:
+        util::MappedFile m_file{};
+        std::span<const IndexEntry> m_entries{};
+
+        u64 m_gamesSize{};
+
+        [[nodiscard]] std::span<const IndexEntry> find(u64 key) const;
+    };
+} // namespace octachoron::games
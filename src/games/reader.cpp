@@ -0,0 +1,455 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "reader.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <iostream>
+#include <optional>
+#include <string_view>
+#include <thread>
+
+#include "../movegen.h"
+
+namespace octachoron::games {
+    namespace {
+        // reused from game to game, so that steady-state parsing never allocates
+        struct Buffers {
+            std::vector<Tag> tags{};
+            std::vector<Position> positions{};
+            std::vector<Move> moves{};
+
+            void clear() {
+                tags.clear();
+                positions.clear();
+                moves.clear();
+            }
+
+            [[nodiscard]] bool play(Move move) {
+                const auto& pos = positions.back();
+
+                if (pos.winner() != Colors::kNone || !isLegal(pos, move)) {
+                    return false;
+                }
+
+                moves.push_back(move);
+                positions.push_back(pos.applyMove(move));
+
+                return true;
+            }
+        };
+
+        [[nodiscard]] bool isSpace(char c) {
+            return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+        }
+
+        [[nodiscard]] std::optional<data::Outcome> parseResult(std::string_view str) {
+            if (str == "1-0") {
+                return data::Outcome::kWhiteWin;
+            } else if (str == "0-1") {
+                return data::Outcome::kBlackWin;
+            } else if (str == "1/2-1/2") {
+                return data::Outcome::kDraw;
+            } else {
+                return {};
+            }
+        }
+
+        [[nodiscard]] u64 readInt(std::string_view data, u64 offset, usize bytes) {
+            u64 value = 0;
+
+            for (usize i = 0; i < bytes; ++i) {
+                value |= static_cast<u64>(static_cast<u8>(data[offset + i])) << (i * 8);
+            }
+
+            return value;
+        }
+
+        // -> false if a Fen tag is malformed
+        [[nodiscard]] bool addTag(Buffers& buffers, Position& start, std::string_view key, std::string_view value) {
+            if (key == kFenTag) {
+                const auto pos = Position::fromFen(value);
+
+                if (!pos) {
+                    return false;
+                }
+
+                start = *pos;
+            } else if (key != kResultTag) {
+                buffers.tags.push_back({key, value});
+            }
+
+            return true;
+        }
+
+        // parses the game at cursor and moves cursor past it. -> an error, or nullptr
+        [[nodiscard]] const char* parseText(std::string_view data, u64& cursor, Buffers& buffers, GameView& game) {
+            auto start = Position::startpos();
+
+            while (cursor < data.size() && data[cursor] == '[') {
+                auto lineEnd = data.find('\n', cursor);
+
+                if (lineEnd == std::string_view::npos) {
+                    lineEnd = data.size();
+                }
+
+                auto line = data.substr(cursor, lineEnd - cursor);
+                cursor = lineEnd + 1;
+
+                if (line.ends_with('\r')) {
+                    line.remove_suffix(1);
+                }
+
+                // [Key "Value"]
+                const auto space = line.find(' ');
+
+                if (space == std::string_view::npos || line.size() < space + 4 || line[space + 1] != '"'
+                    || !line.ends_with("\"]"))
+                {
+                    return "malformed tag";
+                }
+
+                const auto key = line.substr(1, space - 1);
+                const auto value = line.substr(space + 2, line.size() - space - 4);
+
+                if (!addTag(buffers, start, key, value)) {
+                    return "invalid fen";
+                }
+            }
+
+            buffers.positions.push_back(start);
+
+            while (true) {
+                while (cursor < data.size() && isSpace(data[cursor])) {
+                    ++cursor;
+                }
+
+                if (cursor >= data.size() || data[cursor] == '[') {
+                    return "missing result";
+                }
+
+                const auto tokenStart = cursor;
+
+                while (cursor < data.size() && !isSpace(data[cursor])) {
+                    ++cursor;
+                }
+
+                const auto token = data.substr(tokenStart, cursor - tokenStart);
+
+                if (const auto result = parseResult(token)) {
+                    game.result = *result;
+                    return nullptr;
+                }
+
+                const auto move = parseMove(buffers.positions.back(), token);
+
+                if (!move || !buffers.play(*move)) {
+                    return "illegal move";
+                }
+            }
+        }
+
+        // -> an error, or nullptr. end is always set, to the end of the file if the record's size is unusable
+        [[nodiscard]] const char* parseBinary(
+            std::string_view data, u64 offset, u64& end, Buffers& buffers, GameView& game) {
+            if (data.size() - offset < 4) {
+                end = data.size();
+                return "truncated record";
+            }
+
+            end = offset + 4 + readInt(data, offset, 4);
+
+            if (end > data.size() || end - offset < kBinaryRecordHeaderSize) {
+                end = data.size();
+                return "truncated record";
+            }
+
+            u64 cursor = offset + 4;
+
+            const auto result = readInt(data, cursor, 1);
+            const auto tagCount = readInt(data, cursor + 1, 1);
+            const auto moveCount = readInt(data, cursor + 2, 2);
+
+            cursor += 4;
+
+            if (result > static_cast<u64>(data::Outcome::kWhiteWin)) {
+                return "invalid result";
+            }
+
+            game.result = static_cast<data::Outcome>(result);
+
+            auto start = Position::startpos();
+
+            for (u64 i = 0; i < tagCount; ++i) {
+                if (end - cursor < 1) {
+                    return "truncated tag";
+                }
+
+                const auto keySize = readInt(data, cursor, 1);
+
+                if (end - cursor < 1 + keySize + 2) {
+                    return "truncated tag";
+                }
+
+                const auto key = data.substr(cursor + 1, keySize);
+                const auto valueSize = readInt(data, cursor + 1 + keySize, 2);
+
+                cursor += 1 + keySize + 2;
+
+                if (end - cursor < valueSize) {
+                    return "truncated tag";
+                }
+
+                const auto value = data.substr(cursor, valueSize);
+                cursor += valueSize;
+
+                if (!addTag(buffers, start, key, value)) {
+                    return "invalid fen";
+                }
+            }
+
+            if (end - cursor != moveCount * kBinaryMoveSize) {
+                return "wrong record size";
+            }
+
+            buffers.positions.push_back(start);
+
+            for (; cursor < end; cursor += kBinaryMoveSize) {
+                if (!buffers.play(Move::fromRaw(static_cast<u32>(readInt(data, cursor, kBinaryMoveSize))))) {
+                    return "illegal move";
+                }
+            }
+
+            return nullptr;
+        }
+
+        void reportError(const char* error, u64 offset) {
+            std::cerr << error << " in game at byte " << offset << ", skipping" << std::endl;
+        }
+    } // namespace
+
+    bool GameReader::open(const std::string& path) {
+        close();
+
+        if (!m_file.open(path)) {
+            return false;
+        }
+
+        const auto data = m_file.data();
+
+        BinaryHeader header{};
+
+        if (data.size() >= sizeof(BinaryHeader)) {
+            std::memcpy(&header, data.data(), sizeof(BinaryHeader));
+        }
+
+        if (header.magic != kBinaryMagic) {
+            m_format = Format::kText;
+            return true;
+        }
+
+        if (header.version != kBinaryVersion) {
+            m_file.close();
+            return false;
+        }
+
+        m_format = Format::kBinary;
+
+        return true;
+    }
+
+    void GameReader::close() {
+        m_file.close();
+    }
+
+    std::vector<ByteRange> GameReader::split(u32 parts) const {
+        const auto size = static_cast<u64>(m_file.size());
+        parts = std::max<u32>(parts, 1);
+
+        std::vector<u64> starts{};
+
+        if (m_format == Format::kText) {
+            starts.push_back(0);
+
+            for (u32 i = 1; i < parts; ++i) {
+                const auto start = nextTextGame(size * i / parts);
+
+                if (start > starts.back() && start < size) {
+                    starts.push_back(start);
+                }
+            }
+        } else {
+            const std::string_view data{reinterpret_cast<const char*>(m_file.data().data()), m_file.size()};
+
+            u64 cursor = sizeof(BinaryHeader);
+            starts.push_back(cursor);
+
+            // records are only a few hundred bytes, so walking the sizes touches little
+            for (u32 next = 1; next < parts && cursor + 4 <= data.size();) {
+                if (cursor >= size * next / parts) {
+                    if (cursor > starts.back()) {
+                        starts.push_back(cursor);
+                    }
+
+                    ++next;
+                    continue;
+                }
+
+                cursor += 4 + readInt(data, cursor, 4);
+            }
+        }
+
+        std::vector<ByteRange> ranges{};
+
+        for (usize i = 0; i < starts.size(); ++i) {
+            ranges.push_back({starts[i], i + 1 < starts.size() ? starts[i + 1] : size});
+        }
+
+        return ranges;
+    }
+
+    ReadStats GameReader::read(ByteRange range, const GameCallback& callback) const {
+        const std::string_view data{reinterpret_cast<const char*>(m_file.data().data()), m_file.size()};
+
+        ReadStats stats{};
+        Buffers buffers{};
+
+        auto cursor = range.begin;
+
+        if (m_format == Format::kBinary) {
+            cursor = std::max<u64>(cursor, sizeof(BinaryHeader));
+        }
+
+        while (true) {
+            if (m_format == Format::kText) {
+                while (cursor < data.size() && isSpace(data[cursor])) {
+                    ++cursor;
+                }
+            }
+
+            if (cursor >= range.end || cursor >= data.size()) {
+                break;
+            }
+
+            buffers.clear();
+
+            const auto offset = cursor;
+
+            GameView game{};
+            const char* error{};
+
+            if (m_format == Format::kText) {
+                error = parseText(data, cursor, buffers, game);
+
+                if (error) {
+                    cursor = nextTextGame(offset + 1);
+                }
+            } else {
+                u64 end{};
+                error = parseBinary(data, offset, end, buffers, game);
+                cursor = end;
+            }
+
+            if (error) {
+                reportError(error, offset);
+                ++stats.errors;
+                continue;
+            }
+
+            game.offset = offset;
+            game.tags = buffers.tags;
+            game.positions = buffers.positions;
+            game.moves = buffers.moves;
+
+            ++stats.games;
+            stats.moves += game.moves.size();
+
+            if (!callback(game)) {
+                break;
+            }
+        }
+
+        return stats;
+    }
+
+    ReadStats GameReader::read(u32 threads, const GameCallback& callback) const {
+        const auto ranges = split(threads);
+
+        std::atomic_bool stopped{false};
+
+        std::atomic<u64> games{0};
+        std::atomic<u64> moves{0};
+        std::atomic<u64> errors{0};
+
+        // stops every thread once any callback asks to
+        const GameCallback wrapped = [&](const GameView& game) {
+            if (stopped.load(std::memory_order::relaxed) || !callback(game)) {
+                stopped.store(true, std::memory_order::relaxed);
+                return false;
+            }
+
+            return true;
+        };
+
+        std::vector<std::thread> workers{};
+
+        for (const auto range : ranges) {
+            workers.emplace_back([&, range] {
+                const auto stats = read(range, wrapped);
+
+                games.fetch_add(stats.games, std::memory_order::relaxed);
+                moves.fetch_add(stats.moves, std::memory_order::relaxed);
+                errors.fetch_add(stats.errors, std::memory_order::relaxed);
+            });
+        }
+
+        for (auto& worker : workers) {
+            worker.join();
+        }
+
+        return {games.load(), moves.load(), errors.load()};
+    }
+
+    u64 GameReader::nextTextGame(u64 offset) const {
+        const std::string_view data{reinterpret_cast<const char*>(m_file.data().data()), m_file.size()};
+
+        if (offset == 0) {
+            return 0;
+        }
+
+        // a tag line after a line that is not one
+        for (auto newline = data.find('\n', offset - 1); newline != std::string_view::npos;
+             newline = data.find('\n', newline + 1))
+        {
+            if (newline + 1 >= data.size() || data[newline + 1] != '[') {
+                continue;
+            }
+
+            // npos + 1 wraps around to the start of the file
+            const auto previous = newline == 0 ? 0 : data.rfind('\n', newline - 1) + 1;
+
+            if (data[previous] != '[') {
+                return newline + 1;
+            }
+        }
+
+        return data.size();
+    }
+} // namespace octachoron::games
@@ -0,0 +1,86 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "../types.h"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "../util/mapped_file.h"
+#include "record.h"
+
+namespace octachoron::games {
+    // return false to stop reading
+    using GameCallback = std::function<bool(const GameView&)>;
+
+    struct ReadStats {
+        u64 games{};
+        u64 moves{};
+        // malformed games, reported and skipped
+        u64 errors{};
+    };
+
+    struct ByteRange {
+        u64 begin;
+        u64 end;
+    };
+
+    // Maps a game file of either format and parses it in place. Moves are checked for
+    // legality and replayed with Position::applyMove; parsing reuses per-call buffers, so
+    // after the first few games it does not allocate. Read-only once open, so any number
+    // of threads may read ranges of the same file at once.
+    class GameReader {
+    public:
+        // the format is detected from the binary header
+        bool open(const std::string& path);
+        void close();
+
+        [[nodiscard]] inline bool isOpen() const {
+            return m_file.isOpen();
+        }
+
+        [[nodiscard]] inline Format format() const {
+            return m_format;
+        }
+
+        [[nodiscard]] inline usize size() const {
+            return m_file.size();
+        }
+
+        // Up to `parts` ranges of roughly equal size covering the file, each starting at the
+        // start of a game. Text files are split by scanning for game boundaries, binary files
+        // by walking the record sizes.
+        [[nodiscard]] std::vector<ByteRange> split(u32 parts) const;
+
+        // parses every game that starts within the range, in order
+        ReadStats read(ByteRange range, const GameCallback& callback) const;
+
+        // Splits the file into one range per thread and reads them all at once. The callback
+        // is called from every thread, and games arrive in no particular order.
+        ReadStats read(u32 threads, const GameCallback& callback) const;
+
+    private:
+        util::MappedFile m_file{};
+        Format m_format{};
+
+        [[nodiscard]] u64 nextTextGame(u64 offset) const;
+    };
+} // namespace octachoron::games
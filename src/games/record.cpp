@@ -0,0 +1,224 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "record.h"
+
+namespace octachoron::games {
+    namespace {
+        // text movetext lines are wrapped once they pass this
+        constexpr usize kLineLength = 80;
+
+        void appendInt(std::string& dst, u64 value, usize bytes) {
+            for (usize i = 0; i < bytes; ++i) {
+                dst.push_back(static_cast<char>((value >> (i * 8)) & 0xFF));
+            }
+        }
+    } // namespace
+
+    std::string_view resultString(data::Outcome result) {
+        switch (result) {
+            case data::Outcome::kBlackWin:
+                return "0-1";
+            case data::Outcome::kDraw:
+                return "1/2-1/2";
+            case data::Outcome::kWhiteWin:
+                return "1-0";
+        }
+
+        return "*";
+    }
+
+    GameWriter::~GameWriter() {
+        close();
+    }
+
+    bool GameWriter::open(const std::string& path, Format format) {
+        close();
+
+        BinaryHeader existing{};
+        usize existingSize = 0;
+
+        if (auto* file = std::fopen(path.c_str(), "rb")) {
+            existingSize = std::fread(&existing, 1, sizeof(BinaryHeader), file);
+            std::fclose(file);
+        }
+
+        const auto binaryFile = existingSize == sizeof(BinaryHeader) && existing.magic == kBinaryMagic;
+
+        if (existingSize > 0 && binaryFile != (format == Format::kBinary)) {
+            return false;
+        }
+
+        if (binaryFile && existing.version != kBinaryVersion) {
+            return false;
+        }
+
+        m_file = std::fopen(path.c_str(), "ab");
+
+        if (!m_file) {
+            return false;
+        }
+
+        m_format = format;
+        m_buffer.reserve(kBufferSize);
+
+        if (format == Format::kBinary && existingSize == 0) {
+            const BinaryHeader header{kBinaryMagic, kBinaryVersion};
+            m_buffer.append(reinterpret_cast<const char*>(&header), sizeof(BinaryHeader));
+        }
+
+        return true;
+    }
+
+    bool GameWriter::close() {
+        if (!m_file) {
+            return true;
+        }
+
+        const auto flushed = flush();
+        const auto closed = std::fclose(m_file) == 0;
+
+        m_file = nullptr;
+
+        return flushed && closed;
+    }
+
+    bool GameWriter::write(std::span<const Tag> tags, const Position& start, std::span<const Move> moves,
+        data::Outcome result) {
+        assert(m_file);
+
+        if (m_format == Format::kText) {
+            writeText(tags, start, moves, result);
+        } else if (!writeBinary(tags, start, moves, result)) {
+            return false;
+        }
+
+        if (m_buffer.size() >= kBufferSize) {
+            return flush();
+        }
+
+        return true;
+    }
+
+    bool GameWriter::flush() {
+        if (!m_file) {
+            return false;
+        }
+
+        const auto written = std::fwrite(m_buffer.data(), 1, m_buffer.size(), m_file);
+        const auto success = written == m_buffer.size() && std::fflush(m_file) == 0;
+
+        m_buffer.clear();
+
+        return success;
+    }
+
+    void GameWriter::writeText(std::span<const Tag> tags, const Position& start, std::span<const Move> moves,
+        data::Outcome result) {
+        const auto appendTag = [&](std::string_view key, std::string_view value) {
+            m_buffer += '[';
+            m_buffer += key;
+            m_buffer += " \"";
+            m_buffer += value;
+            m_buffer += "\"]\n";
+        };
+
+        for (const auto& tag : tags) {
+            appendTag(tag.key, tag.value);
+        }
+
+        if (start != Position::startpos()) {
+            appendTag(kFenTag, start.toFen());
+        }
+
+        appendTag(kResultTag, resultString(result));
+
+        m_buffer += '\n';
+
+        auto lineStart = m_buffer.size();
+
+        for (const auto move : moves) {
+            move.appendTo(m_buffer);
+
+            if (m_buffer.size() - lineStart >= kLineLength) {
+                m_buffer += '\n';
+                lineStart = m_buffer.size();
+            } else {
+                m_buffer += ' ';
+            }
+        }
+
+        m_buffer += resultString(result);
+        m_buffer += "\n\n";
+    }
+
+    bool GameWriter::writeBinary(std::span<const Tag> tags, const Position& start, std::span<const Move> moves,
+        data::Outcome result) {
+        const auto fen = start != Position::startpos() ? start.toFen() : std::string{};
+        const auto tagCount = tags.size() + !fen.empty();
+
+        if (tagCount > UINT8_MAX || moves.size() > UINT16_MAX) {
+            return false;
+        }
+
+        const auto recordStart = m_buffer.size();
+
+        // size, filled in below
+        appendInt(m_buffer, 0, 4);
+
+        appendInt(m_buffer, static_cast<u64>(result), 1);
+        appendInt(m_buffer, tagCount, 1);
+        appendInt(m_buffer, moves.size(), 2);
+
+        bool valid = true;
+
+        const auto appendTag = [&](std::string_view key, std::string_view value) {
+            valid &= key.size() <= UINT8_MAX && value.size() <= UINT16_MAX;
+
+            appendInt(m_buffer, key.size(), 1);
+            m_buffer += key;
+            appendInt(m_buffer, value.size(), 2);
+            m_buffer += value;
+        };
+
+        for (const auto& tag : tags) {
+            appendTag(tag.key, tag.value);
+        }
+
+        if (!fen.empty()) {
+            appendTag(kFenTag, fen);
+        }
+
+        for (const auto move : moves) {
+            appendInt(m_buffer, move.raw(), kBinaryMoveSize);
+        }
+
+        if (!valid) {
+            m_buffer.resize(recordStart);
+            return false;
+        }
+
+        const auto size = m_buffer.size() - recordStart - 4;
+
+        for (usize i = 0; i < 4; ++i) {
+            m_buffer[recordStart + i] = static_cast<char>((size >> (i * 8)) & 0xFF);
+        }
+
+        return true;
+    }
+} // namespace octachoron::games
@@ -0,0 +1,138 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "../types.h"
+
+#include <array>
+#include <cstdio>
+#include <span>
+#include <string>
+#include <string_view>
+
+#include "../data/packed.h"
+#include "../move.h"
+#include "../position.h"
+
+namespace octachoron::games {
+    // Text records are a block of tags, one per line, then a blank line, then the moves in
+    // the notation Move prints, separated by whitespace and ended by the result:
+    //
+    //   [White "playouts=800"]
+    //   [Black "playouts=1600"]
+    //   [Result "0-1"]
+    //
+    //   a5b6d5 g2f2d1 ... 0-1
+    //
+    // Games follow each other separated by a blank line, so a line starting with '[' after a
+    // line that does not is always the start of a game.
+    //
+    // Binary files start with a header, then hold one record per game, little endian:
+    //  - u32 size of the rest of the record
+    //  - u8 result (data::Outcome), u8 tag count, u16 move count
+    //  - each tag as u8 key length, key, u16 value length, value
+    //  - each move as the low 3 bytes of Move::raw()
+    //
+    // In both formats a Fen tag gives the start position of games that do not start from
+    // startpos. Readers consume it, and the Result tag, rather than passing them on.
+    enum class Format : u8 {
+        kText = 0,
+        kBinary,
+    };
+
+    constexpr std::string_view kFenTag = "Fen";
+    constexpr std::string_view kResultTag = "Result";
+
+    inline constexpr std::array kBinaryMagic = {'O', 'C', 'G', 'R'};
+    constexpr u32 kBinaryVersion = 1;
+
+    struct BinaryHeader {
+        std::array<char, 4> magic;
+        u32 version;
+    };
+
+    // binary records: size, result, tag count and move count
+    constexpr usize kBinaryRecordHeaderSize = 8;
+    constexpr usize kBinaryMoveSize = 3;
+
+    struct Tag {
+        std::string_view key;
+        std::string_view value;
+    };
+
+    // "1-0", "0-1" or "1/2-1/2"
+    [[nodiscard]] std::string_view resultString(data::Outcome result);
+
+    // A game as handed out by readers. Everything is a view into the reader's file or buffers
+    // and only lives until the callback returns.
+    struct GameView {
+        // byte offset of the record within its file
+        u64 offset;
+        std::span<const Tag> tags;
+        // positions[i] is the position moves[i] was played in, followed by the final position
+        std::span<const Position> positions;
+        std::span<const Move> moves;
+        data::Outcome result;
+
+        [[nodiscard]] inline const Position& start() const {
+            return positions.front();
+        }
+    };
+
+    // Appends games to a file in either format, buffering them into large writes.
+    class GameWriter {
+    public:
+        GameWriter() = default;
+        ~GameWriter();
+
+        GameWriter(const GameWriter&) = delete;
+        GameWriter(GameWriter&&) = delete;
+
+        // appends to the file if it exists, which must then be in the same format
+        bool open(const std::string& path, Format format);
+        bool close();
+
+        [[nodiscard]] inline bool isOpen() const {
+            return m_file != nullptr;
+        }
+
+        // a Fen tag is added for starts other than startpos, and a Result tag to text records.
+        // Tags must not contain newlines or quotes
+        bool write(std::span<const Tag> tags, const Position& start, std::span<const Move> moves,
+            data::Outcome result);
+
+        bool flush();
+
+        GameWriter& operator=(const GameWriter&) = delete;
+        GameWriter& operator=(GameWriter&&) = delete;
+
+    private:
+        static constexpr usize kBufferSize = 1 << 20;
+
+        std::FILE* m_file{};
+        Format m_format{};
+
+        std::string m_buffer{};
+
+        void writeText(std::span<const Tag> tags, const Position& start, std::span<const Move> moves,
+            data::Outcome result);
+        bool writeBinary(std::span<const Tag> tags, const Position& start, std::span<const Move> moves,
+            data::Outcome result);
+    };
+} // namespace octachoron::games
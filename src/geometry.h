@@ -0,0 +1,264 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "types.h"
+
+#include <array>
+
+#include "bitboard.h"
+#include "core.h"
+
+namespace octachoron::geometry {
+    enum class Direction : u8 {
+        kNorthWest = 0,
+        kNorthEast,
+        kWest,
+        kEast,
+        kSouthWest,
+        kSouthEast,
+    };
+
+    constexpr usize kDirectionCount = 6;
+
+    constexpr std::array kDirections = {
+        Direction::kNorthWest,
+        Direction::kNorthEast,
+        Direction::kWest,
+        Direction::kEast,
+        Direction::kSouthWest,
+        Direction::kSouthEast,
+    };
+
+    struct TwoStep {
+        // the cell passed over, which must be empty for a two-cell stack move
+        Cell mid{Cells::kNone};
+        Cell dest{Cells::kNone};
+    };
+
+    namespace detail {
+        // Doubled-width hex coordinates: the 6-cell rows sit half a cell to the right
+        // of the 7-cell rows, so x advances by 2 along a row and by 1 on a diagonal step
+        [[nodiscard]] constexpr i32 doubledX(Cell cell) {
+            return static_cast<i32>(cell.column() * 2 + !(cell.row() & 1));
+        }
+
+        [[nodiscard]] constexpr Cell fromDoubled(i32 row, i32 x) {
+            if (row < 0 || row >= 7) {
+                return Cells::kNone;
+            }
+
+            const auto parity = !(row & 1);
+
+            if (x < 0 || (x & 1) != parity) {
+                return Cells::kNone;
+            }
+
+            const auto column = static_cast<u32>(x - parity) / 2;
+
+            if (column >= Cell::rowLength(static_cast<u32>(row))) {
+                return Cells::kNone;
+            }
+
+            return Cell::fromCoords(static_cast<u32>(row), column);
+        }
+
+        [[nodiscard]] constexpr Cell step(Cell cell, Direction dir) {
+            constexpr std::array<i32, kDirectionCount> kDeltaRow = {1, 1, 0, 0, -1, -1};
+            constexpr std::array<i32, kDirectionCount> kDeltaX = {-1, 1, -2, 2, -1, 1};
+
+            if (cell == Cells::kNone) {
+                return Cells::kNone;
+            }
+
+            const auto idx = static_cast<usize>(dir);
+            return fromDoubled(static_cast<i32>(cell.row()) + kDeltaRow[idx], doubledX(cell) + kDeltaX[idx]);
+        }
+
+        [[nodiscard]] constexpr u32 distance(Cell a, Cell b) {
+            const auto absDiff = [](i32 x, i32 y) { return static_cast<u32>(x > y ? x - y : y - x); };
+
+            const auto dy = absDiff(static_cast<i32>(a.row()), static_cast<i32>(b.row()));
+            const auto dx = absDiff(doubledX(a), doubledX(b));
+
+            return dy + (dx > dy ? (dx - dy) / 2 : 0);
+        }
+
+        template <typename T>
+        using CellTable = std::array<T, Cells::kCount>;
+
+        template <typename T>
+        using DirectionTable = CellTable<std::array<T, kDirectionCount>>;
+
+        constexpr auto kNeighbours = [] {
+            DirectionTable<Cell> neighbours{};
+
+            for (u8 id = 0; id < Cells::kCount; ++id) {
+                for (const auto dir : kDirections) {
+                    neighbours[id][static_cast<usize>(dir)] = step(Cell::fromRaw(id), dir);
+                }
+            }
+
+            return neighbours;
+        }();
+
+        constexpr auto kTwoSteps = [] {
+            DirectionTable<TwoStep> twoSteps{};
+
+            for (u8 id = 0; id < Cells::kCount; ++id) {
+                for (const auto dir : kDirections) {
+                    const auto mid = kNeighbours[id][static_cast<usize>(dir)];
+                    const auto dest = step(mid, dir);
+
+                    // assign every entry explicitly, rather than relying on TwoStep's
+                    // default member initialisers (gcc 12 emits zeroes for those here)
+                    twoSteps[id][static_cast<usize>(dir)] =
+                        dest != Cells::kNone ? TwoStep{mid, dest} : TwoStep{Cells::kNone, Cells::kNone};
+                }
+            }
+
+            return twoSteps;
+        }();
+
+        constexpr auto kNeighbourBbs = [] {
+            CellTable<Bitboard> bbs{};
+
+            for (u8 id = 0; id < Cells::kCount; ++id) {
+                for (const auto neighbour : kNeighbours[id]) {
+                    bbs[id] |= Bitboard::fromCellOrZero(neighbour);
+                }
+            }
+
+            return bbs;
+        }();
+
+        constexpr auto kTwoStepBbs = [] {
+            CellTable<Bitboard> bbs{};
+
+            for (u8 id = 0; id < Cells::kCount; ++id) {
+                for (const auto twoStep : kTwoSteps[id]) {
+                    bbs[id] |= Bitboard::fromCellOrZero(twoStep.dest);
+                }
+            }
+
+            return bbs;
+        }();
+
+        constexpr auto kDistances = [] {
+            CellTable<CellTable<u8>> distances{};
+
+            for (u8 a = 0; a < Cells::kCount; ++a) {
+                for (u8 b = 0; b < Cells::kCount; ++b) {
+                    distances[a][b] = static_cast<u8>(distance(Cell::fromRaw(a), Cell::fromRaw(b)));
+                }
+            }
+
+            return distances;
+        }();
+
+        constexpr auto kGoalDistances = [] {
+            std::array<CellTable<u8>, Colors::kCount> distances{};
+
+            for (u8 id = 0; id < Cells::kCount; ++id) {
+                const auto row = Cell::fromRaw(id).row();
+
+                // white plays towards row g, black towards row a
+                distances[Colors::kWhite.idx()][id] = static_cast<u8>(6 - row);
+                distances[Colors::kBlack.idx()][id] = static_cast<u8>(row);
+            }
+
+            return distances;
+        }();
+    } // namespace detail
+
+    [[nodiscard]] constexpr Cell neighbour(Cell cell, Direction dir) {
+        assert(cell != Cells::kNone);
+        return detail::kNeighbours[cell.idx()][static_cast<usize>(dir)];
+    }
+
+    [[nodiscard]] constexpr const std::array<Cell, kDirectionCount>& neighbours(Cell cell) {
+        assert(cell != Cells::kNone);
+        return detail::kNeighbours[cell.idx()];
+    }
+
+    [[nodiscard]] constexpr Bitboard neighbourBb(Cell cell) {
+        assert(cell != Cells::kNone);
+        return detail::kNeighbourBbs[cell.idx()];
+    }
+
+    // dest is Cells::kNone if the two-cell move would leave the board
+    [[nodiscard]] constexpr TwoStep twoStep(Cell cell, Direction dir) {
+        assert(cell != Cells::kNone);
+        return detail::kTwoSteps[cell.idx()][static_cast<usize>(dir)];
+    }
+
+    [[nodiscard]] constexpr const std::array<TwoStep, kDirectionCount>& twoSteps(Cell cell) {
+        assert(cell != Cells::kNone);
+        return detail::kTwoSteps[cell.idx()];
+    }
+
+    [[nodiscard]] constexpr Bitboard twoStepBb(Cell cell) {
+        assert(cell != Cells::kNone);
+        return detail::kTwoStepBbs[cell.idx()];
+    }
+
+    [[nodiscard]] constexpr u32 distance(Cell a, Cell b) {
+        assert(a != Cells::kNone);
+        assert(b != Cells::kNone);
+        return detail::kDistances[a.idx()][b.idx()];
+    }
+
+    // number of rows between a cell and the row a piece of the given colour wins on
+    [[nodiscard]] constexpr u32 goalDistance(Color color, Cell cell) {
+        assert(color != Colors::kNone);
+        assert(cell != Cells::kNone);
+        return detail::kGoalDistances[color.idx()][cell.idx()];
+    }
+
+    // the generated tables must agree with the hand-rolled shifts
+    static_assert([] {
+        for (u8 id = 0; id < Cells::kCount; ++id) {
+            const auto cell = Cell::fromRaw(id);
+            const auto bb = Bitboard::fromCell(cell);
+
+            const auto nbb = [&](Direction dir) { return Bitboard::fromCellOrZero(neighbour(cell, dir)); };
+
+            if (bb.shiftNorthWest() != nbb(Direction::kNorthWest) || bb.shiftNorthEast() != nbb(Direction::kNorthEast)
+                || bb.shiftWest() != nbb(Direction::kWest) || bb.shiftEast() != nbb(Direction::kEast)
+                || bb.shiftSouthWest() != nbb(Direction::kSouthWest)
+                || bb.shiftSouthEast() != nbb(Direction::kSouthEast))
+            {
+                return false;
+            }
+
+            if (cell.rotate() != Cell::fromRaw(static_cast<u8>(Cells::kCount - 1 - id))) {
+                return false;
+            }
+        }
+
+        return true;
+    }());
+
+    static_assert(distance(Cells::kA1, Cells::kG1) == 6);
+    static_assert(distance(Cells::kA1, Cells::kA6) == 5);
+    static_assert(distance(Cells::kB1, Cells::kB7) == 6);
+    static_assert(distance(Cells::kD1, Cells::kA4) == 5);
+    static_assert(twoStep(Cells::kB4, Direction::kNorthWest).mid == Cells::kC3);
+    static_assert(twoStep(Cells::kB4, Direction::kNorthWest).dest == Cells::kD3);
+} // namespace octachoron::geometry
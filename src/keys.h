@@ -0,0 +1,66 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "types.h"
+
+#include <array>
+
+#include "core.h"
+#include "util/rng.h"
+
+namespace octachoron::keys {
+    namespace sizes {
+        constexpr usize kPieceCells = Pieces::kCount * Cells::kCount;
+        constexpr usize kStm = 1;
+
+        constexpr usize kTotal = kPieceCells + kStm;
+    } // namespace sizes
+
+    namespace offsets {
+        constexpr usize kPieceCells = 0;
+        constexpr usize kStm = kPieceCells + sizes::kPieceCells;
+    } // namespace offsets
+
+    constexpr auto kKeys = [] {
+        constexpr auto kSeed = UINT64_C(0x0c7ac401204);
+
+        std::array<u64, sizes::kTotal> keys{};
+
+        util::rng::Jsf64Rng rng{kSeed};
+
+        for (auto& key : keys) {
+            key = rng.nextU64();
+        }
+
+        return keys;
+    }();
+
+    [[nodiscard]] constexpr u64 pieceCell(Piece piece, Cell cell) {
+        assert(piece != Pieces::kNone);
+        assert(cell != Cells::kNone);
+
+        return kKeys[offsets::kPieceCells + piece.idx() * Cells::kCount + cell.idx()];
+    }
+
+    // xored in when black is to move
+    [[nodiscard]] constexpr u64 stm() {
+        return kKeys[offsets::kStm];
+    }
+} // namespace octachoron::keys
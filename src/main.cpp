@@ -18,21 +18,1204 @@
 
 #include "types.h"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
 #include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
 
+#include "analyse.h"
+#include "book/book.h"
+#include "book/builder.h"
+#include "cluster.h"
+#include "datagen.h"
+#include "dedup.h"
+#include "dfpn.h"
+#include "dfpn_cache.h"
+#include "games/index.h"
+#include "games/reader.h"
+#include "games/record.h"
+#include "match.h"
+#include "mcts/search.h"
+#include "perft.h"
+#include "policy.h"
 #include "position.h"
+#include "serve.h"
+#include "spsa.h"
+#include "tb/generator.h"
+#include "tb/tablebase.h"
+#include "telemetry.h"
+#include "tunable.h"
+#include "tune.h"
+#include "util/parse.h"
 
 using namespace octachoron;
 
-i32 main() {
-    const auto startpos = Position::startpos();
-    std::cout << startpos << std::endl;
+namespace {
+    // reads "[fen <4 fields>]" from argv, starting at argv[idx]
+    bool parsePosition(Position& pos, i32 argc, const char* argv[], i32 idx) {
+        if (idx >= argc) {
+            pos = Position::startpos();
+            return true;
+        }
 
-    std::cout << std::endl;
+        if (std::string_view{argv[idx]} != "fen" || idx + 4 >= argc) {
+            return false;
+        }
 
-    const auto after = startpos.applyMove(Move::makeSingleUnstack(Cells::kB4, Cells::kC3));
-    std::cout << after << std::endl;
-    std::cout << Move::makeSingleUnstack(Cells::kB4, Cells::kC3) << std::endl;
+        std::string fen{};
 
-    return 0;
+        for (i32 i = idx + 1; i < argc; ++i) {
+            if (i > idx + 1) {
+                fen += ' ';
+            }
+
+            fen += argv[i];
+        }
+
+        return pos.resetFromFen(fen);
+    }
+
+    // "RWvs": roles of the white pieces, then of the black pieces
+    bool parsePieces(std::vector<Piece>& dst, std::string_view str) {
+        auto color = Colors::kWhite;
+
+        for (const auto c : str) {
+            if (c == 'v' && color == Colors::kWhite) {
+                color = Colors::kBlack;
+                continue;
+            }
+
+            const auto role = Role::fromChar(c);
+
+            if (role == Roles::kNone) {
+                return false;
+            }
+
+            dst.push_back(role.pieceType().withColor(color));
+        }
+
+        return color == Colors::kBlack;
+    }
+
+    void printUsage() {
+        std::cerr << "usage: octachoron perft <depth> [fen <fen>]\n"
+                     "       octachoron splitperft <depth> [fen <fen>]\n"
+                     "       octachoron tbgen <directory> <pieces, e.g. RWvs> [threads]\n"
+                     "       octachoron tbprobe <directory> [fen <fen>]\n"
+                     "       octachoron solve [nodes <n>] [movetime <ms>] [hash <mb>] [tb <directory>] [cache <file>]"
+                     " [fen <fen>]\n"
+                     "       octachoron mcts [playouts <n>] [movetime <ms>] [threads <n>] [tree <mb>] [book <file>]"
+                     " [cache <file>] [policy <file>] [telemetry <file|fd:n>] [<param> <value>]... [fen <fen>]\n"
+                     "       octachoron analyse-file <input> <output> [nodes <n>] [movetime <ms>] [threads <n>]"
+                     " [split <threads per position>] [tree <mb>] [telemetry <file|fd:n>]\n"
+                     "       octachoron serve <socket> [threads <n>] [tree <mb>] [movetime <ms>] [maxmovetime <ms>]"
+                     " [maxplayouts <n>] [queue <n>] [telemetry <file|fd:n>]\n"
+                     "       octachoron cluster <port> [workers <n>] [playouts <n>] [movetime <ms>] [fen <fen>]\n"
+                     "       octachoron cluster-worker <host> <port> [threads <n>] [tree <mb>]\n"
+                     "       octachoron datagen <output> [threads <n>] [positions <n>] [playouts <n>] [randomplies <n>]"
+                     " [book <file>] [seed <n>] [format packed|text]\n"
+                     "       octachoron dedup <output> [threads <n>] [hash <mb>] [bloom <mb>] files <file>...\n"
+                     "       octachoron tune [threads <n>] [epochs <n>] [lr <x>] [lambda <x>] files <file>...\n"
+                     "       octachoron tunables\n"
+                     "       octachoron spsa [iterations <n>] [pairs <n>] [threads <n>] [playouts <n>]"
+                     " [randomplies <n>] [seed <n>]\n"
+                     "       octachoron match [threads <n>] [pairs <n>] [openings <file>] [book <file>]"
+                     " [randomplies <n>] [maxplies <n>] [tb <directory>] [games <file>] [elo0 <x>] [elo1 <x>]"
+                     " [alpha <x>] [beta <x>] [seed <n>] engine <key=value,...> engine <key=value,...>\n"
+                     "       octachoron book build <output> [depth <n>] [playouts <n>] [minshare <x>] [threads <n>]"
+                     " [games <file>] [maxplies <n>]\n"
+                     "       octachoron book probe <file> [fen <fen>]\n"
+                     "       octachoron games convert <input> <output> [format text|binary]\n"
+                     "       octachoron games stats <file> [threads <n>]\n"
+                     "       octachoron games index <file> <output> [threads <n>] [plies <n>] [memory <mb>]\n"
+                     "       octachoron games explore <index> [fen <fen>]\n"
+                     "       octachoron policy train <games> <output> [threads <n>] [epochs <n>] [lr <x>]"
+                     " [positions <n>]"
+                  << std::endl;
+    }
+} // namespace
+
+i32 main(i32 argc, const char* argv[]) {
+    if (argc < 2) {
+        printUsage();
+        return 1;
+    }
+
+    const std::string_view mode{argv[1]};
+
+    if (mode == "perft" || mode == "splitperft") {
+        i32 depth{};
+
+        if (argc < 3 || !util::tryParse(depth, argv[2])) {
+            printUsage();
+            return 1;
+        }
+
+        Position pos{};
+
+        if (!parsePosition(pos, argc, argv, 3)) {
+            std::cerr << "invalid position" << std::endl;
+            return 1;
+        }
+
+        if (mode == "perft") {
+            std::cout << perft(pos, depth) << std::endl;
+        } else {
+            splitPerft(pos, depth);
+        }
+
+        return 0;
+    }
+
+    if (mode == "tbgen") {
+        std::vector<Piece> pieces{};
+        u32 threads = std::max(std::thread::hardware_concurrency(), 1U);
+
+        if (argc < 4 || argc > 5 || !parsePieces(pieces, argv[3]) || (argc == 5 && !util::tryParse(threads, argv[4]))) {
+            printUsage();
+            return 1;
+        }
+
+        return tb::generate(pieces, argv[2], threads) ? 0 : 1;
+    }
+
+    if (mode == "tbprobe") {
+        if (argc < 3) {
+            printUsage();
+            return 1;
+        }
+
+        Position pos{};
+
+        if (!parsePosition(pos, argc, argv, 3)) {
+            std::cerr << "invalid position" << std::endl;
+            return 1;
+        }
+
+        tb::Tablebases tablebases{};
+        tablebases.load(argv[2]);
+
+        const auto result = tablebases.probe(pos);
+
+        if (!result) {
+            std::cout << "not found" << std::endl;
+            return 1;
+        }
+
+        switch (result->wdl) {
+            case tb::Wdl::kWin:
+                std::cout << "win in " << result->plies << " plies" << std::endl;
+                break;
+            case tb::Wdl::kDraw:
+                std::cout << "draw" << std::endl;
+                break;
+            case tb::Wdl::kLoss:
+                std::cout << "loss in " << result->plies << " plies" << std::endl;
+                break;
+        }
+
+        return 0;
+    }
+
+    if (mode == "solve") {
+        dfpn::SolveLimits limits{};
+
+        usize hashMb = 64;
+        std::string tbDirectory{};
+        std::string cachePath{};
+
+        i32 idx = 2;
+
+        for (; idx + 1 < argc && std::string_view{argv[idx]} != "fen"; idx += 2) {
+            const std::string_view option{argv[idx]};
+            const std::string_view value{argv[idx + 1]};
+
+            bool valid = true;
+
+            if (option == "nodes") {
+                valid = util::tryParse(limits.maxNodes, value);
+            } else if (option == "movetime") {
+                i64 ms{};
+                valid = util::tryParse(ms, value);
+                limits.maxTime = std::chrono::milliseconds{ms};
+            } else if (option == "hash") {
+                valid = util::tryParse(hashMb, value);
+            } else if (option == "tb") {
+                tbDirectory = value;
+            } else if (option == "cache") {
+                cachePath = value;
+            } else {
+                valid = false;
+            }
+
+            if (!valid) {
+                printUsage();
+                return 1;
+            }
+        }
+
+        Position pos{};
+
+        if (!parsePosition(pos, argc, argv, idx)) {
+            std::cerr << "invalid position" << std::endl;
+            return 1;
+        }
+
+        tb::Tablebases tablebases{};
+        dfpn::Solver solver{hashMb};
+
+        if (!tbDirectory.empty()) {
+            std::cout << "loaded " << tablebases.load(tbDirectory) << " tablebases" << std::endl;
+            solver.setTablebases(&tablebases);
+        }
+
+        dfpn::AnalysisCache cache{};
+
+        if (!cachePath.empty()) {
+            if (!cache.open(cachePath)) {
+                std::cerr << "failed to open cache " << cachePath << std::endl;
+                return 1;
+            }
+
+            std::cout << "loaded " << cache.size() << " cached proofs" << std::endl;
+            solver.setCache(&cache);
+        }
+
+        const auto result = solver.solve(pos, limits);
+
+        if (cache.isOpen()) {
+            solver.exportProofs(pos, cache);
+
+            if (!cache.save()) {
+                std::cerr << "failed to save cache " << cachePath << std::endl;
+            }
+        }
+
+        switch (result.outcome) {
+            case dfpn::Outcome::kWin:
+                std::cout << "result win\n";
+                break;
+            case dfpn::Outcome::kNoWin:
+                std::cout << "result nowin\n";
+                break;
+            case dfpn::Outcome::kUnknown:
+                std::cout << "result unknown\n";
+                break;
+        }
+
+        std::cout << "bestmove " << result.bestMove << "\npv";
+
+        for (const auto move : result.pv) {
+            std::cout << ' ' << move;
+        }
+
+        const auto nps = result.timeSec > 0.0 ? static_cast<u64>(static_cast<f64>(result.nodes) / result.timeSec) : 0;
+
+        std::cout << "\nnodes " << result.nodes << " time " << static_cast<u64>(result.timeSec * 1000.0) << " nps "
+                  << nps << " hashfull " << result.hashfull << std::endl;
+
+        const std::array threadStats{&solver.threadStats()};
+        stats::printAggregate(std::cout, threadStats);
+
+        return 0;
+    }
+
+    if (mode == "mcts") {
+        mcts::SearchLimits limits{};
+
+        u32 threads = 1;
+        usize treeMb = 64;
+
+        mcts::Params params{};
+        std::string bookPath{};
+        std::string cachePath{};
+        std::string policyPath{};
+        std::string telemetryTarget{};
+
+        i32 idx = 2;
+
+        for (; idx + 1 < argc && std::string_view{argv[idx]} != "fen"; idx += 2) {
+            const std::string_view option{argv[idx]};
+            const std::string_view value{argv[idx + 1]};
+
+            bool valid = true;
+
+            if (option == "playouts") {
+                valid = util::tryParse(limits.maxPlayouts, value);
+            } else if (option == "movetime") {
+                i64 ms{};
+                valid = util::tryParse(ms, value);
+                limits.maxTime = std::chrono::milliseconds{ms};
+            } else if (option == "threads") {
+                valid = util::tryParse(threads, value);
+            } else if (option == "tree") {
+                valid = util::tryParse(treeMb, value);
+            } else if (option == "book") {
+                bookPath = value;
+            } else if (option == "cache") {
+                cachePath = value;
+            } else if (option == "policy") {
+                policyPath = value;
+            } else if (option == "telemetry") {
+                telemetryTarget = value;
+            } else {
+                // search parameters, in tuning builds
+                i32 paramValue{};
+                valid = util::tryParse(paramValue, value) && params.set(option, paramValue);
+            }
+
+            if (!valid) {
+                printUsage();
+                return 1;
+            }
+        }
+
+        if (limits.maxPlayouts == 0 && limits.maxTime.count() == 0) {
+            limits.maxTime = std::chrono::milliseconds{5000};
+        }
+
+        Position pos{};
+
+        if (!parsePosition(pos, argc, argv, idx)) {
+            std::cerr << "invalid position" << std::endl;
+            return 1;
+        }
+
+        if (!bookPath.empty()) {
+            book::Book book{};
+
+            if (!book.open(bookPath)) {
+                std::cerr << "failed to open book " << bookPath << std::endl;
+                return 1;
+            }
+
+            // the book's main line, saving the search entirely
+            if (const auto moves = book.probe(pos); !moves.empty() && moves.front().weight > 0) {
+                std::cout << "bestmove " << moves.front().move << std::endl;
+                return 0;
+            }
+        }
+
+        if (!cachePath.empty()) {
+            dfpn::AnalysisCache cache{};
+
+            if (!cache.open(cachePath)) {
+                std::cerr << "failed to open cache " << cachePath << std::endl;
+                return 1;
+            }
+
+            // a proven win needs no search
+            if (const auto cached = cache.probe(pos); cached && cached->proof == dfpn::Proof::kWin) {
+                std::cout << "bestmove " << cached->move << std::endl;
+                return 0;
+            }
+        }
+
+        policy::Network network{};
+
+        if (!policyPath.empty() && !network.load(policyPath)) {
+            return 1;
+        }
+
+        telemetry::JsonLinesWriter telemetry{};
+
+        if (!telemetryTarget.empty() && !telemetry.open(telemetryTarget)) {
+            std::cerr << "failed to open telemetry target " << telemetryTarget << std::endl;
+            return 1;
+        }
+
+        mcts::Searcher searcher{treeMb, threads};
+        searcher.params() = params;
+
+        if (!policyPath.empty()) {
+            searcher.setPolicy(&network);
+        }
+
+        if (telemetry.isOpen()) {
+            searcher.setTelemetry(&telemetry);
+        }
+
+        searcher.setInfoCallback(
+            [](const mcts::SearchInfo& info) {
+                const auto pps =
+                    info.timeSec > 0.0 ? static_cast<u64>(static_cast<f64>(info.playouts) / info.timeSec) : 0;
+
+                std::cout << "info playouts " << info.playouts << " time " << static_cast<u64>(info.timeSec * 1000.0)
+                          << " pps " << pps << " value " << info.value << " tree " << info.treeUsage << " pv";
+
+                for (const auto move : info.pv) {
+                    std::cout << ' ' << move;
+                }
+
+                std::cout << std::endl;
+            },
+            std::chrono::milliseconds{1000});
+
+        const auto info = searcher.search(pos, limits);
+
+        std::cout << "bestmove " << info.bestMove << std::endl;
+
+        stats::printAggregate(std::cout, searcher.threadStats());
+
+        return 0;
+    }
+
+    if (mode == "analyse-file") {
+        if (argc < 4 || argc % 2 != 0) {
+            printUsage();
+            return 1;
+        }
+
+        analyse::Config config{};
+        config.input = argv[2];
+        config.output = argv[3];
+        config.threads = std::max(std::thread::hardware_concurrency(), 1U);
+
+        for (i32 idx = 4; idx + 1 < argc; idx += 2) {
+            const std::string_view option{argv[idx]};
+            const std::string_view value{argv[idx + 1]};
+
+            bool valid = true;
+
+            if (option == "nodes") {
+                valid = util::tryParse(config.limits.maxPlayouts, value);
+            } else if (option == "movetime") {
+                i64 ms{};
+                valid = util::tryParse(ms, value);
+                config.limits.maxTime = std::chrono::milliseconds{ms};
+            } else if (option == "threads") {
+                valid = util::tryParse(config.threads, value) && config.threads > 0;
+            } else if (option == "split") {
+                valid = util::tryParse(config.threadsPerPosition, value) && config.threadsPerPosition > 0;
+            } else if (option == "tree") {
+                valid = util::tryParse(config.treeMb, value) && config.treeMb > 0;
+            } else if (option == "telemetry") {
+                config.telemetry = value;
+            } else {
+                valid = false;
+            }
+
+            if (!valid) {
+                printUsage();
+                return 1;
+            }
+        }
+
+        if (config.limits.maxPlayouts == 0 && config.limits.maxTime.count() == 0) {
+            printUsage();
+            return 1;
+        }
+
+        return analyse::run(config) ? 0 : 1;
+    }
+
+    if (mode == "serve") {
+        if (argc < 3 || argc % 2 != 1) {
+            printUsage();
+            return 1;
+        }
+
+        serve::Config config{};
+        config.socketPath = argv[2];
+        config.workers = std::max(std::thread::hardware_concurrency(), 1U);
+
+        for (i32 idx = 3; idx + 1 < argc; idx += 2) {
+            const std::string_view option{argv[idx]};
+            const std::string_view value{argv[idx + 1]};
+
+            bool valid = true;
+
+            if (option == "threads") {
+                valid = util::tryParse(config.workers, value) && config.workers > 0;
+            } else if (option == "tree") {
+                valid = util::tryParse(config.treeMb, value) && config.treeMb > 0;
+            } else if (option == "movetime" || option == "maxmovetime") {
+                i64 ms{};
+                valid = util::tryParse(ms, value) && ms > 0;
+                (option == "movetime" ? config.defaultMovetime : config.maxMovetime) = std::chrono::milliseconds{ms};
+            } else if (option == "maxplayouts") {
+                valid = util::tryParse(config.maxPlayouts, value);
+            } else if (option == "queue") {
+                valid = util::tryParse(config.maxQueued, value) && config.maxQueued > 0;
+            } else if (option == "telemetry") {
+                config.telemetry = value;
+            } else {
+                valid = false;
+            }
+
+            if (!valid) {
+                printUsage();
+                return 1;
+            }
+        }
+
+        return serve::run(config) ? 0 : 1;
+    }
+
+    if (mode == "cluster") {
+        cluster::CoordinatorConfig config{};
+
+        if (argc < 3 || !util::tryParse(config.port, argv[2])) {
+            printUsage();
+            return 1;
+        }
+
+        i32 idx = 3;
+
+        for (; idx + 1 < argc && std::string_view{argv[idx]} != "fen"; idx += 2) {
+            const std::string_view option{argv[idx]};
+            const std::string_view value{argv[idx + 1]};
+
+            bool valid = true;
+
+            if (option == "workers") {
+                valid = util::tryParse(config.workers, value) && config.workers > 0;
+            } else if (option == "playouts") {
+                valid = util::tryParse(config.limits.maxPlayouts, value);
+            } else if (option == "movetime") {
+                i64 ms{};
+                valid = util::tryParse(ms, value);
+                config.limits.maxTime = std::chrono::milliseconds{ms};
+            } else {
+                valid = false;
+            }
+
+            if (!valid) {
+                printUsage();
+                return 1;
+            }
+        }
+
+        if (config.limits.maxPlayouts == 0 && config.limits.maxTime.count() == 0) {
+            config.limits.maxTime = std::chrono::milliseconds{5000};
+        }
+
+        if (!parsePosition(config.pos, argc, argv, idx)) {
+            std::cerr << "invalid position" << std::endl;
+            return 1;
+        }
+
+        return cluster::runCoordinator(config) ? 0 : 1;
+    }
+
+    if (mode == "cluster-worker") {
+        if (argc < 4 || argc % 2 != 0) {
+            printUsage();
+            return 1;
+        }
+
+        cluster::WorkerConfig config{};
+        config.host = argv[2];
+        config.threads = std::max(std::thread::hardware_concurrency(), 1U);
+
+        if (!util::tryParse(config.port, argv[3])) {
+            printUsage();
+            return 1;
+        }
+
+        for (i32 idx = 4; idx + 1 < argc; idx += 2) {
+            const std::string_view option{argv[idx]};
+            const std::string_view value{argv[idx + 1]};
+
+            bool valid = true;
+
+            if (option == "threads") {
+                valid = util::tryParse(config.threads, value) && config.threads > 0;
+            } else if (option == "tree") {
+                valid = util::tryParse(config.treeMb, value) && config.treeMb > 0;
+            } else {
+                valid = false;
+            }
+
+            if (!valid) {
+                printUsage();
+                return 1;
+            }
+        }
+
+        return cluster::runWorker(config) ? 0 : 1;
+    }
+
+    if (mode == "datagen") {
+        if (argc < 3 || argc % 2 != 1) {
+            printUsage();
+            return 1;
+        }
+
+        datagen::Config config{};
+        config.output = argv[2];
+
+        for (i32 idx = 3; idx + 1 < argc; idx += 2) {
+            const std::string_view option{argv[idx]};
+            const std::string_view value{argv[idx + 1]};
+
+            bool valid = true;
+
+            if (option == "threads") {
+                valid = util::tryParse(config.threads, value) && config.threads > 0;
+            } else if (option == "positions") {
+                valid = util::tryParse(config.positions, value);
+            } else if (option == "playouts") {
+                valid = util::tryParse(config.playouts, value) && config.playouts > 0;
+            } else if (option == "randomplies") {
+                valid = util::tryParse(config.randomPlies, value);
+            } else if (option == "book") {
+                config.book = value;
+            } else if (option == "seed") {
+                valid = util::tryParse(config.seed, value);
+            } else if (option == "format") {
+                if (value == "packed") {
+                    config.format = datagen::Format::kPacked;
+                } else if (value == "text") {
+                    config.format = datagen::Format::kText;
+                } else {
+                    valid = false;
+                }
+            } else {
+                valid = false;
+            }
+
+            if (!valid) {
+                printUsage();
+                return 1;
+            }
+        }
+
+        return datagen::run(config) ? 0 : 1;
+    }
+
+    if (mode == "dedup") {
+        if (argc < 3) {
+            printUsage();
+            return 1;
+        }
+
+        dedup::Config config{};
+        config.output = argv[2];
+        config.threads = std::max(std::thread::hardware_concurrency(), 1U);
+
+        i32 idx = 3;
+
+        for (; idx + 1 < argc && std::string_view{argv[idx]} != "files"; idx += 2) {
+            const std::string_view option{argv[idx]};
+            const std::string_view value{argv[idx + 1]};
+
+            bool valid = true;
+
+            if (option == "threads") {
+                valid = util::tryParse(config.threads, value) && config.threads > 0;
+            } else if (option == "hash") {
+                valid = util::tryParse(config.hashMb, value) && config.hashMb > 0;
+            } else if (option == "bloom") {
+                valid = util::tryParse(config.bloomMb, value);
+            } else {
+                valid = false;
+            }
+
+            if (!valid) {
+                printUsage();
+                return 1;
+            }
+        }
+
+        if (idx + 1 >= argc || std::string_view{argv[idx]} != "files") {
+            printUsage();
+            return 1;
+        }
+
+        config.inputs.assign(argv + idx + 1, argv + argc);
+
+        return dedup::run(config) ? 0 : 1;
+    }
+
+    if (mode == "tune") {
+        tune::Config config{};
+        config.threads = std::max(std::thread::hardware_concurrency(), 1U);
+
+        i32 idx = 2;
+
+        for (; idx + 1 < argc && std::string_view{argv[idx]} != "files"; idx += 2) {
+            const std::string_view option{argv[idx]};
+            const std::string_view value{argv[idx + 1]};
+
+            bool valid = true;
+
+            if (option == "threads") {
+                valid = util::tryParse(config.threads, value) && config.threads > 0;
+            } else if (option == "epochs") {
+                valid = util::tryParse(config.epochs, value);
+            } else if (option == "lr") {
+                valid = util::tryParse(config.learningRate, value) && config.learningRate > 0.0;
+            } else if (option == "lambda") {
+                valid = util::tryParse(config.lambda, value) && config.lambda >= 0.0 && config.lambda <= 1.0;
+            } else {
+                valid = false;
+            }
+
+            if (!valid) {
+                printUsage();
+                return 1;
+            }
+        }
+
+        if (idx + 1 >= argc || std::string_view{argv[idx]} != "files") {
+            printUsage();
+            return 1;
+        }
+
+        config.inputs.assign(argv + idx + 1, argv + argc);
+
+        return tune::run(config) ? 0 : 1;
+    }
+
+    if (mode == "tunables") {
+        // name, type, default, min, max, step, learning rate: the usual spsa config format
+        for (const auto& param : tunable::kParams) {
+            std::cout << param.name << ", int, " << param.defaultValue << ", " << param.min << ", " << param.max << ", "
+                      << param.step << ", 0.002\n";
+        }
+
+        std::cout.flush();
+
+        return 0;
+    }
+
+    if (mode == "spsa") {
+        if (argc % 2 != 0) {
+            printUsage();
+            return 1;
+        }
+
+        spsa::Config config{};
+        config.threads = std::max(std::thread::hardware_concurrency(), 1U);
+        config.pairs = config.threads;
+
+        for (i32 idx = 2; idx + 1 < argc; idx += 2) {
+            const std::string_view option{argv[idx]};
+            const std::string_view value{argv[idx + 1]};
+
+            bool valid = true;
+
+            if (option == "iterations") {
+                valid = util::tryParse(config.iterations, value) && config.iterations > 0;
+            } else if (option == "pairs") {
+                valid = util::tryParse(config.pairs, value) && config.pairs > 0;
+            } else if (option == "threads") {
+                valid = util::tryParse(config.threads, value) && config.threads > 0;
+            } else if (option == "playouts") {
+                valid = util::tryParse(config.playouts, value) && config.playouts > 0;
+            } else if (option == "randomplies") {
+                valid = util::tryParse(config.randomPlies, value);
+            } else if (option == "seed") {
+                valid = util::tryParse(config.seed, value);
+            } else {
+                valid = false;
+            }
+
+            if (!valid) {
+                printUsage();
+                return 1;
+            }
+        }
+
+        return spsa::run(config) ? 0 : 1;
+    }
+
+    if (mode == "match") {
+        if (argc % 2 != 0) {
+            printUsage();
+            return 1;
+        }
+
+        match::Config config{};
+        config.threads = std::max(std::thread::hardware_concurrency(), 1U);
+
+        usize engines = 0;
+
+        for (i32 idx = 2; idx + 1 < argc; idx += 2) {
+            const std::string_view option{argv[idx]};
+            const std::string_view value{argv[idx + 1]};
+
+            bool valid = true;
+
+            if (option == "threads") {
+                valid = util::tryParse(config.threads, value) && config.threads > 0;
+            } else if (option == "pairs") {
+                valid = util::tryParse(config.maxPairs, value) && config.maxPairs > 0;
+            } else if (option == "openings") {
+                config.openings = value;
+            } else if (option == "book") {
+                config.book = value;
+            } else if (option == "randomplies") {
+                valid = util::tryParse(config.randomPlies, value);
+            } else if (option == "maxplies") {
+                valid = util::tryParse(config.maxPlies, value) && config.maxPlies > 0;
+            } else if (option == "tb") {
+                config.tbDirectory = value;
+            } else if (option == "games") {
+                config.games = value;
+            } else if (option == "elo0") {
+                valid = util::tryParse(config.elo0, value);
+            } else if (option == "elo1") {
+                valid = util::tryParse(config.elo1, value);
+            } else if (option == "alpha") {
+                valid = util::tryParse(config.alpha, value) && config.alpha > 0.0 && config.alpha < 1.0;
+            } else if (option == "beta") {
+                valid = util::tryParse(config.beta, value) && config.beta > 0.0 && config.beta < 1.0;
+            } else if (option == "seed") {
+                valid = util::tryParse(config.seed, value);
+            } else if (option == "engine") {
+                valid = engines < config.engines.size() && match::parseEngine(config.engines[engines++], value);
+            } else {
+                valid = false;
+            }
+
+            if (!valid) {
+                printUsage();
+                return 1;
+            }
+        }
+
+        if (engines != config.engines.size() || config.elo1 <= config.elo0) {
+            printUsage();
+            return 1;
+        }
+
+        return match::run(config) ? 0 : 1;
+    }
+
+    if (mode == "book") {
+        const std::string_view command{argc >= 4 ? argv[2] : ""};
+
+        if (command == "build") {
+            if (argc % 2 != 0) {
+                printUsage();
+                return 1;
+            }
+
+            u32 depth = 8;
+            u64 playouts = 20000;
+            f64 minShare = 0.1;
+            u32 threads = std::max(std::thread::hardware_concurrency(), 1U);
+
+            std::string gamesFile{};
+            u32 maxPlies = 16;
+
+            for (i32 idx = 4; idx + 1 < argc; idx += 2) {
+                const std::string_view option{argv[idx]};
+                const std::string_view value{argv[idx + 1]};
+
+                bool valid = true;
+
+                if (option == "depth") {
+                    valid = util::tryParse(depth, value);
+                } else if (option == "playouts") {
+                    valid = util::tryParse(playouts, value) && playouts > 0;
+                } else if (option == "minshare") {
+                    valid = util::tryParse(minShare, value) && minShare > 0.0 && minShare <= 1.0;
+                } else if (option == "threads") {
+                    valid = util::tryParse(threads, value) && threads > 0;
+                } else if (option == "games") {
+                    gamesFile = value;
+                } else if (option == "maxplies") {
+                    valid = util::tryParse(maxPlies, value) && maxPlies > 0;
+                } else {
+                    valid = false;
+                }
+
+                if (!valid) {
+                    printUsage();
+                    return 1;
+                }
+            }
+
+            book::Builder builder{};
+
+            if (gamesFile.empty()) {
+                builder.addSearch(Position::startpos(), depth, playouts, minShare, threads);
+            } else {
+                games::GameReader reader{};
+
+                if (!reader.open(gamesFile)) {
+                    std::cerr << "failed to open " << gamesFile << std::endl;
+                    return 1;
+                }
+
+                const auto stats = reader.read(threads, [&](const games::GameView& game) {
+                    builder.addGame(game.start(), game.moves, game.result, maxPlies);
+                    return true;
+                });
+
+                std::cout << "added " << stats.games << " games, skipped " << stats.errors << std::endl;
+            }
+
+            if (!builder.write(argv[3])) {
+                std::cerr << "failed to write " << argv[3] << std::endl;
+                return 1;
+            }
+
+            return 0;
+        }
+
+        if (command == "probe") {
+            Position pos{};
+
+            if (!parsePosition(pos, argc, argv, 4)) {
+                std::cerr << "invalid position" << std::endl;
+                return 1;
+            }
+
+            book::Book book{};
+
+            if (!book.open(argv[3])) {
+                std::cerr << "failed to open book " << argv[3] << std::endl;
+                return 1;
+            }
+
+            const auto moves = book.probe(pos);
+
+            if (moves.empty()) {
+                std::cout << "not found" << std::endl;
+                return 1;
+            }
+
+            for (const auto& move : moves) {
+                std::cout << move.move << " weight " << move.weight << " learn " << move.learn << '\n';
+            }
+
+            std::cout.flush();
+
+            return 0;
+        }
+
+        printUsage();
+        return 1;
+    }
+
+    if (mode == "games") {
+        const std::string_view command{argc >= 4 ? argv[2] : ""};
+
+        if (command == "convert") {
+            if (argc < 5 || argc % 2 != 1) {
+                printUsage();
+                return 1;
+            }
+
+            games::GameReader reader{};
+
+            if (!reader.open(argv[3])) {
+                std::cerr << "failed to open " << argv[3] << std::endl;
+                return 1;
+            }
+
+            // to the other format unless told otherwise
+            auto format = reader.format() == games::Format::kText ? games::Format::kBinary : games::Format::kText;
+
+            for (i32 idx = 5; idx + 1 < argc; idx += 2) {
+                const std::string_view option{argv[idx]};
+                const std::string_view value{argv[idx + 1]};
+
+                if (option == "format" && value == "text") {
+                    format = games::Format::kText;
+                } else if (option == "format" && value == "binary") {
+                    format = games::Format::kBinary;
+                } else {
+                    printUsage();
+                    return 1;
+                }
+            }
+
+            games::GameWriter writer{};
+
+            if (!writer.open(argv[4], format)) {
+                std::cerr << "failed to open " << argv[4] << std::endl;
+                return 1;
+            }
+
+            bool success = true;
+
+            const auto stats = reader.read({0, reader.size()}, [&](const games::GameView& game) {
+                success &= writer.write(game.tags, game.start(), game.moves, game.result);
+                return success;
+            });
+
+            success &= writer.close();
+
+            if (!success) {
+                std::cerr << "failed to write " << argv[4] << std::endl;
+                return 1;
+            }
+
+            std::cout << "converted " << stats.games << " games, skipped " << stats.errors << std::endl;
+
+            return 0;
+        }
+
+        if (command == "stats") {
+            if (argc % 2 != 0) {
+                printUsage();
+                return 1;
+            }
+
+            u32 threads = std::max(std::thread::hardware_concurrency(), 1U);
+
+            for (i32 idx = 4; idx + 1 < argc; idx += 2) {
+                const std::string_view option{argv[idx]};
+                const std::string_view value{argv[idx + 1]};
+
+                if (option != "threads" || !util::tryParse(threads, value) || threads == 0) {
+                    printUsage();
+                    return 1;
+                }
+            }
+
+            games::GameReader reader{};
+
+            if (!reader.open(argv[3])) {
+                std::cerr << "failed to open " << argv[3] << std::endl;
+                return 1;
+            }
+
+            // indexed by outcome
+            std::array<std::atomic<u64>, 3> results{};
+
+            const auto start = std::chrono::steady_clock::now();
+
+            const auto stats = reader.read(threads, [&](const games::GameView& game) {
+                results[static_cast<usize>(game.result)].fetch_add(1, std::memory_order::relaxed);
+                return true;
+            });
+
+            const auto time = std::chrono::duration<f64>(std::chrono::steady_clock::now() - start).count();
+
+            std::cout << stats.games << " games, " << stats.moves << " moves, " << stats.errors << " skipped\n"
+                      << "white wins " << results[2].load() << ", draws " << results[1].load() << ", black wins "
+                      << results[0].load() << '\n'
+                      << static_cast<u64>(static_cast<f64>(stats.games) / std::max(time, 1e-9)) << " games/s"
+                      << std::endl;
+
+            return 0;
+        }
+
+        if (command == "index") {
+            if (argc < 5 || argc % 2 != 1) {
+                printUsage();
+                return 1;
+            }
+
+            games::IndexConfig config{};
+            config.games = argv[3];
+            config.output = argv[4];
+            config.threads = std::max(std::thread::hardware_concurrency(), 1U);
+
+            for (i32 idx = 5; idx + 1 < argc; idx += 2) {
+                const std::string_view option{argv[idx]};
+                const std::string_view value{argv[idx + 1]};
+
+                bool valid = true;
+
+                if (option == "threads") {
+                    valid = util::tryParse(config.threads, value) && config.threads > 0;
+                } else if (option == "plies") {
+                    valid = util::tryParse(config.maxPlies, value) && config.maxPlies > 0;
+                } else if (option == "memory") {
+                    valid = util::tryParse(config.memoryMb, value) && config.memoryMb > 0;
+                } else {
+                    valid = false;
+                }
+
+                if (!valid) {
+                    printUsage();
+                    return 1;
+                }
+            }
+
+            return games::buildIndex(config) ? 0 : 1;
+        }
+
+        if (command == "explore") {
+            Position pos{};
+
+            if (!parsePosition(pos, argc, argv, 4)) {
+                std::cerr << "invalid position" << std::endl;
+                return 1;
+            }
+
+            games::Index index{};
+
+            if (!index.open(argv[3])) {
+                std::cerr << "failed to open index " << argv[3] << std::endl;
+                return 1;
+            }
+
+            const auto start = std::chrono::steady_clock::now();
+            const auto moves = index.probe(pos);
+            const auto time = std::chrono::duration<f64, std::micro>(std::chrono::steady_clock::now() - start);
+
+            for (const auto& move : moves) {
+                const auto games = static_cast<f64>(move.games);
+
+                const auto white = static_cast<f64>(move.results[static_cast<usize>(data::Outcome::kWhiteWin)]);
+                const auto draws = static_cast<f64>(move.results[static_cast<usize>(data::Outcome::kDraw)]);
+
+                std::cout << move.move << " games " << move.games << " white " << std::fixed << std::setprecision(1)
+                          << white / games * 100.0 << "% draw " << draws / games * 100.0 << "%" << std::defaultfloat
+                          << " game " << move.sampleOffset << '\n';
+            }
+
+            std::cout << moves.size() << " moves in " << std::fixed << std::setprecision(1) << time.count() << " us"
+                      << std::defaultfloat << std::endl;
+
+            return moves.empty() ? 1 : 0;
+        }
+
+        printUsage();
+        return 1;
+    }
+
+    if (mode == "policy") {
+        if (argc < 5 || std::string_view{argv[2]} != "train" || argc % 2 != 1) {
+            printUsage();
+            return 1;
+        }
+
+        policy::TrainConfig config{};
+        config.games = argv[3];
+        config.output = argv[4];
+
+        for (i32 idx = 5; idx + 1 < argc; idx += 2) {
+            const std::string_view option{argv[idx]};
+            const std::string_view value{argv[idx + 1]};
+
+            bool valid = true;
+
+            if (option == "threads") {
+                valid = util::tryParse(config.threads, value) && config.threads > 0;
+            } else if (option == "epochs") {
+                valid = util::tryParse(config.epochs, value) && config.epochs > 0;
+            } else if (option == "lr") {
+                valid = util::tryParse(config.learningRate, value) && config.learningRate > 0.0;
+            } else if (option == "positions") {
+                valid = util::tryParse(config.maxPositions, value) && config.maxPositions > 0;
+            } else {
+                valid = false;
+            }
+
+            if (!valid) {
+                printUsage();
+                return 1;
+            }
+        }
+
+        return policy::train(config) ? 0 : 1;
+    }
+
+    printUsage();
+    return 1;
 }
@@ -0,0 +1,348 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "match.h"
+
+#include <array>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "book/book.h"
+#include "games/record.h"
+#include "policy.h"
+#include "position.h"
+#include "selfplay.h"
+#include "sprt.h"
+#include "tb/tablebase.h"
+#include "util/parse.h"
+#include "util/rng.h"
+#include "util/split.h"
+
+namespace octachoron::match {
+    namespace {
+        constexpr u64 kReportInterval = 10;
+
+        bool readOpenings(std::vector<Position>& dst, const std::string& path) {
+            std::ifstream stream{path};
+
+            if (!stream) {
+                std::cerr << "failed to open " << path << std::endl;
+                return false;
+            }
+
+            std::string line{};
+
+            while (std::getline(stream, line)) {
+                if (line.empty() || line[0] == '#') {
+                    continue;
+                }
+
+                Position pos{};
+
+                if (!pos.resetFromFen(line)) {
+                    std::cerr << "invalid opening " << line << std::endl;
+                    return false;
+                }
+
+                dst.push_back(pos);
+            }
+
+            if (dst.empty()) {
+                std::cerr << "no openings in " << path << std::endl;
+                return false;
+            }
+
+            return true;
+        }
+
+        // one searcher per engine, reused across games
+        struct Worker {
+            explicit Worker(const Config& config) :
+                    searchers{std::make_unique<mcts::Searcher>(config.engines[0].treeMb, 1),
+                        std::make_unique<mcts::Searcher>(config.engines[1].treeMb, 1)} {
+                for (usize i = 0; i < searchers.size(); ++i) {
+                    searchers[i]->params() = config.engines[i].params;
+                }
+            }
+
+            std::array<std::unique_ptr<mcts::Searcher>, 2> searchers;
+        };
+
+        struct Results {
+            sprt::Pentanomial pentanomial{};
+
+            // first engine's point of view
+            u64 wins{};
+            u64 draws{};
+            u64 losses{};
+
+            void addGame(u32 halfPoints) {
+                wins += halfPoints == 2;
+                draws += halfPoints == 1;
+                losses += halfPoints == 0;
+            }
+        };
+
+        void printResults(const Results& results, const Config& config) {
+            const auto& pentanomial = results.pentanomial;
+
+            std::cout << "pairs " << pentanomial.pairs() << " wdl " << results.wins << "-" << results.draws << "-"
+                      << results.losses << " penta [";
+
+            for (u32 i = 0; i < sprt::Pentanomial::kOutcomeCount; ++i) {
+                std::cout << (i > 0 ? ", " : "") << pentanomial.count(i);
+            }
+
+            const auto bounds = sprt::bounds(config.alpha, config.beta);
+
+            std::cout << "] elo " << std::fixed << std::setprecision(1) << pentanomial.elo() << " +- "
+                      << pentanomial.eloError() << " llr " << std::setprecision(2)
+                      << pentanomial.llr(config.elo0, config.elo1) << " (" << bounds.lower << ", " << bounds.upper
+                      << ")" << std::defaultfloat << std::endl;
+        }
+    } // namespace
+
+    bool parseEngine(EngineConfig& dst, std::string_view spec) {
+        dst.spec = spec;
+
+        for (const auto& entry : util::split(spec, ',')) {
+            const auto separator = entry.find('=');
+
+            if (separator == std::string::npos) {
+                return false;
+            }
+
+            const std::string_view key{entry.data(), separator};
+            const std::string_view value{entry.data() + separator + 1, entry.size() - separator - 1};
+
+            bool valid = true;
+
+            if (key == "playouts") {
+                valid = util::tryParse(dst.limits.maxPlayouts, value);
+            } else if (key == "movetime") {
+                i64 ms{};
+                valid = util::tryParse(ms, value);
+                dst.limits.maxTime = std::chrono::milliseconds{ms};
+            } else if (key == "tree") {
+                valid = util::tryParse(dst.treeMb, value) && dst.treeMb > 0;
+            } else if (key == "policy") {
+                dst.policy = value;
+                valid = !value.empty();
+            } else {
+                i32 paramValue{};
+                valid = util::tryParse(paramValue, value) && dst.params.set(key, paramValue);
+            }
+
+            if (!valid) {
+                return false;
+            }
+        }
+
+        return dst.limits.maxPlayouts > 0 || dst.limits.maxTime.count() > 0;
+    }
+
+    bool run(const Config& config) {
+        std::vector<Position> openings{};
+
+        if (!config.openings.empty() && !readOpenings(openings, config.openings)) {
+            return false;
+        }
+
+        book::Book book{};
+
+        if (!config.book.empty() && !book.open(config.book)) {
+            std::cerr << "failed to open book " << config.book << std::endl;
+            return false;
+        }
+
+        const auto* openingBook = book.isOpen() ? &book : nullptr;
+
+        tb::Tablebases tablebases{};
+
+        if (!config.tbDirectory.empty()) {
+            std::cout << "loaded " << tablebases.load(config.tbDirectory) << " tablebases" << std::endl;
+        }
+
+        const auto* adjudication = tablebases.tableCount() > 0 ? &tablebases : nullptr;
+
+        games::GameWriter gameWriter{};
+
+        if (!config.games.empty() && !gameWriter.open(config.games, games::Format::kText)) {
+            std::cerr << "failed to open " << config.games << std::endl;
+            return false;
+        }
+
+        const auto bounds = sprt::bounds(config.alpha, config.beta);
+
+        // Each opening is played once. Playout-limited engines are deterministic, so a repeated
+        // opening would replay an identical pair, and the test would count it as a new sample.
+        auto maxPairs = config.maxPairs;
+
+        if (!openings.empty() && openings.size() < maxPairs) {
+            maxPairs = openings.size();
+            std::cout << "stopping after " << maxPairs << " pairs, one per opening" << std::endl;
+        }
+
+        // read-only once loaded, so shared by every worker
+        std::array<std::unique_ptr<policy::Network>, 2> networks{};
+
+        for (usize i = 0; i < networks.size(); ++i) {
+            if (config.engines[i].policy.empty()) {
+                continue;
+            }
+
+            networks[i] = std::make_unique<policy::Network>();
+
+            if (!networks[i]->load(config.engines[i].policy)) {
+                return false;
+            }
+        }
+
+        std::vector<std::unique_ptr<Worker>> workers{};
+
+        for (u32 i = 0; i < config.threads; ++i) {
+            auto& worker = workers.emplace_back(std::make_unique<Worker>(config));
+
+            for (usize engine = 0; engine < networks.size(); ++engine) {
+                worker->searchers[engine]->setPolicy(networks[engine].get());
+            }
+        }
+
+        std::atomic<u64> nextPair{0};
+        std::atomic_bool finished{false};
+
+        std::mutex resultsMutex{};
+        Results results{};
+
+        const auto playPair = [&](Worker& worker, u64 pairIdx) {
+            Position opening{};
+
+            if (openings.empty()) {
+                // seeded by the pair, so a rerun plays the same openings
+                util::rng::Jsf64Rng rng{config.seed + pairIdx * UINT64_C(0x9e3779b97f4a7c15)};
+                opening = selfplay::randomOpening(rng, config.randomPlies, openingBook);
+            } else {
+                opening = openings[pairIdx];
+            }
+
+            const selfplay::Player first{worker.searchers[0].get(), config.engines[0].limits};
+            const selfplay::Player second{worker.searchers[1].get(), config.engines[1].limits};
+
+            std::vector<Move> firstMoves{};
+            std::vector<Move> secondMoves{};
+
+            auto* recordFirst = gameWriter.isOpen() ? &firstMoves : nullptr;
+            auto* recordSecond = gameWriter.isOpen() ? &secondMoves : nullptr;
+
+            const auto firstOutcome =
+                selfplay::playGame(opening, {first, second}, config.maxPlies, adjudication, recordFirst);
+            const auto secondOutcome =
+                selfplay::playGame(opening, {second, first}, config.maxPlies, adjudication, recordSecond);
+
+            // outcomes count half points for white
+            const auto firstAsWhite = static_cast<u32>(firstOutcome);
+            const auto firstAsBlack = 2 - static_cast<u32>(secondOutcome);
+
+            const std::scoped_lock lock{resultsMutex};
+
+            // pairs still in flight when the test ends do not count
+            if (finished.load(std::memory_order::relaxed)) {
+                return;
+            }
+
+            if (gameWriter.isOpen()) {
+                const auto round = std::to_string(pairIdx + 1);
+
+                const std::array<games::Tag, 3> firstTags = {{
+                    {"Round", round},
+                    {"White", config.engines[0].spec},
+                    {"Black", config.engines[1].spec},
+                }};
+                const std::array<games::Tag, 3> secondTags = {{
+                    {"Round", round},
+                    {"White", config.engines[1].spec},
+                    {"Black", config.engines[0].spec},
+                }};
+
+                if (!gameWriter.write(firstTags, opening, firstMoves, firstOutcome)
+                    || !gameWriter.write(secondTags, opening, secondMoves, secondOutcome))
+                {
+                    std::cerr << "failed to write games to " << config.games << std::endl;
+                }
+            }
+
+            results.pentanomial.add(firstAsWhite + firstAsBlack);
+            results.addGame(firstAsWhite);
+            results.addGame(firstAsBlack);
+
+            const auto pairs = results.pentanomial.pairs();
+            const auto llr = results.pentanomial.llr(config.elo0, config.elo1);
+
+            if (llr <= bounds.lower || llr >= bounds.upper || pairs >= maxPairs) {
+                finished.store(true, std::memory_order::relaxed);
+            }
+
+            if (pairs % kReportInterval == 0 || finished.load(std::memory_order::relaxed)) {
+                printResults(results, config);
+            }
+        };
+
+        std::vector<std::thread> threads{};
+
+        for (auto& worker : workers) {
+            threads.emplace_back([&, worker = worker.get()] {
+                while (!finished.load(std::memory_order::relaxed)) {
+                    const auto pairIdx = nextPair.fetch_add(1, std::memory_order::relaxed);
+
+                    if (pairIdx >= maxPairs) {
+                        break;
+                    }
+
+                    playPair(*worker, pairIdx);
+                }
+            });
+        }
+
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        if (!gameWriter.close()) {
+            std::cerr << "failed to write games to " << config.games << std::endl;
+        }
+
+        const auto llr = results.pentanomial.llr(config.elo0, config.elo1);
+
+        if (llr >= bounds.upper) {
+            std::cout << "H1 accepted" << std::endl;
+        } else if (llr <= bounds.lower) {
+            std::cout << "H0 accepted" << std::endl;
+        } else {
+            std::cout << "inconclusive" << std::endl;
+        }
+
+        return true;
+    }
+} // namespace octachoron::match
@@ -0,0 +1,81 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "types.h"
+
+#include <array>
+#include <string>
+#include <string_view>
+
+#include "mcts/search.h"
+
+namespace octachoron::match {
+    struct EngineConfig {
+        // as given to parseEngine, to name the engine in game records
+        std::string spec{};
+
+        mcts::SearchLimits limits{};
+        usize treeMb{16};
+        mcts::Params params{};
+
+        // policy network file, for priors. eval-based priors if empty
+        std::string policy{};
+    };
+
+    // comma separated key=value pairs: playouts, movetime (ms), tree (mb), policy (file), and
+    // in tuning builds any search parameter, e.g. "playouts=800,cpuct=170"
+    [[nodiscard]] bool parseEngine(EngineConfig& dst, std::string_view spec);
+
+    struct Config {
+        std::array<EngineConfig, 2> engines{};
+
+        // games in flight at once
+        u32 threads{1};
+        u64 maxPairs{1000};
+
+        // one fen per line, each played once in order, so at most one pair per line. random openings if empty
+        std::string openings{};
+        // random openings start with moves drawn from this book, if given
+        std::string book{};
+        u32 randomPlies{8};
+
+        u32 maxPlies{400};
+        // positions these cover are adjudicated. none if empty
+        std::string tbDirectory{};
+
+        // every counted game is appended here as a text game record, if given
+        std::string games{};
+
+        // the test is of elo1 against elo0, for the first engine against the second
+        f64 elo0{0.0};
+        f64 elo1{5.0};
+        f64 alpha{0.05};
+        f64 beta{0.05};
+
+        u64 seed{};
+    };
+
+    // Plays game pairs between two engine configurations in this process, each pair sharing an
+    // opening with colours swapped, with one game per thread. A pentanomial SPRT is updated after
+    // every pair, and the match stops as soon as either bound is crossed or maxPairs is reached.
+    // Games end when a unit reaches its goal row or a side has no moves; with tablebases they
+    // are adjudicated as soon as the material is covered.
+    bool run(const Config& config);
+} // namespace octachoron::match
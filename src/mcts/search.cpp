@@ -0,0 +1,493 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "search.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <thread>
+
+#include "../eval.h"
+#include "../movegen.h"
+#include "../util/rng.h"
+#include "../util/static_vector.h"
+
+namespace octachoron::mcts {
+    namespace {
+        constexpr u64 kInfoCheckInterval = 256;
+
+        // share of each root prior replaced by noise, as in AlphaZero's root exploration
+        constexpr f64 kRootNoiseWeight = 0.25;
+    } // namespace
+
+    Searcher::Searcher(usize treeMb, u32 threads) :
+            m_threads{std::max<u32>(threads, 1)} {
+        m_tree.resize(treeMb);
+        m_stats.resize(m_threads);
+    }
+
+    void Searcher::setThreads(u32 threads) {
+        m_threads = std::max<u32>(threads, 1);
+        m_stats.resize(m_threads);
+    }
+
+    void Searcher::resize(usize treeMb) {
+        m_tree.resize(treeMb);
+    }
+
+    void Searcher::newGame() {
+        m_tree.clear();
+    }
+
+    void Searcher::setInfoCallback(InfoCallback callback, std::chrono::milliseconds interval) {
+        m_infoCallback = std::move(callback);
+        m_infoInterval = interval;
+    }
+
+    SearchInfo Searcher::search(const Position& pos, const SearchLimits& limits) {
+        m_limits = limits;
+        m_start = std::chrono::steady_clock::now();
+
+        m_stop.store(false, std::memory_order::relaxed);
+        m_playouts.store(0, std::memory_order::relaxed);
+        m_seldepth.store(0, std::memory_order::relaxed);
+
+        m_iterations.clear();
+
+        for (auto& threadStats : m_stats) {
+            threadStats.reset();
+        }
+
+        m_tree.setRoot(pos);
+
+        const auto reusedVisits = m_tree[m_tree.rootIndex()].visits.load(std::memory_order::relaxed);
+
+        // nothing to search if the game is already over
+        if (pos.winner() != Colors::kNone || countMoves(pos) == 0) {
+            auto info = report(reusedVisits);
+            finish(info);
+            return info;
+        }
+
+        // a root kept from the last search was expanded without this search's noise
+        if (const auto& root = m_tree[m_tree.rootIndex()];
+            m_limits.noiseSeed != 0 && root.state.load(std::memory_order::acquire) == NodeState::kExpanded) {
+            addRootNoise(root);
+        }
+
+        std::vector<std::thread> threads{};
+
+        for (u32 i = 1; i < m_threads; ++i) {
+            threads.emplace_back([this, i] { runThread(i); });
+        }
+
+        runThread(0);
+
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        auto info = report(reusedVisits);
+        finish(info);
+        return info;
+    }
+
+    void Searcher::finish(const SearchInfo& info) {
+        if (m_infoCallback) {
+            m_infoCallback(info);
+        }
+
+        if (m_telemetry) {
+            m_telemetry->submit(telemetry::SearchReport{
+                .depth = static_cast<u32>(info.pv.size()),
+                .seldepth = m_seldepth.load(std::memory_order::relaxed),
+                .nodes = info.playouts,
+                .timeMs = info.timeSec * 1000.0,
+                .hashfull = info.treeUsage,
+                .ebf = info.branching,
+                .iterations = std::move(m_iterations),
+            });
+
+            m_iterations.clear();
+        }
+    }
+
+    std::vector<const stats::ThreadStats*> Searcher::threadStats() const {
+        std::vector<const stats::ThreadStats*> result{};
+
+        for (const auto& threadStats : m_stats) {
+            result.push_back(&threadStats);
+        }
+
+        return result;
+    }
+
+    void Searcher::runThread(u32 threadIdx) {
+        auto& threadStats = m_stats[threadIdx];
+        auto lastInfo = std::chrono::steady_clock::now();
+
+        while (!m_stop.load(std::memory_order::relaxed)) {
+            playout(threadStats);
+
+            const auto playouts = m_playouts.fetch_add(1, std::memory_order::relaxed) + 1;
+
+            if (limitsReached()) {
+                stop();
+            }
+
+            if (threadIdx == 0 && (m_infoCallback || m_telemetry) && playouts % kInfoCheckInterval == 0) {
+                const auto now = std::chrono::steady_clock::now();
+
+                if (now - lastInfo >= m_infoInterval) {
+                    const auto info = report(0);
+
+                    if (m_infoCallback) {
+                        m_infoCallback(info);
+                    }
+
+                    // the telemetry equivalent of an iteration is one info interval
+                    m_iterations.push_back(telemetry::IterationReport{
+                        .depth = static_cast<u32>(info.pv.size()),
+                        .nodes = info.playouts,
+                        .timeMs = info.timeSec * 1000.0,
+                        .ebf = info.branching,
+                    });
+
+                    lastInfo = now;
+                }
+            }
+        }
+    }
+
+    void Searcher::playout(stats::ThreadStats& threadStats) {
+        StaticVector<NodeIndex, kMaxDepth + 1> path{};
+
+        auto pos = m_tree.rootPosition();
+        auto nodeIdx = m_tree.rootIndex();
+
+        m_tree[nodeIdx].virtualLoss.fetch_add(1, std::memory_order::relaxed);
+        path.push(nodeIdx);
+
+        threadStats.playout();
+
+        f64 value;
+
+        while (true) {
+            auto& node = m_tree[nodeIdx];
+            auto state = node.state.load(std::memory_order::acquire);
+
+            if (state == NodeState::kUnexpanded) {
+                if (node.state.compare_exchange_strong(state, NodeState::kExpanding, std::memory_order::acq_rel)) {
+                    value = expand(nodeIdx, pos);
+                    break;
+                }
+
+                // another thread got here first, state now holds what it did
+                continue;
+            }
+
+            if (state == NodeState::kTerminal) {
+                value = 1.0;
+                break;
+            }
+
+            // collided with another thread's expansion, out of room, or too deep: just score the leaf
+            if (state == NodeState::kExpanding || state == NodeState::kLeaf || path.size() > kMaxDepth) {
+                value = -scoreToValue(eval::evaluate(pos));
+                break;
+            }
+
+            nodeIdx = select(node);
+
+            auto& child = m_tree[nodeIdx];
+            child.virtualLoss.fetch_add(1, std::memory_order::relaxed);
+
+            threadStats.movePlayed(child.move);
+            pos = pos.applyMove(child.move);
+
+            path.push(nodeIdx);
+        }
+
+        const auto depth = static_cast<u32>(path.size() - 1);
+        auto seldepth = m_seldepth.load(std::memory_order::relaxed);
+
+        while (depth > seldepth && !m_seldepth.compare_exchange_weak(seldepth, depth, std::memory_order::relaxed)) {}
+
+        for (usize i = path.size(); i-- > 0;) {
+            auto& node = m_tree[path[i]];
+
+            node.valueSum.fetch_add(std::llround(value * kValueScale), std::memory_order::relaxed);
+            node.visits.fetch_add(1, std::memory_order::relaxed);
+            node.virtualLoss.fetch_sub(1, std::memory_order::relaxed);
+
+            value = -value;
+        }
+    }
+
+    f64 Searcher::expand(NodeIndex nodeIdx, const Position& pos) {
+        auto& node = m_tree[nodeIdx];
+
+        MoveList moves{};
+        generateAll(moves, pos);
+
+        // a side without moves loses
+        if (moves.empty()) {
+            node.state.store(NodeState::kTerminal, std::memory_order::release);
+
+            return 1.0;
+        }
+
+        const auto firstChild = m_tree.allocate(static_cast<u32>(moves.size()));
+
+        if (firstChild == kNoNode) {
+            // out of room: the tree stops growing, but playouts still refine what is there
+            node.state.store(NodeState::kLeaf, std::memory_order::release);
+            return -scoreToValue(eval::evaluate(pos));
+        }
+
+        StaticVector<f64, kMaxMoves> logits{};
+        logits.resize(moves.size());
+
+        // the whole list in one pass, instead of evaluating every child
+        std::array<f32, kMaxMoves> policyLogits;
+
+        if (m_policy) {
+            policy::FeatureBatch features{};
+            policy::extract(features, pos, moves);
+
+            m_policy->score(features, policyLogits);
+        }
+
+        const auto winLogit = static_cast<f64>(m_params.winPolicyScore()) / m_params.policyTemperature();
+
+        bool canWin = false;
+        // best logit among the children that do not win outright
+        auto maxOtherLogit = -std::numeric_limits<f64>::infinity();
+
+        for (usize i = 0; i < moves.size(); ++i) {
+            auto& child = m_tree[firstChild + i];
+            child.reset(moves[i], 0.0F);
+
+            const auto childPos = pos.applyMove(moves[i]);
+
+            if (childPos.winner() == pos.stm()) {
+                child.state.store(NodeState::kTerminal, std::memory_order::relaxed);
+
+                canWin = true;
+                logits[i] = winLogit;
+
+                continue;
+            }
+
+            if (m_policy) {
+                logits[i] = policyLogits[i];
+            } else {
+                logits[i] = static_cast<f64>(-eval::evaluate(childPos)) / m_params.policyTemperature();
+            }
+
+            maxOtherLogit = std::max(maxOtherLogit, logits[i]);
+        }
+
+        // network logits have their own scale, unrelated to the eval's, so winning children go
+        // a fixed margin above the network's best move instead of at an absolute score
+        if (m_policy && canWin && maxOtherLogit > -std::numeric_limits<f64>::infinity()) {
+            for (usize i = 0; i < moves.size(); ++i) {
+                if (m_tree[firstChild + i].state.load(std::memory_order::relaxed) == NodeState::kTerminal) {
+                    logits[i] = maxOtherLogit + winLogit;
+                }
+            }
+        }
+
+        const auto maxLogit = *std::ranges::max_element(logits);
+
+        f64 total = 0.0;
+
+        for (auto& logit : logits) {
+            logit = std::exp(logit - maxLogit);
+            total += logit;
+        }
+
+        for (usize i = 0; i < moves.size(); ++i) {
+            m_tree[firstChild + i].prior = static_cast<f32>(logits[i] / total);
+        }
+
+        node.firstChild = firstChild;
+        node.childCount = static_cast<u16>(moves.size());
+
+        // before publishing the children, so that no thread sees the priors change
+        if (nodeIdx == m_tree.rootIndex() && m_limits.noiseSeed != 0) {
+            addRootNoise(node);
+        }
+
+        node.state.store(NodeState::kExpanded, std::memory_order::release);
+
+        if (canWin) {
+            return -1.0;
+        }
+
+        return -scoreToValue(eval::evaluate(pos));
+    }
+
+    void Searcher::addRootNoise(const Node& root) {
+        util::rng::Jsf64Rng rng{m_limits.noiseSeed};
+
+        // a flat Dirichlet sample: normalised exponential variates
+        StaticVector<f64, kMaxMoves> noise{};
+        f64 total = 0.0;
+
+        for (u32 i = 0; i < root.childCount; ++i) {
+            noise.push(-std::log(1.0 - rng.nextF64()));
+            total += noise[i];
+        }
+
+        for (u32 i = 0; i < root.childCount; ++i) {
+            auto& child = m_tree[root.firstChild + i];
+            child.prior = static_cast<f32>((1.0 - kRootNoiseWeight) * child.prior + kRootNoiseWeight * noise[i] / total);
+        }
+    }
+
+    NodeIndex Searcher::select(const Node& node) const {
+        const auto parentVisits =
+            node.visits.load(std::memory_order::relaxed) + node.virtualLoss.load(std::memory_order::relaxed);
+        const auto explorationScale =
+            m_params.cpuct() / 100.0 * std::sqrt(static_cast<f64>(std::max<u32>(parentVisits, 1)));
+
+        // node.q() is from the point of view of the side that moved into it
+        const auto fpu =
+            (node.visits.load(std::memory_order::relaxed) > 0 ? -node.q() : 0.0) - m_params.fpuReduction() / 100.0;
+
+        auto best = node.firstChild;
+        auto bestScore = -std::numeric_limits<f64>::infinity();
+
+        for (u32 i = 0; i < node.childCount; ++i) {
+            const auto childIdx = node.firstChild + i;
+            const auto& child = m_tree[childIdx];
+
+            const auto visits = child.visits.load(std::memory_order::relaxed);
+            const auto virtualLoss = child.virtualLoss.load(std::memory_order::relaxed);
+            const auto effectiveVisits = visits + virtualLoss;
+
+            const auto q = effectiveVisits > 0
+                             ? (static_cast<f64>(child.valueSum.load(std::memory_order::relaxed)) / kValueScale
+                                   - static_cast<f64>(virtualLoss))
+                                   / static_cast<f64>(effectiveVisits)
+                             : fpu;
+
+            const auto u = explorationScale * child.prior / static_cast<f64>(1 + effectiveVisits);
+
+            if (q + u > bestScore) {
+                best = childIdx;
+                bestScore = q + u;
+            }
+        }
+
+        return best;
+    }
+
+    f64 Searcher::scoreToValue(i32 score) const {
+        return std::tanh(static_cast<f64>(score) / m_params.valueScale());
+    }
+
+    bool Searcher::limitsReached() const {
+        if (m_limits.cancel && m_limits.cancel->load(std::memory_order::relaxed)) {
+            return true;
+        }
+
+        if (m_limits.maxPlayouts > 0 && m_playouts.load(std::memory_order::relaxed) >= m_limits.maxPlayouts) {
+            return true;
+        }
+
+        return m_limits.maxTime.count() > 0 && std::chrono::steady_clock::now() - m_start >= m_limits.maxTime;
+    }
+
+    std::vector<RootMove> Searcher::rootMoves() const {
+        std::vector<RootMove> moves{};
+
+        const auto& root = m_tree[m_tree.rootIndex()];
+
+        if (root.state.load(std::memory_order::acquire) != NodeState::kExpanded) {
+            return moves;
+        }
+
+        for (u32 i = 0; i < root.childCount; ++i) {
+            const auto& child = m_tree[root.firstChild + i];
+            const auto visits = child.visits.load(std::memory_order::relaxed);
+
+            moves.push_back({child.move, visits, visits > 0 ? child.q() : 0.0});
+        }
+
+        std::ranges::stable_sort(moves, [](const RootMove& a, const RootMove& b) { return a.visits > b.visits; });
+
+        return moves;
+    }
+
+    SearchInfo Searcher::report(u64 reusedVisits) const {
+        SearchInfo info{};
+
+        info.playouts = m_playouts.load(std::memory_order::relaxed);
+        info.timeSec = std::chrono::duration<f64>(std::chrono::steady_clock::now() - m_start).count();
+        info.treeUsage = m_tree.usage();
+        info.reusedVisits = reusedVisits;
+
+        const auto& root = m_tree[m_tree.rootIndex()];
+        info.value = -root.q();
+
+        const auto* node = &root;
+
+        f64 branchingSum = 0.0;
+        f64 branchingWeight = 0.0;
+
+        while (info.pv.size() < kMaxDepth && node->state.load(std::memory_order::acquire) == NodeState::kExpanded) {
+            const Node* best = nullptr;
+
+            f64 visitSum = 0.0;
+            f64 squaredVisitSum = 0.0;
+
+            for (u32 i = 0; i < node->childCount; ++i) {
+                const auto& child = m_tree[node->firstChild + i];
+                const auto visits = static_cast<f64>(child.visits.load(std::memory_order::relaxed));
+
+                visitSum += visits;
+                squaredVisitSum += visits * visits;
+
+                if (!best
+                    || child.visits.load(std::memory_order::relaxed) > best->visits.load(std::memory_order::relaxed)) {
+                    best = &child;
+                }
+            }
+
+            if (!best || best->visits.load(std::memory_order::relaxed) == 0) {
+                break;
+            }
+
+            // effective number of children searched: n if visits are spread evenly over n of them
+            branchingSum += visitSum * (visitSum * visitSum / squaredVisitSum);
+            branchingWeight += visitSum;
+
+            info.pv.push_back(best->move);
+            node = best;
+        }
+
+        info.bestMove = info.pv.empty() ? kNullMove : info.pv.front();
+        info.branching = branchingWeight > 0.0 ? branchingSum / branchingWeight : 0.0;
+
+        return info;
+    }
+} // namespace octachoron::mcts
@@ -0,0 +1,169 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "../types.h"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <vector>
+
+#include "../move.h"
+#include "../policy.h"
+#include "../position.h"
+#include "../stats.h"
+#include "../telemetry.h"
+#include "../tunable.h"
+#include "tree.h"
+
+namespace octachoron::mcts {
+    // see tunable.h for what these are
+    using Params = tunable::Values;
+
+    struct SearchLimits {
+        // 0 for no limit
+        u64 maxPlayouts{};
+        std::chrono::milliseconds maxTime{};
+        // stops the search once set, if given. unlike stop(), may be set before the search starts
+        const std::atomic<bool>* cancel{};
+        // Non-zero to mix noise drawn from this seed into the root's priors. The search is
+        // otherwise deterministic, so root-parallel searchers need distinct seeds to differ.
+        u64 noiseSeed{};
+    };
+
+    struct SearchInfo {
+        u64 playouts;
+        f64 timeSec;
+        // expected result for the side to move at the root, in [-1, 1]
+        f64 value;
+        Move bestMove;
+        // most visited line
+        std::vector<Move> pv;
+        // permille of the tree in use
+        u32 treeUsage;
+        // visits kept from the previous search
+        u64 reusedVisits;
+        // mean over the pv, weighted by visits, of the effective number of children searched
+        f64 branching;
+    };
+
+    struct RootMove {
+        Move move;
+        u32 visits;
+        // for the side to move at the root, in [-1, 1]
+        f64 value;
+    };
+
+    using InfoCallback = std::function<void(const SearchInfo&)>;
+
+    // Parallel Monte-Carlo tree search. Every thread descends from the root by PUCT, adding
+    // virtual loss to each node on its way so that others spread out, then expands the leaf it
+    // reaches, scoring it and deriving its children's priors with the policy network if one is
+    // set, or else with the static eval of each child.
+    class Searcher {
+    public:
+        explicit Searcher(usize treeMb = 64, u32 threads = 1);
+
+        void setThreads(u32 threads);
+        void resize(usize treeMb);
+
+        // forget the tree, so that nothing is reused by the next search
+        void newGame();
+
+        [[nodiscard]] inline Params& params() {
+            return m_params;
+        }
+
+        // not owned, and may be shared between searchers. null to go back to eval-based priors
+        inline void setPolicy(const policy::Network* policy) {
+            m_policy = policy;
+        }
+
+        // called from the searching thread every interval, and once at the end
+        void setInfoCallback(InfoCallback callback, std::chrono::milliseconds interval);
+
+        // not owned. if set, a report of every search is submitted to it when the search ends
+        inline void setTelemetry(telemetry::JsonLinesWriter* telemetry) {
+            m_telemetry = telemetry;
+        }
+
+        // The tree is kept between searches: if pos follows the last searched position by
+        // one or two plies, the subtree already built for it is reused.
+        SearchInfo search(const Position& pos, const SearchLimits& limits);
+
+        // the root's children after the last search, most visited first
+        [[nodiscard]] std::vector<RootMove> rootMoves() const;
+
+        // safe to call from any thread while a search is running
+        inline void stop() {
+            m_stop.store(true, std::memory_order::relaxed);
+        }
+
+        [[nodiscard]] std::vector<const stats::ThreadStats*> threadStats() const;
+
+    private:
+        // deepest a playout may go before the leaf is scored without expanding it
+        static constexpr usize kMaxDepth = 256;
+
+        Tree m_tree{};
+        u32 m_threads;
+
+        Params m_params{};
+
+        const policy::Network* m_policy{};
+
+        InfoCallback m_infoCallback{};
+        std::chrono::milliseconds m_infoInterval{1000};
+
+        telemetry::JsonLinesWriter* m_telemetry{};
+        // only touched by the main search thread
+        std::vector<telemetry::IterationReport> m_iterations{};
+
+        SearchLimits m_limits{};
+        std::chrono::steady_clock::time_point m_start{};
+
+        std::atomic<bool> m_stop{};
+        std::atomic<u64> m_playouts{};
+        // longest path from the root, in plies
+        std::atomic<u32> m_seldepth{};
+
+        std::vector<stats::ThreadStats> m_stats{};
+
+        void runThread(u32 threadIdx);
+        void playout(stats::ThreadStats& threadStats);
+
+        // -> result for the side that played into the node
+        [[nodiscard]] f64 expand(NodeIndex nodeIdx, const Position& pos);
+
+        // mixes seeded noise into the priors of the root's children, see SearchLimits::noiseSeed
+        void addRootNoise(const Node& root);
+
+        [[nodiscard]] NodeIndex select(const Node& node) const;
+
+        [[nodiscard]] f64 scoreToValue(i32 score) const;
+
+        [[nodiscard]] bool limitsReached() const;
+
+        [[nodiscard]] SearchInfo report(u64 reusedVisits) const;
+
+        // final info callback and telemetry
+        void finish(const SearchInfo& info);
+    };
+} // namespace octachoron::mcts
@@ -0,0 +1,193 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "tree.h"
+
+namespace octachoron::mcts {
+    void Node::reset(Move newMove, f32 newPrior) {
+        visits.store(0, std::memory_order::relaxed);
+        virtualLoss.store(0, std::memory_order::relaxed);
+        valueSum.store(0, std::memory_order::relaxed);
+        state.store(NodeState::kUnexpanded, std::memory_order::relaxed);
+
+        firstChild = kNoNode;
+        childCount = 0;
+
+        move = newMove;
+        prior = newPrior;
+    }
+
+    f64 Node::q() const {
+        const auto n = visits.load(std::memory_order::relaxed);
+
+        if (n == 0) {
+            return 0.0;
+        }
+
+        return static_cast<f64>(valueSum.load(std::memory_order::relaxed)) / kValueScale / static_cast<f64>(n);
+    }
+
+    void NodePool::resize(usize capacity) {
+        m_nodes = std::make_unique<Node[]>(capacity);
+        m_capacity = capacity;
+
+        clear();
+    }
+
+    void NodePool::clear() {
+        m_used.store(0, std::memory_order::relaxed);
+    }
+
+    NodeIndex NodePool::allocate(u32 count) {
+        const auto first = m_used.fetch_add(count, std::memory_order::relaxed);
+
+        // the counter may run past the end; used() clamps it
+        if (first + count > m_capacity) {
+            return kNoNode;
+        }
+
+        return static_cast<NodeIndex>(first);
+    }
+
+    void Tree::resize(usize mb) {
+        const auto capacity = std::clamp<usize>(mb * 1024 * 1024 / 2 / sizeof(Node), 1, kNoNode);
+
+        for (auto& pool : m_pools) {
+            pool.resize(capacity);
+        }
+
+        clear();
+    }
+
+    void Tree::clear() {
+        for (auto& pool : m_pools) {
+            pool.clear();
+        }
+
+        m_hasRoot = false;
+    }
+
+    bool Tree::setRoot(const Position& pos) {
+        NodeIndex found = kNoNode;
+
+        if (m_hasRoot) {
+            found = find(pos);
+
+            if (found == rootIndex()) {
+                return true;
+            }
+        }
+
+        auto& next = m_pools[m_active ^ 1];
+        next.clear();
+
+        const auto root = next.allocate(1);
+        assert(root == 0);
+
+        if (found != kNoNode) {
+            copySubtree(next, root, found);
+            next[root].move = kNullMove;
+        } else {
+            next[root].reset(kNullMove, 1.0F);
+        }
+
+        pool().clear();
+        m_active ^= 1;
+
+        m_rootPos = pos;
+        m_hasRoot = true;
+
+        return found != kNoNode;
+    }
+
+    u32 Tree::usage() const {
+        return static_cast<u32>(pool().used() * 1000 / std::max<usize>(pool().capacity(), 1));
+    }
+
+    NodeIndex Tree::find(const Position& pos) const {
+        const auto& nodes = pool();
+
+        if (pos.key() == m_rootPos.key()) {
+            return rootIndex();
+        }
+
+        const auto& root = nodes[rootIndex()];
+
+        if (root.state.load(std::memory_order::relaxed) != NodeState::kExpanded) {
+            return kNoNode;
+        }
+
+        // our move, then possibly the opponent's reply
+        for (u32 i = 0; i < root.childCount; ++i) {
+            const auto childIdx = root.firstChild + i;
+            const auto& child = nodes[childIdx];
+
+            const auto childPos = m_rootPos.applyMove(child.move);
+
+            if (childPos.key() == pos.key()) {
+                return childIdx;
+            }
+
+            if (child.state.load(std::memory_order::relaxed) != NodeState::kExpanded) {
+                continue;
+            }
+
+            for (u32 j = 0; j < child.childCount; ++j) {
+                const auto grandchildIdx = child.firstChild + j;
+
+                if (childPos.applyMove(nodes[grandchildIdx].move).key() == pos.key()) {
+                    return grandchildIdx;
+                }
+            }
+        }
+
+        return kNoNode;
+    }
+
+    void Tree::copySubtree(NodePool& dst, NodeIndex dstIdx, NodeIndex srcIdx) const {
+        const auto& src = pool()[srcIdx];
+        auto& node = dst[dstIdx];
+
+        node.reset(src.move, src.prior);
+
+        node.visits.store(src.visits.load(std::memory_order::relaxed), std::memory_order::relaxed);
+        node.valueSum.store(src.valueSum.load(std::memory_order::relaxed), std::memory_order::relaxed);
+
+        const auto state = src.state.load(std::memory_order::relaxed);
+
+        if (state != NodeState::kExpanded) {
+            // a node left mid-expansion by a stopped search, or that found the old tree full,
+            // is simply expanded again
+            const auto copied = state == NodeState::kTerminal ? state : NodeState::kUnexpanded;
+            node.state.store(copied, std::memory_order::relaxed);
+            return;
+        }
+
+        const auto firstChild = dst.allocate(src.childCount);
+        assert(firstChild != kNoNode);
+
+        node.firstChild = firstChild;
+        node.childCount = src.childCount;
+
+        for (u32 i = 0; i < src.childCount; ++i) {
+            copySubtree(dst, firstChild + i, src.firstChild + i);
+        }
+
+        node.state.store(NodeState::kExpanded, std::memory_order::relaxed);
+    }
+} // namespace octachoron::mcts
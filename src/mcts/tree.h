@@ -0,0 +1,163 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "../types.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <memory>
+
+#include "../move.h"
+#include "../position.h"
+
+namespace octachoron::mcts {
+    using NodeIndex = u32;
+    constexpr NodeIndex kNoNode = ~NodeIndex{0};
+
+    // values are accumulated as fixed point, so that they can be summed atomically
+    constexpr f64 kValueScale = 1 << 16;
+
+    enum class NodeState : u8 {
+        kUnexpanded = 0,
+        // a thread is generating this node's children
+        kExpanding,
+        kExpanded,
+        // The game is over here. Reaching the goal row and leaving the opponent
+        // without moves both win, so this is always a win for the side that moved.
+        kTerminal,
+        // The tree was full when this node was to be expanded. It is scored by eval on every
+        // later visit instead, without generating its moves again.
+        kLeaf,
+    };
+
+    struct Node {
+        // results for the side that played move
+        std::atomic<i64> valueSum{};
+
+        std::atomic<u32> visits{};
+        // threads currently searching below this node, each counted as a loss until it returns
+        std::atomic<u32> virtualLoss{};
+
+        // firstChild and childCount are published by the release store of kExpanded
+        NodeIndex firstChild{kNoNode};
+
+        Move move{};
+        f32 prior{};
+
+        u16 childCount{};
+        std::atomic<NodeState> state{NodeState::kUnexpanded};
+
+        void reset(Move newMove, f32 newPrior);
+
+        // mean result for the side that played move, ignoring virtual loss
+        [[nodiscard]] f64 q() const;
+    };
+
+    static_assert(sizeof(Node) == 32);
+
+    // A fixed block of nodes handed out with an atomic bump pointer. Children of a node are
+    // always contiguous, and nothing is freed until the whole pool is cleared.
+    class NodePool {
+    public:
+        void resize(usize capacity);
+        void clear();
+
+        // -> index of the first of count contiguous nodes, or kNoNode if the pool is full
+        [[nodiscard]] NodeIndex allocate(u32 count);
+
+        [[nodiscard]] inline Node& operator[](NodeIndex idx) {
+            assert(idx < m_capacity);
+            return m_nodes[idx];
+        }
+
+        [[nodiscard]] inline const Node& operator[](NodeIndex idx) const {
+            assert(idx < m_capacity);
+            return m_nodes[idx];
+        }
+
+        [[nodiscard]] inline usize used() const {
+            return std::min<usize>(m_used.load(std::memory_order::relaxed), m_capacity);
+        }
+
+        [[nodiscard]] inline usize capacity() const {
+            return m_capacity;
+        }
+
+    private:
+        std::unique_ptr<Node[]> m_nodes{};
+        usize m_capacity{};
+
+        std::atomic<usize> m_used{};
+    };
+
+    // The search tree, built in one of two pools. When the root moves on to a position already
+    // in the tree, its subtree is copied into the other pool and everything else is dropped.
+    class Tree {
+    public:
+        void resize(usize mb);
+        void clear();
+
+        // -> true if pos was found at most two plies below the old root, and its subtree kept
+        bool setRoot(const Position& pos);
+
+        [[nodiscard]] inline const Position& rootPosition() const {
+            return m_rootPos;
+        }
+
+        [[nodiscard]] inline NodeIndex rootIndex() const {
+            return 0;
+        }
+
+        [[nodiscard]] inline Node& operator[](NodeIndex idx) {
+            return pool()[idx];
+        }
+
+        [[nodiscard]] inline const Node& operator[](NodeIndex idx) const {
+            return pool()[idx];
+        }
+
+        [[nodiscard]] inline NodeIndex allocate(u32 count) {
+            return pool().allocate(count);
+        }
+
+        // permille of the active pool in use
+        [[nodiscard]] u32 usage() const;
+
+    private:
+        std::array<NodePool, 2> m_pools{};
+        usize m_active{};
+
+        Position m_rootPos{};
+        bool m_hasRoot{false};
+
+        [[nodiscard]] inline NodePool& pool() {
+            return m_pools[m_active];
+        }
+
+        [[nodiscard]] inline const NodePool& pool() const {
+            return m_pools[m_active];
+        }
+
+        [[nodiscard]] NodeIndex find(const Position& pos) const;
+
+        void copySubtree(NodePool& dst, NodeIndex dstIdx, NodeIndex srcIdx) const;
+    };
+} // namespace octachoron::mcts
@@ -0,0 +1,206 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "harness.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+
+#ifdef __linux__
+    #include <linux/perf_event.h>
+    #include <sys/ioctl.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
+
+namespace octachoron::microbench {
+    namespace {
+        using Clock = std::chrono::steady_clock;
+
+        struct Sample {
+            f64 ns;
+            std::optional<u64> cycles;
+        };
+
+        Sample measure(const Benchmark& bench, u64 iterations, const CycleCounter& cycles) {
+            const auto startCycles = cycles.read();
+            const auto start = Clock::now();
+
+            bench.func(iterations);
+            clobberMemory();
+
+            const auto end = Clock::now();
+            const auto endCycles = cycles.read();
+
+            Sample sample{};
+            sample.ns = std::chrono::duration<f64, std::nano>(end - start).count();
+
+            if (startCycles && endCycles) {
+                sample.cycles = *endCycles - *startCycles;
+            }
+
+            return sample;
+        }
+
+        template <typename T>
+        T median(std::vector<T> values) {
+            std::ranges::sort(values);
+
+            const auto mid = values.size() / 2;
+
+            if (values.size() % 2 == 0) {
+                return (values[mid - 1] + values[mid]) / 2;
+            } else {
+                return values[mid];
+            }
+        }
+    } // namespace
+
+    CycleCounter::CycleCounter() {
+#ifdef __linux__
+        perf_event_attr attr{};
+
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(perf_event_attr);
+        attr.config = PERF_COUNT_HW_CPU_CYCLES;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+
+        m_fd = static_cast<i32>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+
+        if (m_fd >= 0) {
+            ioctl(m_fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(m_fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    CycleCounter::~CycleCounter() {
+#ifdef __linux__
+        if (m_fd >= 0) {
+            close(m_fd);
+        }
+#endif
+    }
+
+    std::optional<u64> CycleCounter::read() const {
+#ifdef __linux__
+        if (m_fd < 0) {
+            return {};
+        }
+
+        u64 value{};
+
+        if (::read(m_fd, &value, sizeof(value)) != sizeof(value)) {
+            return {};
+        }
+
+        return value;
+#else
+        return {};
+#endif
+    }
+
+    BenchResult run(const Benchmark& bench, const BenchConfig& config, const CycleCounter& cycles) {
+        // warm up, and double the iteration count until one sample takes long enough to time reliably
+        u64 iterations = 1;
+
+        while (true) {
+            const auto sample = measure(bench, iterations, cycles);
+
+            if (sample.ns >= config.targetSampleMs * 1000000.0 || iterations >= (u64{1} << 40)) {
+                break;
+            }
+
+            iterations *= 2;
+        }
+
+        std::vector<f64> nsPerOp{};
+        std::vector<f64> cyclesPerOp{};
+
+        nsPerOp.reserve(config.repetitions);
+        cyclesPerOp.reserve(config.repetitions);
+
+        for (u32 rep = 0; rep < config.repetitions; ++rep) {
+            const auto sample = measure(bench, iterations, cycles);
+
+            nsPerOp.push_back(sample.ns / static_cast<f64>(iterations));
+
+            if (sample.cycles) {
+                cyclesPerOp.push_back(static_cast<f64>(*sample.cycles) / static_cast<f64>(iterations));
+            }
+        }
+
+        BenchResult result{};
+
+        result.name = bench.name;
+        result.iterations = iterations;
+        result.repetitions = config.repetitions;
+        result.medianNsPerOp = median(nsPerOp);
+        result.minNsPerOp = *std::ranges::min_element(nsPerOp);
+        result.maxNsPerOp = *std::ranges::max_element(nsPerOp);
+
+        // only report cycles if every repetition could be counted
+        if (!cyclesPerOp.empty() && cyclesPerOp.size() == nsPerOp.size()) {
+            result.medianCyclesPerOp = median(cyclesPerOp);
+        }
+
+        return result;
+    }
+
+    void printText(const BenchResult& result) {
+        std::printf(
+            "%-32s %12.3f ns/op (min %.3f, max %.3f)",
+            result.name.c_str(),
+            result.medianNsPerOp,
+            result.minNsPerOp,
+            result.maxNsPerOp
+        );
+
+        if (result.medianCyclesPerOp) {
+            std::printf(" %10.2f cycles/op", *result.medianCyclesPerOp);
+        }
+
+        std::printf(" [%llu iters x %u reps]\n", static_cast<unsigned long long>(result.iterations), result.repetitions);
+        std::fflush(stdout);
+    }
+
+    void printJson(const BenchResult& result) {
+        std::printf(
+            "{\"name\":\"%s\",\"iterations\":%llu,\"repetitions\":%u,"
+            "\"ns_per_op\":%.4f,\"ns_per_op_min\":%.4f,\"ns_per_op_max\":%.4f,\"cycles_per_op\":",
+            result.name.c_str(),
+            static_cast<unsigned long long>(result.iterations),
+            result.repetitions,
+            result.medianNsPerOp,
+            result.minNsPerOp,
+            result.maxNsPerOp
+        );
+
+        if (result.medianCyclesPerOp) {
+            std::printf("%.3f}\n", *result.medianCyclesPerOp);
+        } else {
+            std::printf("null}\n");
+        }
+
+        std::fflush(stdout);
+    }
+} // namespace octachoron::microbench
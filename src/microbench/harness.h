@@ -0,0 +1,90 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "../types.h"
+
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace octachoron::microbench {
+    // keeps the compiler from discarding or hoisting a computed value
+    template <typename T>
+    inline void doNotOptimize(const T& value) {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+    inline void clobberMemory() {
+        asm volatile("" : : : "memory");
+    }
+
+    // reads the cpu cycle counter of the calling thread via perf_event_open, if the kernel allows it
+    class CycleCounter {
+    public:
+        CycleCounter();
+        ~CycleCounter();
+
+        CycleCounter(const CycleCounter&) = delete;
+        CycleCounter(CycleCounter&&) = delete;
+
+        [[nodiscard]] inline bool available() const {
+            return m_fd >= 0;
+        }
+
+        [[nodiscard]] std::optional<u64> read() const;
+
+        CycleCounter& operator=(const CycleCounter&) = delete;
+        CycleCounter& operator=(CycleCounter&&) = delete;
+
+    private:
+        i32 m_fd{-1};
+    };
+
+    // a benchmark body performs the measured operation `iterations` times
+    using BenchFunc = std::function<void(u64 iterations)>;
+
+    struct Benchmark {
+        std::string name;
+        BenchFunc func;
+    };
+
+    struct BenchConfig {
+        u32 repetitions{15};
+        f64 targetSampleMs{20.0};
+        std::string_view filter{};
+    };
+
+    struct BenchResult {
+        std::string name;
+        u64 iterations;
+        u32 repetitions;
+        f64 medianNsPerOp;
+        f64 minNsPerOp;
+        f64 maxNsPerOp;
+        std::optional<f64> medianCyclesPerOp;
+    };
+
+    [[nodiscard]] BenchResult run(const Benchmark& bench, const BenchConfig& config, const CycleCounter& cycles);
+
+    void printText(const BenchResult& result);
+    void printJson(const BenchResult& result);
+} // namespace octachoron::microbench
@@ -0,0 +1,333 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "../types.h"
+
+#include <array>
+#include <iostream>
+#include <string_view>
+#include <vector>
+
+#include "../geometry.h"
+#include "../movegen.h"
+#include "../position.h"
+#include "../util/parse.h"
+#include "harness.h"
+
+namespace octachoron::microbench {
+    // the only way into Position's private helpers, and only ever used here
+    struct PositionAccess {
+        static void flipCells(Position& pos, Piece piece, Bitboard mask) {
+            pos.flipCells(piece, mask);
+        }
+
+        static Piece addStack(Position& pos, Piece upper, Piece lower, Cell cell) {
+            return pos.addStack(upper, lower, cell);
+        }
+    };
+
+    namespace {
+        constexpr std::array kFens = {
+            "s-p-r-s-p-r-/p-r-s-wwr-s-p-/6/7/6/P-S-R-WWS-R-P-/R-P-S-R-P-S- w 0 1",
+            "s-p-r-s-p-r-/p-r-s-wwr-s-p-/6/7/2W-3/P-S-R-W-S-R-P-/R-P-S-R-P-S- b 1 1",
+            "s-p-r-s-p-r-/p-r-s-w-r-s-p-/3w-2/7/2W-3/P-S-R-W-S-R-P-/R-P-S-R-P-S- w 2 2",
+            "1p-r-s-p-r-/p-r-s-wwr-s-p-/1s-4/7/6/P-S-R-WWS-R-P-/R-P-S-R-P-S- w 0 2",
+        };
+
+        constexpr std::array kPieceStrs = {
+            "W-", "w-", "R-", "r-", "P-", "p-", "S-", "s-", "RR", "rr", "RP", "rp", "RS", "rs", "PR",
+            "pr", "PP", "pp", "PS", "ps", "SR", "sr", "SP", "sp", "SS", "ss", "WW", "ww", "WR", "wr",
+            "WP", "wp", "WS", "ws", "xx", "W",  "",   "Rw",
+        };
+
+        // a spread of boards, so that every edge mask actually matters
+        constexpr std::array kShiftInputs = {
+            Bitboard{UINT64_C(0x1fffffffffff)},
+            Bitboard{UINT64_C(0x00000fc01fff)},
+            Bitboard{UINT64_C(0x1f8000000000)},
+            Bitboard{UINT64_C(0x104082041020)},
+            Bitboard{UINT64_C(0x008104082041)},
+            Bitboard{UINT64_C(0x0a5a5a5a5a5a)},
+            Bitboard{UINT64_C(0x000000010000)},
+            Bitboard{UINT64_C(0x1234567890ab)},
+        };
+
+        // positions from a few deterministic pseudorandom games, for a realistic spread of move counts
+        std::vector<Position> samplePositions() {
+            std::vector<Position> positions{};
+
+            u64 state = UINT64_C(0x9e3779b97f4a7c15);
+
+            for (u32 game = 0; game < 16; ++game) {
+                auto pos = Position::startpos();
+
+                for (u32 ply = 0; ply < 48 && pos.winner() == Colors::kNone; ++ply) {
+                    MoveList moves{};
+                    generateAll(moves, pos);
+
+                    if (moves.empty()) {
+                        break;
+                    }
+
+                    positions.push_back(pos);
+
+                    state = state * UINT64_C(6364136223846793005) + UINT64_C(1442695040888963407);
+                    pos = pos.applyMove(moves[(state >> 33) % moves.size()]);
+                }
+            }
+
+            return positions;
+        }
+
+        template <typename Op>
+        Benchmark shiftBench(std::string name, Op op) {
+            return {std::move(name), [op](u64 iterations) {
+                        for (u64 i = 0; i < iterations; ++i) {
+                            auto bb = kShiftInputs[i % kShiftInputs.size()];
+                            doNotOptimize(bb);
+                            doNotOptimize(op(bb));
+                        }
+                    }};
+        }
+
+        std::vector<Benchmark> benchmarks() {
+            std::vector<Benchmark> benches{};
+
+            const auto startpos = Position::startpos();
+
+            const std::array singleMoves = {
+                Move::makeSingle(Cells::kB2, Cells::kC2),
+                Move::makeSingle(Cells::kB3, Cells::kC3),
+                Move::makeSingle(Cells::kB5, Cells::kC4),
+                Move::makeSingle(Cells::kA4, Cells::kB4),
+            };
+
+            const std::array stackMoves = {
+                Move::makeSingle(Cells::kB4, Cells::kC3),
+                Move::makeSingle(Cells::kB4, Cells::kD3),
+                Move::makeSingleUnstack(Cells::kB4, Cells::kC3),
+                Move::makeSingleUnstack(Cells::kB4, Cells::kC4),
+            };
+
+            benches.push_back({"position/applyMove/single", [=](u64 iterations) {
+                                   for (u64 i = 0; i < iterations; ++i) {
+                                       auto pos = startpos;
+                                       doNotOptimize(pos);
+                                       doNotOptimize(pos.applyMove(singleMoves[i % singleMoves.size()]));
+                                   }
+                               }});
+
+            benches.push_back({"position/applyMove/stack", [=](u64 iterations) {
+                                   for (u64 i = 0; i < iterations; ++i) {
+                                       auto pos = startpos;
+                                       doNotOptimize(pos);
+                                       doNotOptimize(pos.applyMove(stackMoves[i % stackMoves.size()]));
+                                   }
+                               }});
+
+            benches.push_back({"position/flipCells", [=](u64 iterations) {
+                                   static constexpr std::array kPieces = {
+                                       Pieces::kWhiteRock,
+                                       Pieces::kBlackPaperOnScissors,
+                                       Pieces::kWhiteWiseOnWise,
+                                       Pieces::kBlackScissors,
+                                   };
+
+                                   auto pos = startpos;
+
+                                   for (u64 i = 0; i < iterations; ++i) {
+                                       const auto cell = Cell::fromRaw(static_cast<u8>(i % Cells::kCount));
+                                       PositionAccess::flipCells(
+                                           pos,
+                                           kPieces[i % kPieces.size()],
+                                           Bitboard::fromCell(cell)
+                                       );
+                                       doNotOptimize(pos);
+                                   }
+                               }});
+
+            benches.push_back({"position/addStack", [=](u64 iterations) {
+                                   static constexpr std::array kStacks = {
+                                       std::pair{Pieces::kWhitePaper, Cells::kA1},
+                                       std::pair{Pieces::kWhiteScissors, Cells::kA2},
+                                       std::pair{Pieces::kWhiteRock, Cells::kB1},
+                                       std::pair{Pieces::kWhitePaper, Cells::kB2},
+                                   };
+
+                                   for (u64 i = 0; i < iterations; ++i) {
+                                       auto pos = startpos;
+                                       doNotOptimize(pos);
+
+                                       const auto [upper, cell] = kStacks[i % kStacks.size()];
+                                       doNotOptimize(PositionAccess::addStack(pos, upper, pos.pieceOn(cell), cell));
+                                       doNotOptimize(pos);
+                                   }
+                               }});
+
+            const auto positions = samplePositions();
+
+            benches.push_back({"movegen/generateAll", [=](u64 iterations) {
+                                   for (u64 i = 0; i < iterations; ++i) {
+                                       MoveList moves{};
+                                       generateAll(moves, positions[i % positions.size()]);
+                                       doNotOptimize(moves);
+                                   }
+                               }});
+
+            benches.push_back({"movegen/generateNoisy", [=](u64 iterations) {
+                                   for (u64 i = 0; i < iterations; ++i) {
+                                       MoveList moves{};
+                                       generateNoisy(moves, positions[i % positions.size()]);
+                                       doNotOptimize(moves);
+                                   }
+                               }});
+
+            benches.push_back({"movegen/countMoves", [=](u64 iterations) {
+                                   for (u64 i = 0; i < iterations; ++i) {
+                                       doNotOptimize(countMoves(positions[i % positions.size()]));
+                                   }
+                               }});
+
+            benches.push_back({"position/canonicalKey", [=](u64 iterations) {
+                                   for (u64 i = 0; i < iterations; ++i) {
+                                       doNotOptimize(positions[i % positions.size()].canonicalKey());
+                                   }
+                               }});
+
+            benches.push_back({"piece/fromStr", [](u64 iterations) {
+                                   for (u64 i = 0; i < iterations; ++i) {
+                                       std::string_view str = kPieceStrs[i % kPieceStrs.size()];
+                                       doNotOptimize(str);
+                                       doNotOptimize(Piece::fromStr(str));
+                                   }
+                               }});
+
+            benches.push_back({"position/fromFen", [](u64 iterations) {
+                                   for (u64 i = 0; i < iterations; ++i) {
+                                       std::string_view fen = kFens[i % kFens.size()];
+                                       doNotOptimize(fen);
+                                       doNotOptimize(Position::fromFen(fen));
+                                   }
+                               }});
+
+            benches.push_back(shiftBench("bitboard/shiftNorthWest", [](Bitboard bb) { return bb.shiftNorthWest(); }));
+            benches.push_back(shiftBench("bitboard/shiftNorthEast", [](Bitboard bb) { return bb.shiftNorthEast(); }));
+            benches.push_back(shiftBench("bitboard/shiftWest", [](Bitboard bb) { return bb.shiftWest(); }));
+            benches.push_back(shiftBench("bitboard/shiftEast", [](Bitboard bb) { return bb.shiftEast(); }));
+            benches.push_back(shiftBench("bitboard/shiftSouthWest", [](Bitboard bb) { return bb.shiftSouthWest(); }));
+            benches.push_back(shiftBench("bitboard/shiftSouthEast", [](Bitboard bb) { return bb.shiftSouthEast(); }));
+
+            benches.push_back({"geometry/neighbourBb", [](u64 iterations) {
+                                   for (u64 i = 0; i < iterations; ++i) {
+                                       auto cell = Cell::fromRaw(static_cast<u8>(i % Cells::kCount));
+                                       doNotOptimize(cell);
+                                       doNotOptimize(geometry::neighbourBb(cell));
+                                   }
+                               }});
+
+            benches.push_back({"geometry/twoStep", [](u64 iterations) {
+                                   for (u64 i = 0; i < iterations; ++i) {
+                                       auto cell = Cell::fromRaw(static_cast<u8>(i % Cells::kCount));
+                                       auto dir = geometry::kDirections[i % geometry::kDirectionCount];
+                                       doNotOptimize(cell);
+                                       doNotOptimize(dir);
+                                       doNotOptimize(geometry::twoStep(cell, dir));
+                                   }
+                               }});
+
+            benches.push_back({"geometry/distance", [](u64 iterations) {
+                                   for (u64 i = 0; i < iterations; ++i) {
+                                       auto a = Cell::fromRaw(static_cast<u8>(i % Cells::kCount));
+                                       auto b = Cell::fromRaw(static_cast<u8>((i * 7) % Cells::kCount));
+                                       doNotOptimize(a);
+                                       doNotOptimize(b);
+                                       doNotOptimize(geometry::distance(a, b));
+                                   }
+                               }});
+
+            return benches;
+        }
+
+        void printUsage() {
+            std::cerr << "usage: octachoron-bench [--json] [--list] [--filter <substring>] [--reps <n>] [--sample-ms <ms>]"
+                      << std::endl;
+        }
+    } // namespace
+} // namespace octachoron::microbench
+
+using namespace octachoron;
+using namespace octachoron::microbench;
+
+i32 main(i32 argc, const char* argv[]) {
+    BenchConfig config{};
+
+    bool json = false;
+    bool list = false;
+
+    for (i32 i = 1; i < argc; ++i) {
+        const std::string_view arg{argv[i]};
+
+        if (arg == "--json") {
+            json = true;
+        } else if (arg == "--list") {
+            list = true;
+        } else if (arg == "--filter" && i + 1 < argc) {
+            config.filter = argv[++i];
+        } else if (arg == "--reps" && i + 1 < argc) {
+            if (!util::tryParse(config.repetitions, argv[++i]) || config.repetitions == 0) {
+                std::cerr << "invalid repetition count " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (arg == "--sample-ms" && i + 1 < argc) {
+            if (!util::tryParse(config.targetSampleMs, argv[++i]) || config.targetSampleMs <= 0.0) {
+                std::cerr << "invalid sample time " << argv[i] << std::endl;
+                return 1;
+            }
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    const CycleCounter cycles{};
+
+    if (!json && !list && !cycles.available()) {
+        std::cerr << "perf_event_open unavailable, not counting cycles" << std::endl;
+    }
+
+    for (const auto& bench : benchmarks()) {
+        if (!config.filter.empty() && bench.name.find(config.filter) == std::string::npos) {
+            continue;
+        }
+
+        if (list) {
+            std::cout << bench.name << std::endl;
+            continue;
+        }
+
+        const auto result = run(bench, config, cycles);
+
+        if (json) {
+            printJson(result);
+        } else {
+            printText(result);
+        }
+    }
+
+    return 0;
+}
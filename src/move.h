@@ -21,6 +21,7 @@
 #include "types.h"
 
 #include <iostream>
+#include <string>
 
 #include "core.h"
 
@@ -57,11 +58,46 @@ namespace octachoron {
             return m_move == 0;
         }
 
+        // appends the text form, e.g. "d4d5", or "0000" for the null move. also what operator<<
+        // prints, for writers that build their output without a stream
+        inline void appendTo(std::string& dst) const {
+            const auto appendCell = [&dst](Cell cell) {
+                dst.push_back(static_cast<char>('a' + cell.row()));
+                dst.push_back(static_cast<char>('1' + cell.column()));
+            };
+
+            if (isNull()) {
+                dst += "0000";
+                return;
+            }
+
+            appendCell(from());
+
+            if (isSingleUnstack()) {
+                appendCell(from());
+            }
+
+            appendCell(to());
+
+            if (isDouble()) {
+                appendCell(to2());
+            }
+        }
+
+        // for storage, e.g. in book files
+        [[nodiscard]] constexpr u32 raw() const {
+            return m_move;
+        }
+
         [[nodiscard]] constexpr bool operator==(const Move&) const = default;
 
         constexpr Move& operator=(const Move&) = default;
         constexpr Move& operator=(Move&&) = default;
 
+        [[nodiscard]] static constexpr Move fromRaw(u32 move) {
+            return Move{move};
+        }
+
         [[nodiscard]] static constexpr Move makeSingle(Cell from, Cell to) {
             assert(from != Cells::kNone);
             assert(to != Cells::kNone);
@@ -92,8 +128,8 @@ namespace octachoron {
         static constexpr i32 kFromShift = 0;
         static constexpr i32 kToShift = 6;
         static constexpr i32 kTo2Shift = 12;
-        static constexpr i32 kSingleUnstackShift = 13;
-        static constexpr i32 kDoubleShift = 14;
+        static constexpr i32 kSingleUnstackShift = 18;
+        static constexpr i32 kDoubleShift = 19;
 
         static constexpr u32 kCellMask = 0b111111;
         static constexpr u32 kSingleUnstackMask = 0b1;
@@ -105,23 +141,10 @@ namespace octachoron {
         u32 m_move{};
 
         inline friend std::ostream& operator<<(std::ostream& stream, Move move) {
-            if (move.isNull()) {
-                stream << "0000";
-                return stream;
-            }
-
-            stream << move.from();
-
-            if (move.isSingleUnstack()) {
-                stream << move.from();
-            }
-
-            stream << move.to();
-
-            if (move.isDouble()) {
-                stream << move.to2();
-            }
+            std::string str{};
+            move.appendTo(str);
 
+            stream << str;
             return stream;
         }
     };
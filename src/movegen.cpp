@@ -0,0 +1,319 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "movegen.h"
+
+#include <array>
+
+#include "geometry.h"
+
+namespace octachoron {
+    namespace {
+        // Every move is a piece or stack leaving `from` for each cell of a destination set,
+        // optionally followed by a second action ending on each cell of another set. Sinks
+        // receive whole sets, so counting never has to materialise the moves.
+
+        struct ListSink {
+            MoveList& dst;
+
+            inline void singles(Cell from, Bitboard dests) {
+                while (!dests.empty()) {
+                    dst.push(Move::makeSingle(from, dests.popLowestCell()));
+                }
+            }
+
+            inline void unstacks(Cell from, Bitboard dests) {
+                while (!dests.empty()) {
+                    dst.push(Move::makeSingleUnstack(from, dests.popLowestCell()));
+                }
+            }
+
+            inline void doubles(Cell from, Cell to, Bitboard dests) {
+                while (!dests.empty()) {
+                    dst.push(Move::makeDouble(from, to, dests.popLowestCell()));
+                }
+            }
+        };
+
+        struct CountSink {
+            usize count{};
+
+            inline void singles(Cell, Bitboard dests) {
+                count += dests.popcount();
+            }
+
+            inline void unstacks(Cell, Bitboard dests) {
+                count += dests.popcount();
+            }
+
+            inline void doubles(Cell, Cell, Bitboard dests) {
+                count += dests.popcount();
+            }
+        };
+
+        // checks whether one particular move is among those generated
+        struct FindSink {
+            Move move;
+            bool found{};
+
+            inline void singles(Cell from, Bitboard dests) {
+                found |= !move.isDouble() && !move.isSingleUnstack() && from == move.from()
+                      && dests.getCell(move.to());
+            }
+
+            inline void unstacks(Cell from, Bitboard dests) {
+                found |= move.isSingleUnstack() && from == move.from() && dests.getCell(move.to());
+            }
+
+            inline void doubles(Cell from, Cell to, Bitboard dests) {
+                found |= move.isDouble() && from == move.from() && to == move.to() && dests.getCell(move.to2());
+            }
+        };
+
+        // rock beats scissors, paper beats rock, scissors beats paper, wise neither captures nor is captured
+        constexpr std::array kVictims = {
+            Roles::kNone,
+            Roles::kScissors,
+            Roles::kRock,
+            Roles::kPaper,
+        };
+
+        // cells a stack on `from` can reach: one step, or two steps in a line over an empty cell
+        inline Bitboard stackDests(Cell from, Bitboard empty, Bitboard targets) {
+            const auto landable = empty | targets;
+
+            auto dests = geometry::neighbourBb(from) & landable;
+
+            for (const auto [mid, dest] : geometry::twoSteps(from)) {
+                if (dest != Cells::kNone && empty.getCell(mid)) {
+                    dests |= Bitboard::fromCell(dest) & landable;
+                }
+            }
+
+            return dests;
+        }
+
+        template <u8 kUs, bool kNoisyOnly, typename Sink>
+        void generate(Sink& sink, const Position& pos) {
+            static constexpr auto kUsColor = Color::fromRaw(kUs);
+            static constexpr auto kThem = kUsColor.flip();
+
+            static constexpr auto kGoal = kUsColor == Colors::kWhite ? Bitboards::kRowG : Bitboards::kRowA;
+
+            assert(pos.stm() == kUsColor);
+
+            const auto ours = pos.colorBb(kUsColor);
+            const auto theirs = pos.colorBb(kThem);
+
+            const auto empty = ~(ours | theirs) & Bitboards::kAll;
+            const auto stacks = pos.stackBb();
+
+            const auto ourSingles = ours & ~stacks;
+            const auto ourWiseSingles = ourSingles & pos.roleBb(Roles::kWise);
+
+            std::array<Bitboard, Roles::kCount> targets{};
+
+            for (usize role = 0; role < Roles::kCount; ++role) {
+                if (const auto victim = kVictims[role]; victim != Roles::kNone) {
+                    targets[role] = theirs & pos.roleBb(victim);
+                }
+            }
+
+            // a wise may only be stacked onto another wise
+            const auto stackable = [&](Role role) {
+                return role == Roles::kWise ? ourWiseSingles : ourSingles;
+            };
+
+            // cells that win when a piece of this role ends its move on them
+            const auto goal = [&](Role role) {
+                return role == Roles::kWise ? Bitboards::kEmpty : kGoal;
+            };
+
+            auto singles = ourSingles;
+            while (!singles.empty()) {
+                const auto from = singles.popLowestCell();
+                const auto role = pos.pieceOn(from).role();
+
+                const auto moves = geometry::neighbourBb(from) & (empty | targets[role.idx()]);
+                const auto stacking = geometry::neighbourBb(from) & stackable(role);
+
+                if constexpr (kNoisyOnly) {
+                    sink.singles(from, (moves & (targets[role.idx()] | goal(role))) | (stacking & goal(role)));
+                } else {
+                    sink.singles(from, moves | stacking);
+                }
+
+                // stack, then move the new stack one or two cells. The moving piece ends up on top
+                const auto emptyAfter = empty | Bitboard::fromCell(from);
+
+                auto stackCells = stacking;
+                while (!stackCells.empty()) {
+                    const auto to = stackCells.popLowestCell();
+                    const auto dests = stackDests(to, emptyAfter, targets[role.idx()]);
+
+                    if constexpr (kNoisyOnly) {
+                        sink.doubles(from, to, dests & (targets[role.idx()] | goal(role)));
+                    } else {
+                        sink.doubles(from, to, dests);
+                    }
+                }
+            }
+
+            auto ourStacks = ours & stacks;
+            while (!ourStacks.empty()) {
+                const auto from = ourStacks.popLowestCell();
+                const auto stack = pos.pieceOn(from);
+
+                const auto role = stack.role();
+                const auto lowerRole = stack.lower().role();
+
+                const auto moves = stackDests(from, empty, targets[role.idx()]);
+                const auto unstacks = geometry::neighbourBb(from) & (empty | targets[role.idx()] | stackable(role));
+
+                if constexpr (kNoisyOnly) {
+                    sink.singles(from, moves & (targets[role.idx()] | goal(role)));
+                    sink.unstacks(from, unstacks & (targets[role.idx()] | goal(role)));
+                } else {
+                    sink.singles(from, moves);
+                    sink.unstacks(from, unstacks);
+                }
+
+                // move the stack, then unstack its top piece one cell from where it landed
+                const auto emptyAfterMove = empty | Bitboard::fromCell(from);
+
+                auto moveCells = moves;
+                while (!moveCells.empty()) {
+                    const auto to = moveCells.popLowestCell();
+                    const auto toBb = Bitboard::fromCell(to);
+
+                    const auto dests =
+                        geometry::neighbourBb(to) & ((emptyAfterMove & ~toBb) | targets[role.idx()] | stackable(role));
+
+                    if constexpr (kNoisyOnly) {
+                        // if the stack move itself captured or won, every unstack after it is noisy
+                        const auto noisyMove = !(toBb & (targets[role.idx()] | goal(lowerRole))).empty();
+                        sink.doubles(from, to, noisyMove ? dests : dests & (targets[role.idx()] | goal(role)));
+                    } else {
+                        sink.doubles(from, to, dests);
+                    }
+                }
+            }
+        }
+    } // namespace
+
+    template <u8 kUs>
+    void generateAll(MoveList& dst, const Position& pos) {
+        ListSink sink{dst};
+        generate<kUs, false>(sink, pos);
+    }
+
+    template <u8 kUs>
+    void generateNoisy(MoveList& dst, const Position& pos) {
+        ListSink sink{dst};
+        generate<kUs, true>(sink, pos);
+    }
+
+    template <u8 kUs>
+    usize countMoves(const Position& pos) {
+        CountSink sink{};
+        generate<kUs, false>(sink, pos);
+        return sink.count;
+    }
+
+    template void generateAll<Colors::kWhite.raw()>(MoveList&, const Position&);
+    template void generateAll<Colors::kBlack.raw()>(MoveList&, const Position&);
+
+    template void generateNoisy<Colors::kWhite.raw()>(MoveList&, const Position&);
+    template void generateNoisy<Colors::kBlack.raw()>(MoveList&, const Position&);
+
+    template usize countMoves<Colors::kWhite.raw()>(const Position&);
+    template usize countMoves<Colors::kBlack.raw()>(const Position&);
+
+    void generateAll(MoveList& dst, const Position& pos) {
+        if (pos.stm() == Colors::kWhite) {
+            generateAll<Colors::kWhite.raw()>(dst, pos);
+        } else {
+            generateAll<Colors::kBlack.raw()>(dst, pos);
+        }
+    }
+
+    void generateNoisy(MoveList& dst, const Position& pos) {
+        if (pos.stm() == Colors::kWhite) {
+            generateNoisy<Colors::kWhite.raw()>(dst, pos);
+        } else {
+            generateNoisy<Colors::kBlack.raw()>(dst, pos);
+        }
+    }
+
+    usize countMoves(const Position& pos) {
+        if (pos.stm() == Colors::kWhite) {
+            return countMoves<Colors::kWhite.raw()>(pos);
+        } else {
+            return countMoves<Colors::kBlack.raw()>(pos);
+        }
+    }
+
+    bool isLegal(const Position& pos, Move move) {
+        if (move.isNull()) {
+            return false;
+        }
+
+        FindSink sink{move};
+
+        if (pos.stm() == Colors::kWhite) {
+            generate<Colors::kWhite.raw(), false>(sink, pos);
+        } else {
+            generate<Colors::kBlack.raw(), false>(sink, pos);
+        }
+
+        return sink.found;
+    }
+
+    std::optional<Move> parseMove(const Position& pos, std::string_view str) {
+        if (str.length() != 4 && str.length() != 6) {
+            return {};
+        }
+
+        std::array<Cell, 3> cells{};
+
+        for (usize i = 0; i < str.length() / 2; ++i) {
+            cells[i] = Cell::fromStr(str.substr(i * 2, 2));
+
+            if (cells[i] == Cells::kNone) {
+                return {};
+            }
+        }
+
+        Move move{};
+
+        // unstacks repeat the origin, see operator<<
+        if (str.length() == 4) {
+            move = Move::makeSingle(cells[0], cells[1]);
+        } else if (cells[0] == cells[1]) {
+            move = Move::makeSingleUnstack(cells[0], cells[2]);
+        } else {
+            move = Move::makeDouble(cells[0], cells[1], cells[2]);
+        }
+
+        if (!isLegal(pos, move)) {
+            return {};
+        }
+
+        return move;
+    }
+} // namespace octachoron
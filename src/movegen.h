@@ -0,0 +1,60 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "types.h"
+
+#include <optional>
+#include <string_view>
+
+#include "move.h"
+#include "position.h"
+#include "util/static_vector.h"
+
+namespace octachoron {
+    // generous upper bound: 14 pieces, each with at most a few dozen stack/move combinations
+    constexpr usize kMaxMoves = 1024;
+
+    using MoveList = StaticVector<Move, kMaxMoves>;
+
+    // The colour-templated generators take the side to move as Color::raw(), so that goal
+    // rows and enemy masks are compile-time constants. They must match pos.stm().
+
+    template <u8 kUs>
+    void generateAll(MoveList& dst, const Position& pos);
+
+    // captures, and moves that put a non-wise piece on the goal row (and so win)
+    template <u8 kUs>
+    void generateNoisy(MoveList& dst, const Position& pos);
+
+    // counts the moves generateAll would produce, without writing them out
+    template <u8 kUs>
+    [[nodiscard]] usize countMoves(const Position& pos);
+
+    void generateAll(MoveList& dst, const Position& pos);
+    void generateNoisy(MoveList& dst, const Position& pos);
+
+    [[nodiscard]] usize countMoves(const Position& pos);
+
+    // whether generateAll would produce the move, without writing out a list
+    [[nodiscard]] bool isLegal(const Position& pos, Move move);
+
+    // the inverse of Move's operator<<, if the move is legal in pos
+    [[nodiscard]] std::optional<Move> parseMove(const Position& pos, std::string_view str);
+} // namespace octachoron
@@ -0,0 +1,68 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "../types.h"
+
+#include "../core.h"
+#include "../position.h"
+#include "../symmetry.h"
+
+namespace octachoron::nnue {
+    // Input features are (layer, piece, cell) triples, where a single piece is on the top layer
+    // and a stack puts its upper piece on the top layer and its lower piece on the bottom one.
+    // Each perspective sees the board from its own side: for black, cells are rotated and
+    // colours swapped, so "our" pieces always occupy the even piece slots and move up the board.
+    constexpr u32 kLayerCount = 2;
+    constexpr u32 kPieceCount = 8;
+
+    constexpr u32 kInputSize = kLayerCount * kPieceCount * Cells::kCount;
+
+    // every piece is exactly one feature, so this is bounded by the starting material
+    constexpr u32 kMaxActiveFeatures = 28;
+
+    [[nodiscard]] constexpr u32 featureIndex(Color perspective, Cell cell, Piece piece, bool bottom) {
+        assert(!piece.isStack());
+
+        const auto symmetry = perspective == Colors::kWhite ? Symmetry::kIdentity : Symmetry::kColorFlip;
+
+        cell = transform(cell, symmetry);
+        piece = transform(piece, symmetry);
+
+        return ((bottom ? kPieceCount : 0) + piece.idx()) * Cells::kCount + cell.idx();
+    }
+
+    // calls f with the index of every active feature from the given perspective
+    template <typename F>
+    void forEachFeature(const Position& pos, Color perspective, F&& f) {
+        auto occupied = pos.occupancyBb();
+
+        while (!occupied.empty()) {
+            const auto cell = occupied.popLowestCell();
+            const auto piece = pos.pieceOn(cell);
+
+            if (piece.isStack()) {
+                f(featureIndex(perspective, cell, piece.upper(), false));
+                f(featureIndex(perspective, cell, piece.lower(), true));
+            } else {
+                f(featureIndex(perspective, cell, piece, false));
+            }
+        }
+    }
+} // namespace octachoron::nnue
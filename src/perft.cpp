@@ -0,0 +1,92 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "perft.h"
+
+#include <chrono>
+#include <iostream>
+
+#include "movegen.h"
+
+namespace octachoron {
+    namespace {
+        template <u8 kUs>
+        u64 doPerft(const Position& pos, i32 depth) {
+            static constexpr auto kThem = Color::fromRaw(kUs).flip().raw();
+
+            if (depth <= 0) {
+                return 1;
+            }
+
+            if (pos.winner() != Colors::kNone) {
+                return 0;
+            }
+
+            if (depth == 1) {
+                return countMoves<kUs>(pos);
+            }
+
+            MoveList moves{};
+            generateAll<kUs>(moves, pos);
+
+            u64 total = 0;
+
+            for (const auto move : moves) {
+                total += doPerft<kThem>(pos.applyMove(move), depth - 1);
+            }
+
+            return total;
+        }
+    } // namespace
+
+    u64 perft(const Position& pos, i32 depth) {
+        if (pos.stm() == Colors::kWhite) {
+            return doPerft<Colors::kWhite.raw()>(pos, depth);
+        } else {
+            return doPerft<Colors::kBlack.raw()>(pos, depth);
+        }
+    }
+
+    void splitPerft(const Position& pos, i32 depth) {
+        if (depth < 1) {
+            depth = 1;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+
+        MoveList moves{};
+
+        if (pos.winner() == Colors::kNone) {
+            generateAll(moves, pos);
+        }
+
+        u64 total = 0;
+
+        for (const auto move : moves) {
+            const auto value = perft(pos.applyMove(move), depth - 1);
+            total += value;
+
+            std::cout << move << '\t' << value << '\n';
+        }
+
+        const auto time = std::chrono::duration<f64>(std::chrono::steady_clock::now() - start).count();
+        const auto nps = time > 0.0 ? static_cast<u64>(static_cast<f64>(total) / time) : 0;
+
+        std::cout << "\ntotal " << total << "\n" << nps << " nps" << std::endl;
+    }
+} // namespace octachoron
@@ -0,0 +1,346 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "policy.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "data/packed.h"
+#include "games/reader.h"
+#include "geometry.h"
+#include "util/adam.h"
+#include "util/worker_pool.h"
+
+namespace octachoron::policy {
+    namespace {
+        constexpr std::array<char, 4> kMagic = {'O', 'C', 'P', 'N'};
+        constexpr u32 kVersion = 1;
+
+        struct Header {
+            std::array<char, 4> magic;
+            u32 version;
+            u32 featureCount;
+        };
+
+        constexpr u8 kNoRole = Roles::kCount;
+
+        constexpr u16 kSingle = 0;
+        constexpr u16 kUnstack = 1;
+        constexpr u16 kDouble = 2;
+
+        // cells as seen by each side: unchanged for white, rotated for black
+        constexpr auto kRelativeCells = [] {
+            std::array<std::array<u8, Cells::kCount>, Colors::kCount> cells{};
+
+            for (u8 id = 0; id < Cells::kCount; ++id) {
+                cells[Colors::kWhite.idx()][id] = id;
+                cells[Colors::kBlack.idx()][id] = Cell::fromRaw(id).rotate().raw();
+            }
+
+            return cells;
+        }();
+
+        using Params = std::array<f64, features::kCount>;
+
+        constexpr u32 kReportInterval = 10;
+
+        struct Sample {
+            data::PackedPosition pos;
+            Move move;
+        };
+
+        struct Batch {
+            // with a slot for the padding feature, so that it needs no special case
+            std::array<f64, features::kCount + 1> gradient{};
+            f64 loss{};
+            u64 correct{};
+        };
+
+        // cross entropy of the played moves, with its gradient
+        void accumulate(Batch& batch, std::span<const Sample> samples, const Network& network) {
+            MoveList moves{};
+            FeatureBatch featureBatch{};
+            std::array<f32, kMaxMoves> logits{};
+
+            for (const auto& sample : samples) {
+                const auto pos = sample.pos.unpack();
+
+                moves.clear();
+                generateAll(moves, pos);
+
+                const auto played = static_cast<usize>(std::ranges::find(moves, sample.move) - moves.begin());
+                assert(played < moves.size());
+
+                extract(featureBatch, pos, moves);
+                network.score(featureBatch, logits);
+
+                const auto count = moves.size();
+
+                const auto best = std::max_element(logits.begin(), logits.begin() + count);
+                const auto maxLogit = *best;
+
+                f64 total = 0.0;
+
+                for (usize i = 0; i < count; ++i) {
+                    total += std::exp(static_cast<f64>(logits[i] - maxLogit));
+                }
+
+                batch.loss += std::log(total) - static_cast<f64>(logits[played] - maxLogit);
+
+                if (static_cast<usize>(best - logits.begin()) == played) {
+                    ++batch.correct;
+                }
+
+                for (usize i = 0; i < count; ++i) {
+                    const auto probability = std::exp(static_cast<f64>(logits[i] - maxLogit)) / total;
+                    const auto delta = probability - (i == played ? 1.0 : 0.0);
+
+                    for (const auto& indices : featureBatch.indices) {
+                        batch.gradient[indices[i]] += delta;
+                    }
+                }
+            }
+        }
+    } // namespace
+
+    void extract(FeatureBatch& dst, const Position& pos, std::span<const Move> moves) {
+        assert(moves.size() <= kMaxMoves);
+
+        const auto us = pos.stm();
+        const auto& relative = kRelativeCells[us.idx()];
+
+        // per cell, so that the pass over the moves is all table lookups
+        std::array<u8, Cells::kCount> ourRoles{};
+        std::array<u8, Cells::kCount> theirRoles{};
+        std::array<u8, Cells::kCount> stacks{};
+        std::array<u8, Cells::kCount> goal{};
+
+        ourRoles.fill(kNoRole);
+        theirRoles.fill(kNoRole);
+
+        auto ours = pos.colorBb(us);
+        while (!ours.empty()) {
+            const auto cell = ours.popLowestCell();
+            const auto piece = pos.pieceOn(cell);
+
+            ourRoles[cell.idx()] = static_cast<u8>(piece.role().idx());
+            stacks[cell.idx()] = piece.isStack() ? 1 : 0;
+        }
+
+        auto theirs = pos.colorBb(us.flip());
+        while (!theirs.empty()) {
+            const auto cell = theirs.popLowestCell();
+            theirRoles[cell.idx()] = static_cast<u8>(pos.pieceOn(cell).role().idx());
+        }
+
+        for (u8 id = 0; id < Cells::kCount; ++id) {
+            goal[id] = geometry::goalDistance(us, Cell::fromRaw(id)) == 0 ? 1 : 0;
+        }
+
+        dst.size = moves.size();
+
+        for (usize i = 0; i < moves.size(); ++i) {
+            const auto move = moves[i];
+
+            const auto from = move.from().idx();
+            const auto to = move.to().idx();
+
+            const auto isDouble = move.isDouble();
+            const auto dest = isDouble ? move.to2().idx() : to;
+
+            // the unit that moves keeps the role of whatever is on top at the origin
+            const auto role = ourRoles[from];
+            const auto kind = isDouble ? kDouble : move.isSingleUnstack() ? kUnstack : kSingle;
+
+            const auto victim = theirRoles[to];
+            const auto secondVictim = isDouble ? theirRoles[dest] : kNoRole;
+
+            dst.indices[0][i] = static_cast<u16>(features::kRoleFrom + role * Cells::kCount + relative[from]);
+            dst.indices[1][i] = static_cast<u16>(features::kRoleDest + role * Cells::kCount + relative[dest]);
+            dst.indices[2][i] = static_cast<u16>(features::kKind + kind * 2 + stacks[from]);
+            dst.indices[3][i] = static_cast<u16>(
+                victim != kNoRole ? features::kCapture + role * Roles::kCount + victim : features::kPadding);
+            dst.indices[4][i] = static_cast<u16>(secondVictim != kNoRole
+                                                     ? features::kCapture + role * Roles::kCount + secondVictim
+                                                     : features::kPadding);
+            dst.indices[5][i] = static_cast<u16>(
+                goal[dest] && role != Roles::kWise.idx() ? features::kGoal : features::kPadding);
+        }
+    }
+
+    bool Network::load(const std::string& path) {
+        std::ifstream stream{path, std::ios::binary};
+
+        if (!stream) {
+            std::cerr << "failed to open " << path << std::endl;
+            return false;
+        }
+
+        Header header{};
+
+        if (!stream.read(reinterpret_cast<char*>(&header), sizeof(Header)) || header.magic != kMagic) {
+            std::cerr << path << " is not a policy network" << std::endl;
+            return false;
+        }
+
+        if (header.version != kVersion || header.featureCount != features::kCount) {
+            std::cerr << path << " was written by a different version" << std::endl;
+            return false;
+        }
+
+        if (!stream.read(reinterpret_cast<char*>(m_weights.data()), features::kCount * sizeof(f32))) {
+            std::cerr << path << " is truncated" << std::endl;
+            return false;
+        }
+
+        m_weights[features::kPadding] = 0.0F;
+
+        return true;
+    }
+
+    bool Network::save(const std::string& path) const {
+        std::ofstream stream{path, std::ios::binary | std::ios::trunc};
+
+        const Header header{kMagic, kVersion, static_cast<u32>(features::kCount)};
+
+        stream.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+        stream.write(reinterpret_cast<const char*>(m_weights.data()), features::kCount * sizeof(f32));
+
+        if (!stream.flush()) {
+            std::cerr << "failed to write " << path << std::endl;
+            return false;
+        }
+
+        return true;
+    }
+
+    void Network::score(const FeatureBatch& batch, std::span<f32> dst) const {
+        assert(dst.size() >= batch.size);
+
+        const auto* weights = m_weights.data();
+        auto* logits = dst.data();
+
+        // slot by slot rather than move by move: each inner loop is a plain gather and add
+        // over the whole list, which the compiler vectorises
+        for (usize i = 0; i < batch.size; ++i) {
+            logits[i] = weights[batch.indices[0][i]];
+        }
+
+        for (usize slot = 1; slot < features::kMaxActive; ++slot) {
+            const auto* indices = batch.indices[slot].data();
+
+            for (usize i = 0; i < batch.size; ++i) {
+                logits[i] += weights[indices[i]];
+            }
+        }
+    }
+
+    bool train(const TrainConfig& config) {
+        games::GameReader reader{};
+
+        if (!reader.open(config.games)) {
+            std::cerr << "failed to open " << config.games << std::endl;
+            return false;
+        }
+
+        std::vector<Sample> samples{};
+
+        reader.read(games::ByteRange{0, reader.size()}, [&](const games::GameView& game) {
+            for (usize ply = 0; ply < game.moves.size() && samples.size() < config.maxPositions; ++ply) {
+                const auto& pos = game.positions[ply];
+
+                const auto whiteWon = game.result == data::Outcome::kWhiteWin;
+                const auto learn = game.result == data::Outcome::kDraw || whiteWon == (pos.stm() == Colors::kWhite);
+
+                if (learn) {
+                    samples.push_back({data::PackedPosition::pack(pos, 0, game.result), game.moves[ply]});
+                }
+            }
+
+            return samples.size() < config.maxPositions;
+        });
+
+        if (samples.empty()) {
+            std::cerr << "no positions" << std::endl;
+            return false;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        const auto total = static_cast<f64>(samples.size());
+
+        Network network{};
+
+        Params weights{};
+        Params gradient{};
+
+        util::Adam adam{weights.size()};
+
+        util::WorkerPool pool{config.threads};
+        std::vector<Batch> batches(pool.threadCount());
+
+        std::cout << "training on " << samples.size() << " positions" << std::endl;
+
+        for (u32 epoch = 1; epoch <= config.epochs; ++epoch) {
+            std::ranges::copy(weights, network.weights().begin());
+
+            pool.run([&](u32 idx) {
+                const auto begin = samples.size() * idx / pool.threadCount();
+                const auto end = samples.size() * (idx + 1) / pool.threadCount();
+
+                batches[idx] = Batch{};
+                accumulate(batches[idx], std::span{samples}.subspan(begin, end - begin), network);
+            });
+
+            Batch batch{};
+
+            for (const auto& threadBatch : batches) {
+                batch.loss += threadBatch.loss;
+                batch.correct += threadBatch.correct;
+
+                for (usize feature = 0; feature < features::kCount; ++feature) {
+                    batch.gradient[feature] += threadBatch.gradient[feature];
+                }
+            }
+
+            for (usize feature = 0; feature < features::kCount; ++feature) {
+                gradient[feature] = batch.gradient[feature] / total;
+            }
+
+            adam.step(weights, gradient, config.learningRate);
+
+            if (epoch % kReportInterval == 0 || epoch == 1 || epoch == config.epochs) {
+                const auto time = std::chrono::duration<f64>(std::chrono::steady_clock::now() - start).count();
+
+                std::cout << "epoch " << epoch << " loss " << std::setprecision(6) << batch.loss / total
+                          << " accuracy " << std::setprecision(4) << static_cast<f64>(batch.correct) / total
+                          << " time " << std::setprecision(3) << time << std::endl;
+            }
+        }
+
+        std::ranges::copy(weights, network.weights().begin());
+
+        return network.save(config.output);
+    }
+} // namespace octachoron::policy
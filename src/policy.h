@@ -0,0 +1,99 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "types.h"
+
+#include <array>
+#include <span>
+#include <string>
+
+#include "movegen.h"
+#include "position.h"
+
+namespace octachoron::policy {
+    // Every move activates a handful of features, seen from the mover's side: cells are
+    // rotated for black, so that both colours share weights.
+    namespace features {
+        // moving role x origin cell
+        constexpr usize kRoleFrom = 0;
+        // moving role x cell the move ends on
+        constexpr usize kRoleDest = kRoleFrom + Roles::kCount * Cells::kCount;
+        // single, unstack or double x whether a stack moves
+        constexpr usize kKind = kRoleDest + Roles::kCount * Cells::kCount;
+        // moving role x captured role, for each capture a move makes
+        constexpr usize kCapture = kKind + 3 * 2;
+        // a non-wise unit ends on the goal row
+        constexpr usize kGoal = kCapture + Roles::kCount * Roles::kCount;
+
+        constexpr usize kCount = kGoal + 1;
+
+        // role-from, role-dest, kind, two captures and goal
+        constexpr usize kMaxActive = 6;
+
+        // always zero, standing in for features a move does not have
+        constexpr usize kPadding = kCount;
+    } // namespace features
+
+    // The active features of a whole move list, one array per feature slot rather than one
+    // entry per move, so that scoring is a gather-and-add over each slot in turn.
+    struct FeatureBatch {
+        usize size{};
+        std::array<std::array<u16, kMaxMoves>, features::kMaxActive> indices{};
+    };
+
+    // pos must be the position the moves are legal in
+    void extract(FeatureBatch& dst, const Position& pos, std::span<const Move> moves);
+
+    // A linear policy: each move's logit is the sum of the weights of its features, and the
+    // prior is the softmax over the moves of a position. Trained by train().
+    class Network {
+    public:
+        bool load(const std::string& path);
+        bool save(const std::string& path) const;
+
+        // one logit per move in the batch
+        void score(const FeatureBatch& batch, std::span<f32> dst) const;
+
+        [[nodiscard]] inline std::span<f32, features::kCount> weights() {
+            return std::span<f32, features::kCount>{m_weights.data(), features::kCount};
+        }
+
+    private:
+        // with the padding weight last
+        std::array<f32, features::kCount + 1> m_weights{};
+    };
+
+    struct TrainConfig {
+        // game records, see games/record.h
+        std::string games{};
+        std::string output{};
+
+        u32 threads{1};
+        u32 epochs{200};
+        f64 learningRate{0.05};
+        // read from the start of the file
+        u64 maxPositions{1000000};
+    };
+
+    // Fits the weights to the moves played in a game file, minimising the cross entropy of the
+    // softmax over each position's legal moves. Only the winner's moves are used, and both
+    // sides' in drawn games. Full-batch Adam, split across a worker pool, sharing both with tune.h.
+    bool train(const TrainConfig& config);
+} // namespace octachoron::policy
@@ -18,6 +18,9 @@
 
 #include "position.h"
 
+#include <algorithm>
+#include <tuple>
+
 #include "util/parse.h"
 #include "util/split.h"
 
@@ -64,6 +67,7 @@ namespace octachoron {
         }
 
         newPos.m_whiteToMove = !newPos.m_whiteToMove;
+        newPos.m_key ^= keys::stm();
 
         return newPos;
     }
@@ -84,7 +88,7 @@ namespace octachoron {
         u8 cellIdx = 0;
 
         for (i32 rowIdx = 6; rowIdx >= 0; --rowIdx) {
-            const auto columnCount = 6 + (rowIdx & 1);
+            const auto columnCount = static_cast<usize>(6 + (rowIdx & 1));
 
             auto& row = rows[rowIdx];
             usize columnIdx = 0;
@@ -122,6 +126,8 @@ namespace octachoron {
         m_roles = {};
         m_stacks = Bitboards::kEmpty;
 
+        m_key = 0;
+
         for (cellIdx = 0; cellIdx < Cells::kCount; ++cellIdx) {
             const auto cell = Cell::fromRaw(cellIdx);
             if (const auto piece = m_mailbox[cellIdx]; piece != Pieces::kNone) {
@@ -137,6 +143,10 @@ namespace octachoron {
             return false;
         }
 
+        if (!m_whiteToMove) {
+            m_key ^= keys::stm();
+        }
+
         if (!util::tryParse(m_halfmoves, fen[2]) || !util::tryParse(m_fullmoves, fen[3])) {
             return false;
         }
@@ -161,6 +171,86 @@ namespace octachoron {
         return resetFromFenParts(views);
     }
 
+    std::string Position::toFen() const {
+        constexpr auto kRoleChar = [](Piece piece) {
+            constexpr std::array kChars = {'w', 'r', 'p', 's'};
+            const auto c = kChars[piece.role().idx()];
+            return piece.color() == Colors::kWhite ? static_cast<char>(c - 'a' + 'A') : c;
+        };
+
+        std::string fen{};
+
+        for (i32 row = 6; row >= 0; --row) {
+            u32 empty = 0;
+
+            for (u32 column = 0; column < Cell::rowLength(row); ++column) {
+                const auto piece = pieceOn(Cell::fromCoords(row, column));
+
+                if (piece == Pieces::kNone) {
+                    ++empty;
+                    continue;
+                }
+
+                if (empty > 0) {
+                    fen += static_cast<char>('0' + empty);
+                    empty = 0;
+                }
+
+                if (piece.isStack()) {
+                    fen += kRoleChar(piece.lower());
+                    fen += kRoleChar(piece.upper());
+                } else {
+                    fen += kRoleChar(piece);
+                    fen += '-';
+                }
+            }
+
+            if (empty > 0) {
+                fen += static_cast<char>('0' + empty);
+            }
+
+            if (row > 0) {
+                fen += '/';
+            }
+        }
+
+        fen += m_whiteToMove ? " w " : " b ";
+        fen += std::to_string(m_halfmoves);
+        fen += ' ';
+        fen += std::to_string(m_fullmoves);
+
+        return fen;
+    }
+
+    Position Position::fromMailbox(
+        std::span<const Piece, Cells::kCount> mailbox, Color stm, u32 halfmoves, u32 fullmoves) {
+        assert(stm != Colors::kNone);
+
+        Position pos{};
+
+        for (u8 cellIdx = 0; cellIdx < Cells::kCount; ++cellIdx) {
+            const auto piece = mailbox[cellIdx];
+
+            if (piece == Pieces::kNone) {
+                continue;
+            }
+
+            pos.m_mailbox[cellIdx] = piece;
+            pos.flipCells(piece, Bitboard::fromCell(Cell::fromRaw(cellIdx)));
+        }
+
+        pos.m_whiteToMove = stm == Colors::kWhite;
+
+        if (!pos.m_whiteToMove) {
+            pos.m_key ^= keys::stm();
+        }
+
+        pos.m_halfmoves = static_cast<u8>(halfmoves);
+        pos.m_fullmoves = static_cast<u16>(fullmoves);
+
+        return pos;
+    }
+
     Piece Position::addPiece(Piece piece, Cell cell) {
         assert(piece != Pieces::kNone);
         assert(cell != Cells::kNone);
@@ -233,6 +323,8 @@ namespace octachoron {
 
         m_stacks ^= mask;
 
+        m_key ^= keys::pieceCell(lower, cell) ^ keys::pieceCell(stacked, cell);
+
         m_mailbox[cell.idx()] = stacked;
 
         return stacked;
@@ -278,5 +370,111 @@ namespace octachoron {
         if (piece.isStack()) {
             m_stacks ^= mask;
         }
+
+        while (!mask.empty()) {
+            m_key ^= keys::pieceCell(piece, mask.popLowestCell());
+        }
+    }
+
+    Position Position::transformed(Symmetry symmetry) const {
+        if (symmetry == Symmetry::kIdentity) {
+            return *this;
+        }
+
+        Position pos{};
+
+        for (u8 cellIdx = 0; cellIdx < Cells::kCount; ++cellIdx) {
+            const auto piece = m_mailbox[cellIdx];
+
+            if (piece == Pieces::kNone) {
+                continue;
+            }
+
+            const auto cell = transform(Cell::fromRaw(cellIdx), symmetry);
+            const auto newPiece = transform(piece, symmetry);
+
+            pos.m_mailbox[cell.idx()] = newPiece;
+            pos.flipCells(newPiece, Bitboard::fromCell(cell));
+        }
+
+        pos.m_whiteToMove = flipsColor(symmetry) ? !m_whiteToMove : m_whiteToMove;
+
+        if (!pos.m_whiteToMove) {
+            pos.m_key ^= keys::stm();
+        }
+
+        pos.m_halfmoves = m_halfmoves;
+        pos.m_fullmoves = m_fullmoves;
+
+        return pos;
+    }
+
+    std::array<u64, kSymmetryCount> Position::symmetricKeys() const {
+        std::array<u64, kSymmetryCount> result{};
+
+        auto occupied = occupancyBb();
+        while (!occupied.empty()) {
+            const auto cell = occupied.popLowestCell();
+            const auto piece = m_mailbox[cell.idx()];
+
+            for (const auto symmetry : kSymmetries) {
+                result[static_cast<usize>(symmetry)] ^=
+                    keys::pieceCell(transform(piece, symmetry), transform(cell, symmetry));
+            }
+        }
+
+        for (const auto symmetry : kSymmetries) {
+            if (m_whiteToMove == flipsColor(symmetry)) {
+                result[static_cast<usize>(symmetry)] ^= keys::stm();
+            }
+        }
+
+        return result;
+    }
+
+    Symmetry Position::canonicalSymmetry() const {
+        const auto keys = symmetricKeys();
+
+        usize best = 0;
+
+        for (usize i = 1; i < kSymmetryCount; ++i) {
+            if (keys[i] < keys[best]) {
+                best = i;
+            }
+        }
+
+        return static_cast<Symmetry>(best);
+    }
+
+    u64 Position::canonicalKey() const {
+        const auto keys = symmetricKeys();
+        return *std::ranges::min_element(keys);
+    }
+
+    Position Position::withCells(std::span<const std::pair<Cell, Piece>> cells, Color stm) const {
+        assert(stm != Colors::kNone);
+
+        auto pos = *this;
+
+        for (const auto& [cell, piece] : cells) {
+            const auto mask = Bitboard::fromCell(cell);
+
+            if (const auto previous = pos.m_mailbox[cell.idx()]; previous != Pieces::kNone) {
+                pos.flipCells(previous, mask);
+            }
+
+            if (piece != Pieces::kNone) {
+                pos.flipCells(piece, mask);
+            }
+
+            pos.m_mailbox[cell.idx()] = piece;
+        }
+
+        if (pos.m_whiteToMove != (stm == Colors::kWhite)) {
+            pos.m_whiteToMove = !pos.m_whiteToMove;
+            pos.m_key ^= keys::stm();
+        }
+
+        return pos;
     }
 } // namespace octachoron
@@ -23,13 +23,20 @@
 #include <array>
 #include <iostream>
 #include <span>
+#include <string>
 #include <string_view>
 #include <utility>
 
 #include "bitboard.h"
+#include "keys.h"
 #include "move.h"
+#include "symmetry.h"
 
 namespace octachoron {
+    namespace microbench {
+        struct PositionAccess;
+    } // namespace microbench
+
     class Position {
     public:
         constexpr Position() {
@@ -61,6 +68,28 @@ namespace octachoron {
             return m_roles[role.idx()];
         }
 
+        [[nodiscard]] Bitboard stackBb() const {
+            return m_stacks;
+        }
+
+        [[nodiscard]] Bitboard occupancyBb() const {
+            return m_colors[0] | m_colors[1];
+        }
+
+        // Returns the colour that has moved a non-wise piece or stack onto its goal row, if any.
+        // Only the role on top of a stack counts, and a wise can only be stacked on another wise.
+        [[nodiscard]] Color winner() const {
+            const auto nonWise = ~roleBb(Roles::kWise);
+
+            if (!(colorBb(Colors::kWhite) & nonWise & Bitboards::kRowG).empty()) {
+                return Colors::kWhite;
+            } else if (!(colorBb(Colors::kBlack) & nonWise & Bitboards::kRowA).empty()) {
+                return Colors::kBlack;
+            }
+
+            return Colors::kNone;
+        }
+
         [[nodiscard]] Piece pieceOn(Cell cell) const {
             assert(cell != Cells::kNone);
             return m_mailbox[cell.idx()];
@@ -70,6 +99,31 @@ namespace octachoron {
             return m_whiteToMove ? Colors::kWhite : Colors::kBlack;
         }
 
+        [[nodiscard]] u64 key() const {
+            return m_key;
+        }
+
+        // The same position seen through a symmetry of the board. Move counters are kept as is.
+        [[nodiscard]] Position transformed(Symmetry symmetry) const;
+
+        // The symmetry that maps this position to the representative of its class: the equivalent
+        // position with the lowest key. Lower symmetries win ties, so the choice is deterministic.
+        [[nodiscard]] Symmetry canonicalSymmetry() const;
+
+        [[nodiscard]] Position canonical() const {
+            return transformed(canonicalSymmetry());
+        }
+
+        // identical for all positions equivalent under symmetry, without building any of them
+        [[nodiscard]] u64 canonicalKey() const;
+
+        // -> keys of this position under each symmetry, indexed by Symmetry
+        [[nodiscard]] std::array<u64, kSymmetryCount> symmetricKeys() const;
+
+        // A copy with each listed cell, in order, holding the given piece or emptied for kNone, and
+        // the given side to move. Nothing is checked, for building the positions a move came from.
+        [[nodiscard]] Position withCells(std::span<const std::pair<Cell, Piece>> cells, Color stm) const;
+
         [[nodiscard]] u32 halfmoves() const {
             return m_halfmoves;
         }
@@ -82,18 +136,20 @@ namespace octachoron {
         bool resetFromFenParts(std::span<std::string_view> fen);
         bool resetFromFen(std::string_view fen);
 
+        [[nodiscard]] std::string toFen() const;
+
         [[nodiscard]] constexpr bool operator==(const Position&) const = default;
 
         constexpr Position& operator=(const Position&) = default;
         constexpr Position& operator=(Position&&) = default;
 
-        [[nodiscard]] static constexpr Position startpos() {
+        [[nodiscard]] static Position startpos() {
             Position pos{};
             pos.resetToStartpos();
             return pos;
         }
 
-        [[nodiscard]] static constexpr std::optional<Position> fromFenParts(std::span<std::string_view> fen) {
+        [[nodiscard]] static std::optional<Position> fromFenParts(std::span<std::string_view> fen) {
             Position pos{};
 
             if (pos.resetFromFenParts(fen)) {
@@ -103,7 +159,7 @@ namespace octachoron {
             }
         }
 
-        [[nodiscard]] static constexpr std::optional<Position> fromFen(std::string_view fen) {
+        [[nodiscard]] static std::optional<Position> fromFen(std::string_view fen) {
             Position pos{};
 
             if (pos.resetFromFen(fen)) {
@@ -113,6 +169,10 @@ namespace octachoron {
             }
         }
 
+        // builds a position directly from a cell -> piece table
+        [[nodiscard]] static Position fromMailbox(std::span<const Piece, Cells::kCount> mailbox, Color stm,
+            u32 halfmoves = 0, u32 fullmoves = 1);
+
     private:
         std::array<Bitboard, Colors::kCount> m_colors{};
         std::array<Bitboard, PieceTypes::kCount> m_pieces{};
@@ -121,6 +181,8 @@ namespace octachoron {
 
         std::array<Piece, Cells::kCount> m_mailbox{};
 
+        u64 m_key{};
+
         bool m_whiteToMove{true};
 
         u8 m_halfmoves{};
@@ -140,6 +202,9 @@ namespace octachoron {
 
         void flipCells(Piece piece, Bitboard mask);
 
+        // bench only, so that flipCells and addStack can be timed on their own
+        friend struct microbench::PositionAccess;
+
         friend inline std::ostream& operator<<(std::ostream& stream, const Position& pos) {
             const auto printSixLine = [&](Cell firstCell) {
                 for (u8 offset = 0; offset < 6; ++offset) {
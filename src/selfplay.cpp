@@ -0,0 +1,120 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "selfplay.h"
+
+#include "movegen.h"
+
+namespace octachoron::selfplay {
+    bool isOver(const Position& pos) {
+        return winner(pos) != Colors::kNone;
+    }
+
+    Color winner(const Position& pos) {
+        if (const auto winner = pos.winner(); winner != Colors::kNone) {
+            return winner;
+        }
+
+        if (countMoves(pos) == 0) {
+            return pos.stm().flip();
+        }
+
+        return Colors::kNone;
+    }
+
+    Position randomOpening(util::rng::Jsf64Rng& rng, u32 plies, const book::Book* book) {
+        // books are shallow, this only guards against cycles
+        constexpr u32 kMaxBookPlies = 256;
+
+        while (true) {
+            auto pos = Position::startpos();
+
+            for (u32 ply = 0; book && ply < kMaxBookPlies && !isOver(pos); ++ply) {
+                const auto move = book->pick(pos, rng);
+
+                if (move.isNull()) {
+                    break;
+                }
+
+                pos = pos.applyMove(move);
+            }
+
+            for (u32 ply = 0; ply < plies && !isOver(pos); ++ply) {
+                MoveList moves{};
+                generateAll(moves, pos);
+
+                pos = pos.applyMove(moves[rng.nextU32(static_cast<u32>(moves.size()))]);
+            }
+
+            if (!isOver(pos)) {
+                return pos;
+            }
+        }
+    }
+
+    data::Outcome playGame(const Position& start, const std::array<Player, 2>& players, u32 maxPlies,
+        const tb::Tablebases* tablebases, std::vector<Move>* moves) {
+        const auto outcome = [](Color winner) {
+            return winner == Colors::kWhite ? data::Outcome::kWhiteWin : data::Outcome::kBlackWin;
+        };
+
+        for (const auto& player : players) {
+            player.searcher->newGame();
+        }
+
+        if (moves) {
+            moves->clear();
+        }
+
+        auto pos = start;
+
+        for (u32 ply = 0; ply < maxPlies; ++ply) {
+            if (const auto result = winner(pos); result != Colors::kNone) {
+                return outcome(result);
+            }
+
+            if (tablebases) {
+                if (const auto result = tablebases->probe(pos)) {
+                    switch (result->wdl) {
+                        case tb::Wdl::kWin:
+                            return outcome(pos.stm());
+                        case tb::Wdl::kDraw:
+                            return data::Outcome::kDraw;
+                        case tb::Wdl::kLoss:
+                            return outcome(pos.stm().flip());
+                    }
+                }
+            }
+
+            const auto& player = players[pos.stm().idx()];
+            const auto info = player.searcher->search(pos, player.limits);
+
+            if (moves) {
+                moves->push_back(info.bestMove);
+            }
+
+            pos = pos.applyMove(info.bestMove);
+        }
+
+        if (const auto result = winner(pos); result != Colors::kNone) {
+            return outcome(result);
+        }
+
+        return data::Outcome::kDraw;
+    }
+} // namespace octachoron::selfplay
@@ -0,0 +1,55 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "types.h"
+
+#include <array>
+#include <vector>
+
+#include "book/book.h"
+#include "data/packed.h"
+#include "mcts/search.h"
+#include "position.h"
+#include "tb/tablebase.h"
+#include "util/rng.h"
+
+namespace octachoron::selfplay {
+    // someone has won, or the side to move has no moves and so has lost
+    [[nodiscard]] bool isOver(const Position& pos);
+
+    // -> kNone if the game goes on
+    [[nodiscard]] Color winner(const Position& pos);
+
+    // Startpos followed by weighted book moves for as long as the book has any, if there is
+    // one, and then by uniformly random legal moves. Never a finished game.
+    [[nodiscard]] Position randomOpening(util::rng::Jsf64Rng& rng, u32 plies, const book::Book* book = nullptr);
+
+    struct Player {
+        mcts::Searcher* searcher;
+        // every move
+        mcts::SearchLimits limits;
+    };
+
+    // Plays a game from start between two players, indexed by colour. Games reaching maxPlies
+    // are drawn, and with tablebases, positions they cover are adjudicated. The moves played
+    // are stored in moves if given.
+    [[nodiscard]] data::Outcome playGame(const Position& start, const std::array<Player, 2>& players, u32 maxPlies,
+        const tb::Tablebases* tablebases = nullptr, std::vector<Move>* moves = nullptr);
+} // namespace octachoron::selfplay
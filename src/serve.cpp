@@ -0,0 +1,764 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "serve.h"
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <csignal>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "mcts/search.h"
+#include "movegen.h"
+#include "position.h"
+#include "selfplay.h"
+#include "util/latency_histogram.h"
+#include "util/parse.h"
+#include "util/split.h"
+
+namespace octachoron::serve {
+    namespace {
+        // epoll tags of the fds that are not clients. clients get increasing tags rather than
+        // their fds, so that an event for a closed client is never mistaken for a newer one
+        constexpr u64 kListenTag = 0;
+        constexpr u64 kWakeTag = 1;
+        constexpr u64 kSignalTag = 2;
+        constexpr u64 kFirstClientTag = 3;
+
+        constexpr i32 kBacklog = 64;
+        constexpr usize kMaxEvents = 64;
+        constexpr usize kReadSize = 4096;
+
+        // requests are short, so anything longer is a confused client
+        constexpr usize kMaxLineLength = 4096;
+        // a client that lets this much output pile up without reading it is dropped
+        constexpr usize kMaxPendingOutput = 1 << 20;
+
+        constexpr usize kFenFields = 4;
+
+        struct Job {
+            u64 client;
+            std::string id;
+
+            Position pos;
+            mcts::SearchLimits limits;
+
+            std::atomic<bool> cancelled{};
+
+            std::chrono::steady_clock::time_point received;
+
+            // written by the worker
+            std::string reply{};
+        };
+
+        using JobPtr = std::shared_ptr<Job>;
+
+        // searches take milliseconds each, so a plain locked queue is plenty
+        class JobQueue {
+        public:
+            void push(JobPtr job) {
+                {
+                    const std::scoped_lock lock{m_mutex};
+                    m_jobs.push_back(std::move(job));
+                }
+
+                m_signal.notify_one();
+            }
+
+            // blocks until there is a job. nullptr once closed
+            [[nodiscard]] JobPtr pop() {
+                std::unique_lock lock{m_mutex};
+                m_signal.wait(lock, [this] { return m_closed || !m_jobs.empty(); });
+
+                if (m_closed) {
+                    return nullptr;
+                }
+
+                auto job = std::move(m_jobs.front());
+                m_jobs.pop_front();
+
+                return job;
+            }
+
+            [[nodiscard]] usize size() {
+                const std::scoped_lock lock{m_mutex};
+                return m_jobs.size();
+            }
+
+            void close() {
+                {
+                    const std::scoped_lock lock{m_mutex};
+                    m_closed = true;
+                }
+
+                m_signal.notify_all();
+            }
+
+        private:
+            std::mutex m_mutex{};
+            std::condition_variable m_signal{};
+
+            std::deque<JobPtr> m_jobs{};
+            bool m_closed{};
+        };
+
+        struct Client {
+            i32 fd;
+
+            std::string input{};
+            std::string output{};
+
+            // requests in flight, by id
+            std::unordered_map<std::string, JobPtr> jobs{};
+
+            // the client has shut down its end, and is closed once its replies are written
+            bool eof{};
+            u32 events{};
+        };
+
+        [[nodiscard]] std::string searchJob(mcts::Searcher& searcher, Job& job) {
+            if (job.cancelled.load(std::memory_order::relaxed)) {
+                return "cancelled " + job.id;
+            }
+
+            // requests have nothing to do with each other
+            searcher.newGame();
+
+            const auto info = searcher.search(job.pos, job.limits);
+
+            std::ostringstream reply{};
+
+            reply << "result " << job.id << " bestmove " << info.bestMove << " value " << info.value << " playouts "
+                  << info.playouts << " time " << static_cast<u64>(info.timeSec * 1000.0);
+
+            if (job.cancelled.load(std::memory_order::relaxed)) {
+                reply << " cancelled";
+            }
+
+            reply << " pv";
+
+            for (const auto move : info.pv) {
+                reply << ' ' << move;
+            }
+
+            return reply.str();
+        }
+
+        class Server {
+        public:
+            explicit Server(const Config& config) :
+                    m_config{config} {}
+
+            ~Server() {
+                for (const auto fd : {m_listenFd, m_epollFd, m_wakeFd, m_signalFd}) {
+                    if (fd >= 0) {
+                        ::close(fd);
+                    }
+                }
+            }
+
+            bool open();
+            void serve();
+
+        private:
+            Config m_config;
+
+            i32 m_listenFd{-1};
+            i32 m_epollFd{-1};
+            i32 m_wakeFd{-1};
+            i32 m_signalFd{-1};
+
+            std::unordered_map<u64, Client> m_clients{};
+            u64 m_nextTag{kFirstClientTag};
+
+            JobQueue m_queue{};
+
+            std::mutex m_doneMutex{};
+            std::vector<JobPtr> m_done{};
+
+            // outlives the searchers, which may still be submitting to it until they are joined
+            telemetry::JsonLinesWriter m_telemetry{};
+
+            std::vector<std::unique_ptr<mcts::Searcher>> m_searchers{};
+            std::vector<std::thread> m_workers{};
+
+            util::LatencyHistogram m_latencies{};
+
+            bool watch(i32 fd, u64 tag);
+
+            void work(mcts::Searcher& searcher);
+
+            void acceptClients();
+            void handleClient(u64 tag, u32 events);
+            void deliverReplies();
+
+            // -> false if the client should be dropped
+            bool readRequests(u64 tag, Client& client);
+            void handleRequest(u64 tag, Client& client, std::string_view line);
+
+            void analyse(u64 tag, Client& client, const std::vector<std::string>& tokens);
+            void cancel(Client& client, const std::vector<std::string>& tokens);
+            void stats(Client& client);
+
+            // writes what it can, registers for the rest, and closes the client if it is done
+            void update(u64 tag);
+            void closeClient(u64 tag);
+
+            void shutdown();
+        };
+
+        void reply(Client& client, std::string_view line) {
+            client.output += line;
+            client.output += '\n';
+        }
+
+        // -> false on a write error
+        bool flush(Client& client) {
+            usize written = 0;
+
+            while (written < client.output.size()) {
+                const auto result = ::send(
+                    client.fd, client.output.data() + written, client.output.size() - written, MSG_NOSIGNAL);
+
+                if (result > 0) {
+                    written += static_cast<usize>(result);
+                } else if (errno == EINTR) {
+                    continue;
+                } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                    break;
+                } else {
+                    return false;
+                }
+            }
+
+            client.output.erase(0, written);
+            return true;
+        }
+
+        bool Server::watch(i32 fd, u64 tag) {
+            epoll_event event{};
+            event.events = EPOLLIN;
+            event.data.u64 = tag;
+
+            return ::epoll_ctl(m_epollFd, EPOLL_CTL_ADD, fd, &event) == 0;
+        }
+
+        bool Server::open() {
+            const auto& path = m_config.socketPath;
+
+            sockaddr_un address{};
+            address.sun_family = AF_UNIX;
+
+            if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+                std::cerr << "invalid socket path " << path << std::endl;
+                return false;
+            }
+
+            std::memcpy(address.sun_path, path.c_str(), path.size());
+
+            // signals are taken through a signalfd, so they must be blocked before any worker
+            // starts, since threads inherit the mask
+            sigset_t signals{};
+            sigemptyset(&signals);
+            sigaddset(&signals, SIGINT);
+            sigaddset(&signals, SIGTERM);
+
+            pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+            m_signalFd = ::signalfd(-1, &signals, SFD_NONBLOCK | SFD_CLOEXEC);
+            m_wakeFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            m_epollFd = ::epoll_create1(EPOLL_CLOEXEC);
+
+            if (m_signalFd < 0 || m_wakeFd < 0 || m_epollFd < 0) {
+                std::cerr << "failed to set up event loop: " << std::strerror(errno) << std::endl;
+                return false;
+            }
+
+            // a socket left behind by a previous server that did not shut down cleanly.
+            // anything else at the path is left alone, and bind fails
+            if (struct stat info{}; ::stat(path.c_str(), &info) == 0 && S_ISSOCK(info.st_mode)) {
+                ::unlink(path.c_str());
+            }
+
+            m_listenFd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+
+            if (m_listenFd < 0 || ::bind(m_listenFd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0
+                || ::listen(m_listenFd, kBacklog) != 0) {
+                std::cerr << "failed to listen on " << path << ": " << std::strerror(errno) << std::endl;
+                return false;
+            }
+
+            if (!watch(m_listenFd, kListenTag) || !watch(m_wakeFd, kWakeTag) || !watch(m_signalFd, kSignalTag)) {
+                std::cerr << "failed to set up event loop: " << std::strerror(errno) << std::endl;
+                return false;
+            }
+
+            if (!m_config.telemetry.empty() && !m_telemetry.open(m_config.telemetry)) {
+                std::cerr << "failed to open telemetry target " << m_config.telemetry << std::endl;
+                return false;
+            }
+
+            for (u32 i = 0; i < m_config.workers; ++i) {
+                m_searchers.push_back(std::make_unique<mcts::Searcher>(m_config.treeMb, 1));
+
+                if (m_telemetry.isOpen()) {
+                    m_searchers.back()->setTelemetry(&m_telemetry);
+                }
+            }
+
+            for (auto& searcher : m_searchers) {
+                m_workers.emplace_back([this, searcher = searcher.get()] { work(*searcher); });
+            }
+
+            return true;
+        }
+
+        void Server::serve() {
+            std::cout << "listening on " << m_config.socketPath << " with " << m_config.workers << " workers"
+                      << std::endl;
+
+            std::array<epoll_event, kMaxEvents> events{};
+
+            bool stopping = false;
+
+            while (!stopping) {
+                const auto count = ::epoll_wait(m_epollFd, events.data(), static_cast<i32>(events.size()), -1);
+
+                if (count < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+
+                    std::cerr << "epoll_wait failed: " << std::strerror(errno) << std::endl;
+                    break;
+                }
+
+                for (i32 i = 0; i < count; ++i) {
+                    const auto& event = events[i];
+
+                    switch (event.data.u64) {
+                        case kListenTag:
+                            acceptClients();
+                            break;
+                        case kWakeTag:
+                            deliverReplies();
+                            break;
+                        case kSignalTag:
+                            stopping = true;
+                            break;
+                        default:
+                            handleClient(event.data.u64, event.events);
+                            break;
+                    }
+                }
+            }
+
+            shutdown();
+        }
+
+        void Server::work(mcts::Searcher& searcher) {
+            while (const auto job = m_queue.pop()) {
+                job->reply = searchJob(searcher, *job);
+
+                {
+                    const std::scoped_lock lock{m_doneMutex};
+                    m_done.push_back(job);
+                }
+
+                const u64 one = 1;
+                [[maybe_unused]] const auto written = ::write(m_wakeFd, &one, sizeof(one));
+            }
+        }
+
+        void Server::acceptClients() {
+            while (true) {
+                const auto fd = ::accept4(m_listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+
+                if (fd < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+
+                    if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                        std::cerr << "accept failed: " << std::strerror(errno) << std::endl;
+                    }
+
+                    return;
+                }
+
+                const auto tag = m_nextTag++;
+
+                if (!watch(fd, tag)) {
+                    std::cerr << "failed to watch client: " << std::strerror(errno) << std::endl;
+                    ::close(fd);
+                    continue;
+                }
+
+                m_clients.emplace(tag, Client{.fd = fd, .events = EPOLLIN});
+            }
+        }
+
+        void Server::handleClient(u64 tag, u32 events) {
+            const auto it = m_clients.find(tag);
+
+            if (it == m_clients.end()) {
+                return;
+            }
+
+            auto& client = it->second;
+
+            if ((events & (EPOLLERR | EPOLLHUP)) != 0) {
+                closeClient(tag);
+                return;
+            }
+
+            if ((events & EPOLLIN) != 0 && !readRequests(tag, client)) {
+                flush(client);
+                closeClient(tag);
+                return;
+            }
+
+            update(tag);
+        }
+
+        bool Server::readRequests(u64 tag, Client& client) {
+            std::array<char, kReadSize> buffer{};
+
+            while (!client.eof) {
+                const auto result = ::read(client.fd, buffer.data(), buffer.size());
+
+                if (result < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+
+                    if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                        break;
+                    }
+
+                    return false;
+                }
+
+                if (result == 0) {
+                    client.eof = true;
+
+                    // a last request without a newline
+                    if (!client.input.empty()) {
+                        client.input += '\n';
+                    }
+                } else {
+                    client.input.append(buffer.data(), static_cast<usize>(result));
+                }
+
+                usize start = 0;
+
+                for (auto end = client.input.find('\n'); end != std::string::npos;
+                    end = client.input.find('\n', start)) {
+                    auto line = std::string_view{client.input}.substr(start, end - start);
+
+                    if (line.ends_with('\r')) {
+                        line.remove_suffix(1);
+                    }
+
+                    handleRequest(tag, client, line);
+                    start = end + 1;
+                }
+
+                client.input.erase(0, start);
+
+                if (client.input.size() > kMaxLineLength) {
+                    reply(client, "error - line too long");
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        void Server::handleRequest(u64 tag, Client& client, std::string_view line) {
+            const auto tokens = util::split(line, ' ');
+
+            if (tokens.empty()) {
+                return;
+            }
+
+            const auto& command = tokens[0];
+
+            if (command == "analyse") {
+                analyse(tag, client, tokens);
+            } else if (command == "cancel") {
+                cancel(client, tokens);
+            } else if (command == "stats") {
+                stats(client);
+            } else {
+                reply(client, "error - unknown command " + command);
+            }
+        }
+
+        void Server::analyse(u64 tag, Client& client, const std::vector<std::string>& tokens) {
+            if (tokens.size() < 2) {
+                reply(client, "error - missing id");
+                return;
+            }
+
+            const auto& id = tokens[1];
+
+            const auto fail = [&](const std::string& reason) { reply(client, "error " + id + " " + reason); };
+
+            if (client.jobs.contains(id)) {
+                fail("duplicate id");
+                return;
+            }
+
+            auto pos = Position::startpos();
+
+            u64 playouts{};
+            i64 movetime{};
+
+            for (usize idx = 2; idx < tokens.size();) {
+                const auto& option = tokens[idx];
+
+                if (option == "playouts" && idx + 1 < tokens.size()) {
+                    if (!util::tryParse(playouts, tokens[idx + 1]) || playouts == 0) {
+                        fail("invalid playouts");
+                        return;
+                    }
+
+                    idx += 2;
+                } else if (option == "movetime" && idx + 1 < tokens.size()) {
+                    if (!util::tryParse(movetime, tokens[idx + 1]) || movetime <= 0) {
+                        fail("invalid movetime");
+                        return;
+                    }
+
+                    idx += 2;
+                } else if (option == "fen" && idx + kFenFields < tokens.size()) {
+                    std::string fen{};
+
+                    for (usize field = 1; field <= kFenFields; ++field) {
+                        fen += tokens[idx + field];
+                        fen += ' ';
+                    }
+
+                    fen.pop_back();
+
+                    if (!pos.resetFromFen(fen)) {
+                        fail("invalid fen");
+                        return;
+                    }
+
+                    idx += kFenFields + 1;
+                } else if (option == "moves") {
+                    for (++idx; idx < tokens.size(); ++idx) {
+                        const auto move = parseMove(pos, tokens[idx]);
+
+                        if (!move || selfplay::winner(pos) != Colors::kNone) {
+                            fail("illegal move " + tokens[idx]);
+                            return;
+                        }
+
+                        pos = pos.applyMove(*move);
+                    }
+                } else {
+                    fail("invalid option " + option);
+                    return;
+                }
+            }
+
+            if (selfplay::winner(pos) != Colors::kNone) {
+                fail("game over");
+                return;
+            }
+
+            if (m_queue.size() >= m_config.maxQueued) {
+                fail("busy");
+                return;
+            }
+
+            auto job = std::make_shared<Job>();
+
+            job->client = tag;
+            job->id = id;
+            job->pos = pos;
+            job->received = std::chrono::steady_clock::now();
+
+            // a playout budget on its own still gets the time cap, in case it is far too large
+            const auto maxTime = movetime > 0 ? std::chrono::milliseconds{movetime}
+                               : playouts > 0 ? m_config.maxMovetime
+                                              : m_config.defaultMovetime;
+
+            job->limits.maxTime = std::min(maxTime, m_config.maxMovetime);
+            job->limits.maxPlayouts = playouts;
+            job->limits.cancel = &job->cancelled;
+
+            if (m_config.maxPlayouts > 0 && (playouts == 0 || playouts > m_config.maxPlayouts)) {
+                job->limits.maxPlayouts = m_config.maxPlayouts;
+            }
+
+            client.jobs.emplace(id, job);
+            m_queue.push(std::move(job));
+        }
+
+        void Server::cancel(Client& client, const std::vector<std::string>& tokens) {
+            if (tokens.size() != 2) {
+                reply(client, "error - expected cancel <id>");
+                return;
+            }
+
+            const auto it = client.jobs.find(tokens[1]);
+
+            if (it == client.jobs.end()) {
+                reply(client, "error " + tokens[1] + " unknown id");
+                return;
+            }
+
+            it->second->cancelled.store(true, std::memory_order::relaxed);
+        }
+
+        void Server::stats(Client& client) {
+            std::ostringstream line{};
+
+            line << "stats requests " << m_latencies.count() << " queued " << m_queue.size() << " p50 "
+                 << m_latencies.percentile(50.0) << " p90 " << m_latencies.percentile(90.0) << " p99 "
+                 << m_latencies.percentile(99.0) << " max " << m_latencies.max();
+
+            reply(client, line.str());
+        }
+
+        void Server::deliverReplies() {
+            u64 count{};
+            [[maybe_unused]] const auto drained = ::read(m_wakeFd, &count, sizeof(count));
+
+            std::vector<JobPtr> done{};
+
+            {
+                const std::scoped_lock lock{m_doneMutex};
+                std::swap(done, m_done);
+            }
+
+            const auto now = std::chrono::steady_clock::now();
+
+            for (const auto& job : done) {
+                const auto latency = std::chrono::duration_cast<std::chrono::microseconds>(now - job->received);
+                m_latencies.record(static_cast<u64>(latency.count()));
+
+                // the client may have gone away since
+                const auto it = m_clients.find(job->client);
+
+                if (it == m_clients.end()) {
+                    continue;
+                }
+
+                it->second.jobs.erase(job->id);
+                reply(it->second, job->reply);
+
+                update(job->client);
+            }
+        }
+
+        void Server::update(u64 tag) {
+            auto& client = m_clients.at(tag);
+
+            if (!flush(client) || client.output.size() > kMaxPendingOutput) {
+                closeClient(tag);
+                return;
+            }
+
+            if (client.eof && client.jobs.empty() && client.output.empty()) {
+                closeClient(tag);
+                return;
+            }
+
+            const u32 events = (client.eof ? 0U : static_cast<u32>(EPOLLIN))
+                             | (client.output.empty() ? 0U : static_cast<u32>(EPOLLOUT));
+
+            if (events != client.events) {
+                epoll_event event{};
+                event.events = events;
+                event.data.u64 = tag;
+
+                ::epoll_ctl(m_epollFd, EPOLL_CTL_MOD, client.fd, &event);
+                client.events = events;
+            }
+        }
+
+        void Server::closeClient(u64 tag) {
+            const auto it = m_clients.find(tag);
+            assert(it != m_clients.end());
+
+            auto& client = it->second;
+
+            // nobody is left to read the results
+            for (const auto& [id, job] : client.jobs) {
+                job->cancelled.store(true, std::memory_order::relaxed);
+            }
+
+            ::epoll_ctl(m_epollFd, EPOLL_CTL_DEL, client.fd, nullptr);
+            ::close(client.fd);
+
+            m_clients.erase(it);
+        }
+
+        void Server::shutdown() {
+            while (!m_clients.empty()) {
+                closeClient(m_clients.begin()->first);
+            }
+
+            m_queue.close();
+
+            for (auto& worker : m_workers) {
+                worker.join();
+            }
+
+            ::unlink(m_config.socketPath.c_str());
+
+            std::cout << "served " << m_latencies.count() << " requests, latency p50 " << m_latencies.percentile(50.0)
+                      << "us p90 " << m_latencies.percentile(90.0) << "us p99 " << m_latencies.percentile(99.0)
+                      << "us max " << m_latencies.max() << "us" << std::endl;
+        }
+    } // namespace
+
+    bool run(const Config& config) {
+        Server server{config};
+
+        if (!server.open()) {
+            return false;
+        }
+
+        server.serve();
+        return true;
+    }
+} // namespace octachoron::serve
@@ -0,0 +1,64 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "types.h"
+
+#include <chrono>
+#include <string>
+
+namespace octachoron::serve {
+    struct Config {
+        std::string socketPath{};
+
+        // searches running at once, each on one thread with its own tree
+        u32 workers{1};
+        // per worker
+        usize treeMb{16};
+
+        // for requests that give neither playouts nor a movetime
+        std::chrono::milliseconds defaultMovetime{100};
+        // caps every request, including those that only give playouts
+        std::chrono::milliseconds maxMovetime{10000};
+        // 0 for no cap
+        u64 maxPlayouts{};
+
+        // requests waiting for a worker before new ones are turned away
+        usize maxQueued{1024};
+
+        // file or "fd:<n>" to write a JSON line per search to, none if empty
+        std::string telemetry{};
+    };
+
+    // Serves analysis to local clients over a Unix domain socket, until SIGINT or SIGTERM.
+    // Clients send newline-terminated requests and get one line back for each:
+    //
+    //   analyse <id> [playouts <n>] [movetime <ms>] [fen <fen>] [moves <move>...]
+    //     -> result <id> bestmove <move> value <v> playouts <n> time <ms> [cancelled] pv <move>...
+    //     -> cancelled <id>, if cancelled before a worker picked it up
+    //   cancel <id>
+    //     stops the search early; its result still arrives, marked cancelled
+    //   stats
+    //     -> stats requests <n> queued <n> p50 <us> p90 <us> p99 <us> max <us>
+    //
+    // Anything else is answered with "error <id> <reason>", where the id is "-" if it could not
+    // be read. Ids are chosen by the client and must be unique among its requests in flight.
+    // Results may arrive in any order. Latencies run from reading a request to its reply.
+    bool run(const Config& config);
+} // namespace octachoron::serve
@@ -0,0 +1,103 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "sprt.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace octachoron::sprt {
+    namespace {
+        [[nodiscard]] f64 eloToScore(f64 elo) {
+            return 1.0 / (1.0 + std::pow(10.0, -elo / 400.0));
+        }
+
+        [[nodiscard]] f64 scoreToElo(f64 score) {
+            score = std::clamp(score, 1.0e-6, 1.0 - 1.0e-6);
+            return -400.0 * std::log10(1.0 / score - 1.0);
+        }
+
+        [[nodiscard]] constexpr f64 pairScore(usize halfPoints) {
+            return static_cast<f64>(halfPoints) / 4.0;
+        }
+    } // namespace
+
+    Bounds bounds(f64 alpha, f64 beta) {
+        return {std::log(beta / (1.0 - alpha)), std::log((1.0 - beta) / alpha)};
+    }
+
+    u64 Pentanomial::pairs() const {
+        return std::accumulate(m_counts.begin(), m_counts.end(), u64{0});
+    }
+
+    f64 Pentanomial::mean() const {
+        f64 total = 0.0;
+
+        for (usize i = 0; i < kOutcomeCount; ++i) {
+            total += static_cast<f64>(m_counts[i]) * pairScore(i);
+        }
+
+        return total / static_cast<f64>(pairs());
+    }
+
+    f64 Pentanomial::variance() const {
+        const auto mu = mean();
+
+        f64 total = 0.0;
+
+        for (usize i = 0; i < kOutcomeCount; ++i) {
+            const auto diff = pairScore(i) - mu;
+            total += static_cast<f64>(m_counts[i]) * diff * diff;
+        }
+
+        return total / static_cast<f64>(pairs());
+    }
+
+    f64 Pentanomial::llr(f64 elo0, f64 elo1) const {
+        if (pairs() == 0) {
+            return 0.0;
+        }
+
+        const auto var = variance();
+
+        if (var <= 0.0) {
+            return 0.0;
+        }
+
+        const auto s0 = eloToScore(elo0);
+        const auto s1 = eloToScore(elo1);
+
+        return 0.5 * static_cast<f64>(pairs()) * (s1 - s0) * (2.0 * mean() - s0 - s1) / var;
+    }
+
+    f64 Pentanomial::elo() const {
+        return pairs() == 0 ? 0.0 : scoreToElo(mean());
+    }
+
+    f64 Pentanomial::eloError() const {
+        if (pairs() == 0) {
+            return 0.0;
+        }
+
+        const auto mu = mean();
+        const auto error = 1.96 * std::sqrt(variance() / static_cast<f64>(pairs()));
+
+        return (scoreToElo(mu + error) - scoreToElo(mu - error)) / 2.0;
+    }
+} // namespace octachoron::sprt
@@ -0,0 +1,66 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "types.h"
+
+#include <array>
+
+namespace octachoron::sprt {
+    struct Bounds {
+        f64 lower;
+        f64 upper;
+    };
+
+    [[nodiscard]] Bounds bounds(f64 alpha, f64 beta);
+
+    // Results of game pairs, counted by the first engine's total score over the pair:
+    // 0, 0.5, 1, 1.5 or 2. Pairs share an opening, so their two games are correlated;
+    // treating the pair as the unit of the test accounts for that.
+    class Pentanomial {
+    public:
+        static constexpr usize kOutcomeCount = 5;
+
+        // score in half points, 0 to 4
+        inline void add(u32 halfPoints) {
+            ++m_counts[halfPoints];
+        }
+
+        [[nodiscard]] inline u64 count(u32 halfPoints) const {
+            return m_counts[halfPoints];
+        }
+
+        [[nodiscard]] u64 pairs() const;
+
+        // Log likelihood ratio of elo1 against elo0 (logistic elo), by the usual
+        // normal approximation to the generalised SPRT. 0 while there is no variance.
+        [[nodiscard]] f64 llr(f64 elo0, f64 elo1) const;
+
+        // logistic elo difference, and the half width of its 95% confidence interval
+        [[nodiscard]] f64 elo() const;
+        [[nodiscard]] f64 eloError() const;
+
+    private:
+        std::array<u64, kOutcomeCount> m_counts{};
+
+        // per pair score in [0, 1]
+        [[nodiscard]] f64 mean() const;
+        [[nodiscard]] f64 variance() const;
+    };
+} // namespace octachoron::sprt
@@ -0,0 +1,188 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "spsa.h"
+
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "mcts/search.h"
+#include "selfplay.h"
+#include "tunable.h"
+#include "util/rng.h"
+
+namespace octachoron::spsa {
+    namespace {
+        using Params = std::array<f64, tunable::kParamCount>;
+
+        constexpr f64 kAlpha = 0.602;
+        constexpr f64 kGamma = 0.101;
+
+        constexpr u32 kReportInterval = 10;
+
+        // one thread's pair of searchers, reused across iterations
+        struct Worker {
+            Worker(const Config& config, u32 idx) :
+                    rng{config.seed + (idx + 1) * UINT64_C(0x9e3779b97f4a7c15)},
+                    plus{config.treeMb, 1},
+                    minus{config.treeMb, 1} {}
+
+            util::rng::Jsf64Rng rng;
+
+            mcts::Searcher plus;
+            mcts::Searcher minus;
+        };
+
+        [[nodiscard]] tunable::Values toValues(const Params& params) {
+            tunable::Values values{};
+
+            for (usize idx = 0; idx < tunable::kParamCount; ++idx) {
+                values.set(static_cast<tunable::Id>(idx), static_cast<i32>(std::lround(params[idx])));
+            }
+
+            return values;
+        }
+
+        // -> wins minus losses of the plus side over a game pair
+        i32 playPair(const Config& config, Worker& worker) {
+            const auto opening = selfplay::randomOpening(worker.rng, config.randomPlies);
+            const mcts::SearchLimits limits{config.playouts, {}};
+
+            i32 score = 0;
+
+            const selfplay::Player plus{&worker.plus, limits};
+            const selfplay::Player minus{&worker.minus, limits};
+
+            const auto first = selfplay::playGame(opening, {plus, minus}, config.maxPlies);
+            score += static_cast<i32>(first) - 1;
+
+            const auto second = selfplay::playGame(opening, {minus, plus}, config.maxPlies);
+            score -= static_cast<i32>(second) - 1;
+
+            return score;
+        }
+
+        void printParams(const Params& params) {
+            for (usize idx = 0; idx < tunable::kParamCount; ++idx) {
+                std::cout << tunable::kParams[idx].name << " " << std::lround(params[idx]) << '\n';
+            }
+
+            std::cout.flush();
+        }
+    } // namespace
+
+    bool run(const Config& config) {
+        if constexpr (!tunable::kEnabled) {
+            std::cerr << "spsa needs a build with OCTACHORON_TUNE" << std::endl;
+            return false;
+        }
+
+        util::rng::Jsf64Rng rng{config.seed};
+
+        std::vector<std::unique_ptr<Worker>> workers{};
+
+        for (u32 i = 0; i < config.threads; ++i) {
+            workers.push_back(std::make_unique<Worker>(config, i));
+        }
+
+        const auto iterations = static_cast<f64>(config.iterations);
+        const auto stability = 0.1 * iterations;
+
+        Params theta{};
+        Params c{};
+        Params a{};
+
+        for (usize idx = 0; idx < tunable::kParamCount; ++idx) {
+            const auto& info = tunable::kParams[idx];
+            const auto cEnd = static_cast<f64>(info.step);
+
+            theta[idx] = info.defaultValue;
+
+            c[idx] = cEnd * std::pow(iterations, kGamma);
+            a[idx] = config.rEnd * cEnd * cEnd * std::pow(stability + iterations, kAlpha);
+        }
+
+        for (u32 k = 0; k < config.iterations; ++k) {
+            const auto aScale = 1.0 / std::pow(stability + k + 1, kAlpha);
+            const auto cScale = 1.0 / std::pow(k + 1, kGamma);
+
+            Params delta{};
+            Params plus{};
+            Params minus{};
+
+            for (usize idx = 0; idx < tunable::kParamCount; ++idx) {
+                const auto& info = tunable::kParams[idx];
+
+                delta[idx] = (rng.nextU64() & 1) != 0 ? 1.0 : -1.0;
+
+                const auto ck = c[idx] * cScale;
+
+                const auto min = static_cast<f64>(info.min);
+                const auto max = static_cast<f64>(info.max);
+
+                plus[idx] = std::clamp(theta[idx] + ck * delta[idx], min, max);
+                minus[idx] = std::clamp(theta[idx] - ck * delta[idx], min, max);
+            }
+
+            for (auto& worker : workers) {
+                worker->plus.params() = toValues(plus);
+                worker->minus.params() = toValues(minus);
+            }
+
+            std::atomic<u32> nextPair{0};
+            std::atomic<i32> result{0};
+
+            std::vector<std::thread> threads{};
+
+            for (auto& worker : workers) {
+                threads.emplace_back([&config, &nextPair, &result, &worker] {
+                    while (nextPair.fetch_add(1, std::memory_order::relaxed) < config.pairs) {
+                        result.fetch_add(playPair(config, *worker), std::memory_order::relaxed);
+                    }
+                });
+            }
+
+            for (auto& thread : threads) {
+                thread.join();
+            }
+
+            // theta += a_k / c_k^2 * c_k * result * delta
+            for (usize idx = 0; idx < tunable::kParamCount; ++idx) {
+                const auto& info = tunable::kParams[idx];
+
+                const auto ak = a[idx] * aScale;
+                const auto ck = c[idx] * cScale;
+
+                theta[idx] += ak / ck * result.load() * delta[idx];
+                theta[idx] = std::clamp(theta[idx], static_cast<f64>(info.min), static_cast<f64>(info.max));
+            }
+
+            if ((k + 1) % kReportInterval == 0 || k + 1 == config.iterations) {
+                std::cout << "iteration " << (k + 1) << '\n';
+                printParams(theta);
+            }
+        }
+
+        return true;
+    }
+} // namespace octachoron::spsa
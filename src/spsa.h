@@ -0,0 +1,49 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "types.h"
+
+namespace octachoron::spsa {
+    struct Config {
+        u32 iterations{10000};
+        // game pairs per iteration
+        u32 pairs{8};
+        u32 threads{1};
+
+        u64 playouts{200};
+        usize treeMb{8};
+
+        u32 randomPlies{8};
+        u32 maxPlies{400};
+
+        // learning rate at the end of the run, as in fishtest
+        f64 rEnd{0.002};
+
+        u64 seed{};
+    };
+
+    // Simultaneous perturbation stochastic approximation over the registered search parameters
+    // (see tunable.h). Each iteration perturbs every parameter up and down by a random sign at
+    // once, plays paired games between the two sides on all threads, each pair sharing a random
+    // opening with colours swapped, and steps along the estimated gradient. Gain schedules follow
+    // fishtest, with each parameter's step as its perturbation size at the end of the run.
+    // Requires a build with OCTACHORON_TUNE.
+    bool run(const Config& config);
+} // namespace octachoron::spsa
@@ -0,0 +1,133 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "stats.h"
+
+#include <iomanip>
+
+namespace octachoron::stats {
+    namespace {
+        f64 percent(u64 count, u64 total) {
+            return total == 0 ? 0.0 : 100.0 * static_cast<f64>(count) / static_cast<f64>(total);
+        }
+    } // namespace
+
+    Counters& Counters::operator+=(const Counters& other) {
+        for (usize i = 0; i < kNodeTypeCount; ++i) {
+            nodes[i] += other.nodes[i];
+        }
+
+        qnodes += other.qnodes;
+
+        playouts += other.playouts;
+
+        ttProbes += other.ttProbes;
+        ttHits += other.ttHits;
+        ttCutoffs += other.ttCutoffs;
+
+        for (usize i = 0; i < kCutoffIndexBuckets; ++i) {
+            cutoffIndices[i] += other.cutoffIndices[i];
+        }
+
+        for (usize i = 0; i < kMoveKindCount; ++i) {
+            moveKinds[i] += other.moveKinds[i];
+        }
+
+        return *this;
+    }
+
+    void print(std::ostream& stream, const Counters& counters) {
+        const auto [pv, cut, all] = counters.nodes;
+        const auto mainNodes = pv + cut + all;
+        const auto totalNodes = mainNodes + counters.qnodes;
+
+        const auto flags = stream.flags();
+        stream << std::fixed << std::setprecision(2);
+
+        // a share is only printed if the search counted something for it
+        const auto share = [&](const char* name, u64 count, u64 total) {
+            if (count > 0) {
+                stream << ' ' << name << ' ' << percent(count, total) << '%';
+            }
+        };
+
+        if (totalNodes > 0) {
+            stream << "info string stats nodes " << totalNodes;
+
+            share("pv", pv, mainNodes);
+            share("cut", cut, mainNodes);
+            share("all", all, mainNodes);
+            share("qsearch", counters.qnodes, totalNodes);
+
+            stream << '\n';
+        }
+
+        if (counters.playouts > 0) {
+            stream << "info string stats playouts " << counters.playouts << '\n';
+        }
+
+        if (counters.ttProbes > 0) {
+            stream << "info string stats tt probes " << counters.ttProbes << " hits "
+                   << percent(counters.ttHits, counters.ttProbes) << '%';
+
+            share("cutoffs", counters.ttCutoffs, counters.ttProbes);
+
+            stream << '\n';
+        }
+
+        u64 cutoffs = 0;
+        for (const auto count : counters.cutoffIndices) {
+            cutoffs += count;
+        }
+
+        if (cutoffs > 0) {
+            stream << "info string stats cutoff index";
+            for (usize i = 0; i < kCutoffIndexBuckets; ++i) {
+                stream << ' ' << i << (i == kCutoffIndexBuckets - 1 ? "+" : "") << ':'
+                       << percent(counters.cutoffIndices[i], cutoffs) << '%';
+            }
+            stream << '\n';
+        }
+
+        const auto [singles, unstacks, doubles] = counters.moveKinds;
+
+        if (singles + unstacks + doubles > 0) {
+            stream << "info string stats moves single " << singles << " unstack " << unstacks << " double "
+                   << doubles << '\n';
+        }
+
+        stream << std::flush;
+
+        stream.flags(flags);
+    }
+
+    void printAggregate(std::ostream& stream, std::span<const ThreadStats* const> threads) {
+#if OC_ENABLE_STATS
+        Counters total{};
+
+        for (const auto* thread : threads) {
+            total += thread->counters();
+        }
+
+        print(stream, total);
+#else
+        (void)stream;
+        (void)threads;
+#endif
+    }
+} // namespace octachoron::stats
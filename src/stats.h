@@ -0,0 +1,150 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "types.h"
+
+#include <algorithm>
+#include <array>
+#include <iostream>
+#include <span>
+
+#include "move.h"
+
+#ifndef OC_ENABLE_STATS
+    #define OC_ENABLE_STATS 0
+#endif
+
+namespace octachoron::stats {
+    constexpr bool kEnabled = OC_ENABLE_STATS != 0;
+
+    enum class NodeType : u8 {
+        kPv = 0,
+        kCut,
+        kAll,
+    };
+
+    constexpr usize kNodeTypeCount = 3;
+
+    enum class MoveKind : u8 {
+        kSingle = 0,
+        kUnstack,
+        kDouble,
+    };
+
+    constexpr usize kMoveKindCount = 3;
+
+    // cutoffs at move index >= this are all counted in the last bucket
+    constexpr usize kCutoffIndexBuckets = 16;
+
+    [[nodiscard]] constexpr MoveKind moveKind(Move move) {
+        if (move.isDouble()) {
+            return MoveKind::kDouble;
+        } else if (move.isSingleUnstack()) {
+            return MoveKind::kUnstack;
+        } else {
+            return MoveKind::kSingle;
+        }
+    }
+
+    // Searches only touch the counters that apply to them (MCTS has no node types or
+    // cutoffs, for example), and sections with nothing counted are not printed.
+    struct Counters {
+        std::array<u64, kNodeTypeCount> nodes{};
+        u64 qnodes{};
+
+        u64 playouts{};
+
+        u64 ttProbes{};
+        u64 ttHits{};
+        u64 ttCutoffs{};
+
+        std::array<u64, kCutoffIndexBuckets> cutoffIndices{};
+        std::array<u64, kMoveKindCount> moveKinds{};
+
+        Counters& operator+=(const Counters& other);
+    };
+
+    void print(std::ostream& stream, const Counters& counters);
+
+#if OC_ENABLE_STATS
+    // per-thread, so there is no sharing or atomics on the hot path
+    class ThreadStats {
+    public:
+        inline void node(NodeType type) {
+            ++m_counters.nodes[static_cast<usize>(type)];
+        }
+
+        inline void qnode() {
+            ++m_counters.qnodes;
+        }
+
+        inline void playout() {
+            ++m_counters.playouts;
+        }
+
+        inline void ttProbe(bool hit) {
+            ++m_counters.ttProbes;
+            m_counters.ttHits += hit;
+        }
+
+        inline void ttCutoff() {
+            ++m_counters.ttCutoffs;
+        }
+
+        inline void betaCutoff(usize moveIndex) {
+            ++m_counters.cutoffIndices[std::min(moveIndex, kCutoffIndexBuckets - 1)];
+        }
+
+        inline void movePlayed(Move move) {
+            ++m_counters.moveKinds[static_cast<usize>(moveKind(move))];
+        }
+
+        inline void reset() {
+            m_counters = {};
+        }
+
+        [[nodiscard]] inline const Counters& counters() const {
+            return m_counters;
+        }
+
+    private:
+        Counters m_counters{};
+    };
+#else
+    // every hook is an empty inline function, so instrumented code compiles to nothing
+    class ThreadStats {
+    public:
+        inline void node(NodeType) {}
+        inline void qnode() {}
+        inline void playout() {}
+
+        inline void ttProbe(bool) {}
+        inline void ttCutoff() {}
+
+        inline void betaCutoff(usize) {}
+        inline void movePlayed(Move) {}
+
+        inline void reset() {}
+    };
+#endif
+
+    // sums the counters of every search thread and prints them, if stats are enabled
+    void printAggregate(std::ostream& stream, std::span<const ThreadStats* const> threads);
+} // namespace octachoron::stats
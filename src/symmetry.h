@@ -0,0 +1,117 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "types.h"
+
+#include <array>
+
+#include "core.h"
+#include "move.h"
+
+namespace octachoron {
+    // Pijersi is unchanged by mirroring the board left to right, and by rotating it
+    // 180 degrees while swapping the colours (and the side to move). Each of these
+    // symmetries is its own inverse, and they commute.
+    enum class Symmetry : u8 {
+        kIdentity = 0,
+        kMirror,
+        kColorFlip,
+        kColorFlipMirror,
+    };
+
+    constexpr usize kSymmetryCount = 4;
+
+    constexpr std::array kSymmetries = {
+        Symmetry::kIdentity,
+        Symmetry::kMirror,
+        Symmetry::kColorFlip,
+        Symmetry::kColorFlipMirror,
+    };
+
+    [[nodiscard]] constexpr bool mirrors(Symmetry symmetry) {
+        return symmetry == Symmetry::kMirror || symmetry == Symmetry::kColorFlipMirror;
+    }
+
+    [[nodiscard]] constexpr bool flipsColor(Symmetry symmetry) {
+        return symmetry == Symmetry::kColorFlip || symmetry == Symmetry::kColorFlipMirror;
+    }
+
+    namespace detail {
+        constexpr auto kCellTransforms = [] {
+            std::array<std::array<Cell, Cells::kCount>, kSymmetryCount> transforms{};
+
+            for (const auto symmetry : kSymmetries) {
+                for (u8 id = 0; id < Cells::kCount; ++id) {
+                    auto cell = Cell::fromRaw(id);
+
+                    if (mirrors(symmetry)) {
+                        cell = cell.mirror();
+                    }
+
+                    if (flipsColor(symmetry)) {
+                        cell = cell.rotate();
+                    }
+
+                    transforms[static_cast<usize>(symmetry)][id] = cell;
+                }
+            }
+
+            return transforms;
+        }();
+    } // namespace detail
+
+    [[nodiscard]] constexpr Cell transform(Cell cell, Symmetry symmetry) {
+        assert(cell != Cells::kNone);
+        return detail::kCellTransforms[static_cast<usize>(symmetry)][cell.idx()];
+    }
+
+    [[nodiscard]] constexpr Piece transform(Piece piece, Symmetry symmetry) {
+        assert(piece != Pieces::kNone);
+        return flipsColor(symmetry) ? piece.flipColor() : piece;
+    }
+
+    [[nodiscard]] constexpr Color transform(Color color, Symmetry symmetry) {
+        assert(color != Colors::kNone);
+        return flipsColor(symmetry) ? color.flip() : color;
+    }
+
+    [[nodiscard]] constexpr Move transform(Move move, Symmetry symmetry) {
+        if (move.isNull()) {
+            return move;
+        }
+
+        const auto from = transform(move.from(), symmetry);
+        const auto to = transform(move.to(), symmetry);
+
+        if (move.isDouble()) {
+            return Move::makeDouble(from, to, transform(move.to2(), symmetry));
+        } else if (move.isSingleUnstack()) {
+            return Move::makeSingleUnstack(from, to);
+        } else {
+            return Move::makeSingle(from, to);
+        }
+    }
+
+    static_assert(transform(Cells::kA1, Symmetry::kMirror) == Cells::kA6);
+    static_assert(transform(Cells::kB1, Symmetry::kMirror) == Cells::kB7);
+    static_assert(transform(Cells::kA1, Symmetry::kColorFlip) == Cells::kG6);
+    static_assert(transform(Cells::kA1, Symmetry::kColorFlipMirror) == Cells::kG1);
+    static_assert(transform(Cells::kD4, Symmetry::kColorFlipMirror) == Cells::kD4);
+} // namespace octachoron
@@ -0,0 +1,607 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "generator.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "../movegen.h"
+#include "../symmetry.h"
+#include "../util/worker_pool.h"
+#include "signature.h"
+#include "table.h"
+#include "unmovegen.h"
+
+namespace octachoron::tb {
+    namespace {
+        // four bytes of memory per entry while solving, and eight more for each one decided but not yet settled
+        constexpr u64 kMaxEntries = UINT64_C(1) << 32;
+
+        constexpr u64 kChunkSize = 4096;
+        // settled positions handed out at a time when propagating, each costing an unmove generation
+        constexpr usize kPropagationChunkSize = 64;
+
+        // states of a table entry while solving
+        namespace resolution {
+            constexpr u8 kUnresolved = 0;
+            constexpr u8 kSettled = 1;
+            // not the canonical form of its position, so never solved or probed
+            constexpr u8 kSymmetric = 2;
+            // decided, and settled once the wave reaches its distance
+            constexpr u8 kPending = 3;
+        } // namespace resolution
+
+        // Only canonical positions are stored, and unmoves are only generated from the canonical form
+        // of a settled position, so a predecessor is reached through the moves of every position
+        // symmetric to it, but only those into that one form. Counting the moves between the two
+        // classes both ways, each one found stands for (positions symmetric to the child) / (positions
+        // symmetric to the predecessor) of its own, so remaining moves are counted in units of
+        // kMoveWeight, in which that is always whole.
+        constexpr u16 kMoveWeight = kSymmetryCount;
+
+        // set in a remaining move count if the position has a capture that does not lose,
+        // so that it never runs out of moves and is never lost
+        constexpr u16 kNoLoss = 0x8000;
+
+        struct SolvingTable {
+            Signature signature;
+            // place among the tables being solved
+            u32 slot;
+
+            std::vector<u8> values;
+            // both empty once the table is complete
+            std::vector<u8> resolved;
+            // moves within the tables being solved not yet known to lose, in kMoveWeight units, plus kNoLoss
+            std::vector<u16> remaining;
+        };
+
+        class Generator {
+        public:
+            Generator(std::string directory, u32 threads) :
+                    m_directory{std::move(directory)}, m_pool{std::max<u32>(threads, 1)} {}
+
+            bool solve(const Signature& pieces);
+
+        private:
+            std::string m_directory;
+            util::WorkerPool m_pool;
+
+            std::unordered_map<u64, std::unique_ptr<SolvingTable>> m_tables{};
+            std::unordered_set<u64> m_solvedPieces{};
+
+            // the tables being solved, and for each thread and distance the entries decided
+            // at that distance, as (slot << 32 | index), waiting to be settled
+            std::vector<SolvingTable*> m_solving{};
+            std::vector<std::vector<std::vector<u64>>> m_scheduled{};
+
+            std::atomic_bool m_tooDeep{};
+
+            // -> false if the distance does not fit in a table entry
+            [[nodiscard]] bool schedule(u32 thread, const SolvingTable& table, u64 index, u32 plies);
+
+            // Settles terminal positions, and otherwise looks up every capture once in the complete
+            // tables of fewer pieces and counts the moves left, which only unmoves will touch again.
+            void initialize(u32 thread, SolvingTable& table, u64 index);
+
+            // Passes pos, settled at value, on to every unresolved position with a move into its
+            // class. A loss wins them one ply later. A win takes away their moves into it, and the
+            // last move taken loses them one ply after their longest defence.
+            void propagate(u32 thread, const Position& pos, u8 value, std::vector<Unmove>& unmoves);
+
+            // settles every position decided in plies, then propagates from them
+            void runWave(u32 plies);
+        };
+
+        void expandStacks(std::vector<Piece>& remaining, std::vector<Piece>& units,
+            std::unordered_set<u64>& seen, std::vector<Signature>& dst) {
+            if (remaining.empty()) {
+                Signature signature{};
+
+                for (const auto unit : units) {
+                    signature.add(unit);
+                }
+
+                if (seen.insert(signature.key()).second) {
+                    dst.push_back(signature);
+                }
+
+                return;
+            }
+
+            const auto piece = remaining.back();
+            remaining.pop_back();
+
+            units.push_back(piece);
+            expandStacks(remaining, units, seen, dst);
+            units.pop_back();
+
+            for (usize i = 0; i < remaining.size(); ++i) {
+                const auto other = remaining[i];
+
+                if (other.color() != piece.color()) {
+                    continue;
+                }
+
+                remaining.erase(remaining.begin() + static_cast<std::ptrdiff_t>(i));
+
+                for (const auto& [upper, lower] : {std::pair{piece, other}, std::pair{other, piece}}) {
+                    // a wise can only be stacked on another wise
+                    if (upper.role() == Roles::kWise && lower.role() != Roles::kWise) {
+                        continue;
+                    }
+
+                    units.push_back(upper.stackedOn(lower));
+                    expandStacks(remaining, units, seen, dst);
+                    units.pop_back();
+                }
+
+                remaining.insert(remaining.begin() + static_cast<std::ptrdiff_t>(i), other);
+            }
+
+            remaining.push_back(piece);
+        }
+
+        [[nodiscard]] std::vector<Signature> arrangements(const Signature& pieces) {
+            std::vector<Piece> remaining{};
+            std::vector<Piece> units{};
+
+            for (usize i = 0; i < pieces.unitCount(); ++i) {
+                remaining.push_back(pieces.unit(i));
+            }
+
+            std::unordered_set<u64> seen{};
+            std::vector<Signature> result{};
+
+            expandStacks(remaining, units, seen, result);
+
+            return result;
+        }
+
+        // the same units with their colours swapped
+        [[nodiscard]] Signature colorFlipped(const Signature& signature) {
+            Signature result{};
+
+            for (usize i = 0; i < signature.unitCount(); ++i) {
+                result.add(signature.unit(i).flipColor());
+            }
+
+            return result;
+        }
+
+        // the pieces left after capturing the unit at idx
+        [[nodiscard]] Signature withoutUnit(const Signature& signature, usize idx) {
+            Signature result{};
+
+            for (usize i = 0; i < signature.unitCount(); ++i) {
+                const auto unit = signature.unit(i);
+
+                if (i == idx) {
+                    continue;
+                }
+
+                if (unit.isStack()) {
+                    result.add(unit.upper());
+                    result.add(unit.lower());
+                } else {
+                    result.add(unit);
+                }
+            }
+
+            return result;
+        }
+
+        // as Position::winner(), but for one colour, so that positions with both sides
+        // on their goal rows are judged the same way under every symmetry
+        [[nodiscard]] bool reachedGoal(const Position& pos, Color color) {
+            const auto goal = color == Colors::kWhite ? Bitboards::kRowG : Bitboards::kRowA;
+            return !(pos.colorBb(color) & ~pos.roleBb(Roles::kWise) & goal).empty();
+        }
+
+        bool Generator::schedule(u32 thread, const SolvingTable& table, u64 index, u32 plies) {
+            if (plies > values::kMaxPlies) {
+                m_tooDeep.store(true, std::memory_order::relaxed);
+                return false;
+            }
+
+            m_scheduled[thread][plies].push_back((static_cast<u64>(table.slot) << 32) | index);
+            return true;
+        }
+
+        void Generator::initialize(u32 thread, SolvingTable& table, u64 index) {
+            const auto pos = table.signature.decode(index);
+
+            // Positions related by a symmetry share their result, so only the canonical one
+            // of each class is solved, here or in the colour-flipped table. The rest are set
+            // aside here, and never looked at again.
+            if (pos.canonicalSymmetry() != Symmetry::kIdentity) {
+                table.resolved[index] = resolution::kSymmetric;
+                return;
+            }
+
+            const auto lost = reachedGoal(pos, pos.stm().flip());
+
+            if (!lost && reachedGoal(pos, pos.stm())) {
+                // cannot arise from a legal move, only present for the index to be perfect
+                table.resolved[index] = resolution::kSettled;
+                return;
+            }
+
+            MoveList moves{};
+
+            if (!lost) {
+                generateAll(moves, pos);
+            }
+
+            if (moves.empty()) {
+                table.values[index] = values::loss(0);
+                table.resolved[index] = resolution::kPending;
+
+                static_cast<void>(schedule(thread, table, index, 0));
+                return;
+            }
+
+            const auto them = pos.stm().flip();
+
+            u16 quiet = 0;
+            bool hasCaptures = false;
+
+            std::optional<u32> fastestWin{};
+            u32 longestDefence = 0;
+            bool escape = false;
+
+            for (const auto move : moves) {
+                const auto child = pos.applyMove(move);
+
+                // the enemy's pieces stay put, so only a capture takes one of their cells
+                if ((pos.colorBb(them) & ~child.colorBb(them)).empty()) {
+                    ++quiet;
+                    continue;
+                }
+
+                hasCaptures = true;
+
+                // only canonical positions are solved
+                const auto canonical = child.canonical();
+
+                const auto found = m_tables.find(signatureKey(canonical));
+                assert(found != m_tables.end());
+
+                const auto& target = *found->second;
+                const auto value = target.values[target.signature.index(canonical)];
+
+                if (values::isLoss(value)) {
+                    fastestWin = std::min(fastestWin.value_or(values::kMaxPlies + 1), values::plies(value) + 1);
+                } else if (values::isWin(value)) {
+                    longestDefence = std::max(longestDefence, values::plies(value));
+                } else {
+                    escape = true;
+                }
+            }
+
+            if (fastestWin) {
+                // a quicker win may still turn up among the moves within these tables
+                table.remaining[index] = kNoLoss;
+
+                if (schedule(thread, table, index, *fastestWin)) {
+                    table.values[index] = values::win(*fastestWin);
+                }
+
+                return;
+            }
+
+            table.remaining[index] = static_cast<u16>(quiet * kMoveWeight | (escape ? kNoLoss : 0));
+
+            if (escape) {
+                return;
+            }
+
+            // not yet lost, but no sooner than the longest capture allows
+            const auto bound = hasCaptures ? longestDefence + 1 : 0;
+
+            if (quiet > 0) {
+                if (bound > values::kMaxPlies) {
+                    // if lost at all, then too deep to store
+                    m_tooDeep.store(true, std::memory_order::relaxed);
+                } else {
+                    table.values[index] = values::loss(bound);
+                }
+
+                return;
+            }
+
+            table.resolved[index] = resolution::kPending;
+
+            if (schedule(thread, table, index, bound)) {
+                table.values[index] = values::loss(bound);
+            }
+        }
+
+        void Generator::propagate(u32 thread, const Position& pos, u8 value, std::vector<Unmove>& unmoves) {
+            const auto plies = values::plies(value);
+
+            const auto keys = pos.symmetricKeys();
+            const auto fixed = std::ranges::count(keys, keys[0]);
+
+            unmoves.clear();
+            generateQuietUnmoves(unmoves, pos);
+
+            for (const auto& unmove : unmoves) {
+                const auto prevKeys = unmove.prev.symmetricKeys();
+                const auto symmetry = std::ranges::min_element(prevKeys) - prevKeys.begin();
+
+                // only canonical positions are solved
+                const auto prev = unmove.prev.transformed(static_cast<Symmetry>(symmetry));
+
+                const auto found = m_tables.find(signatureKey(prev));
+                assert(found != m_tables.end());
+
+                auto& table = *found->second;
+                const auto index = table.signature.index(prev);
+
+                std::atomic_ref state{table.resolved[index]};
+
+                if (state.load(std::memory_order::relaxed) != resolution::kUnresolved) {
+                    continue;
+                }
+
+                if (values::isLoss(value)) {
+                    auto expected = resolution::kUnresolved;
+
+                    if (state.compare_exchange_strong(expected, resolution::kPending, std::memory_order::relaxed)
+                        && schedule(thread, table, index, plies + 1)) {
+                        table.values[index] = values::win(plies + 1);
+                    }
+
+                    continue;
+                }
+
+                // see kMoveWeight
+                const auto weight = static_cast<u16>(kMoveWeight * std::ranges::count(prevKeys, prevKeys[0]) / fixed);
+
+                if (std::atomic_ref{table.remaining[index]}.fetch_sub(weight, std::memory_order::relaxed) == weight) {
+                    // every move loses, and none of them could have won, so nothing races this
+                    const auto longest = std::max(values::plies(table.values[index]), plies + 1);
+
+                    state.store(resolution::kPending, std::memory_order::relaxed);
+
+                    if (schedule(thread, table, index, longest)) {
+                        table.values[index] = values::loss(longest);
+                    }
+                }
+            }
+        }
+
+        void Generator::runWave(u32 plies) {
+            std::vector<u64> settled{};
+
+            for (auto& scheduled : m_scheduled) {
+                for (const auto entry : scheduled[plies]) {
+                    auto& table = *m_solving[entry >> 32];
+                    const auto index = entry & 0xFFFFFFFF;
+
+                    auto& state = table.resolved[index];
+
+                    // wins through a capture are scheduled while unresolved, and
+                    // are dropped if a quicker one has been found since
+                    if (state == resolution::kPending
+                        || (state == resolution::kUnresolved && values::isWin(table.values[index]))) {
+                        state = resolution::kSettled;
+                        settled.push_back(entry);
+                    }
+                }
+
+                scheduled[plies] = {};
+            }
+
+            std::atomic<usize> next{0};
+
+            m_pool.run([&](u32 thread) {
+                std::vector<Unmove> unmoves{};
+
+                for (auto begin = next.fetch_add(kPropagationChunkSize); begin < settled.size();
+                     begin = next.fetch_add(kPropagationChunkSize)) {
+                    const auto end = std::min(begin + kPropagationChunkSize, settled.size());
+
+                    for (auto i = begin; i < end; ++i) {
+                        const auto& table = *m_solving[settled[i] >> 32];
+                        const auto index = settled[i] & 0xFFFFFFFF;
+
+                        propagate(thread, table.signature.decode(index), table.values[index], unmoves);
+                    }
+                }
+            });
+        }
+
+        bool Generator::solve(const Signature& pieces) {
+            if (m_solvedPieces.contains(pieces.key())) {
+                return true;
+            }
+
+            // the colour flip of a position may be its canonical form, so both
+            // sides' versions of the pieces are solved together
+            const auto flippedPieces = colorFlipped(pieces);
+
+            auto signatures = arrangements(pieces);
+
+            if (flippedPieces.key() != pieces.key()) {
+                const auto flipped = arrangements(flippedPieces);
+                signatures.insert(signatures.end(), flipped.begin(), flipped.end());
+            }
+
+            // captures lead to tables with fewer pieces, which must be complete first
+            for (const auto& signature : signatures) {
+                std::array<bool, Colors::kCount> canCapture{};
+
+                for (usize i = 0; i < signature.unitCount(); ++i) {
+                    const auto unit = signature.unit(i);
+                    canCapture[unit.color().idx()] |= unit.role() != Roles::kWise;
+                }
+
+                for (usize i = 0; i < signature.unitCount(); ++i) {
+                    const auto unit = signature.unit(i);
+
+                    if (unit.role() == Roles::kWise || !canCapture[unit.color().flip().idx()]) {
+                        continue;
+                    }
+
+                    if (!solve(withoutUnit(signature, i))) {
+                        return false;
+                    }
+                }
+            }
+
+            const auto start = std::chrono::steady_clock::now();
+
+            m_solving.clear();
+
+            for (const auto& signature : signatures) {
+                if (signature.size() > kMaxEntries) {
+                    std::cerr << "table " << signature.name() << " is too large (" << signature.size() << " entries)"
+                              << std::endl;
+                    return false;
+                }
+
+                auto table = std::make_unique<SolvingTable>();
+
+                table->signature = signature;
+                table->slot = static_cast<u32>(m_solving.size());
+                table->values.resize(signature.size(), values::kDraw);
+                table->resolved.resize(signature.size(), resolution::kUnresolved);
+                table->remaining.resize(signature.size());
+
+                m_solving.push_back(table.get());
+                m_tables[signature.key()] = std::move(table);
+            }
+
+            m_scheduled.assign(m_pool.threadCount(), std::vector<std::vector<u64>>(values::kMaxPlies + 1));
+            m_tooDeep = false;
+
+            std::vector<std::pair<SolvingTable*, u64>> chunks{};
+
+            for (auto* table : m_solving) {
+                for (u64 begin = 0; begin < table->values.size(); begin += kChunkSize) {
+                    chunks.emplace_back(table, begin);
+                }
+            }
+
+            std::atomic<usize> nextChunk{0};
+
+            m_pool.run([&](u32 thread) {
+                for (auto i = nextChunk.fetch_add(1); i < chunks.size(); i = nextChunk.fetch_add(1)) {
+                    auto& [table, begin] = chunks[i];
+                    const auto end = std::min<u64>(begin + kChunkSize, table->values.size());
+
+                    for (auto index = begin; index < end; ++index) {
+                        initialize(thread, *table, index);
+                    }
+                }
+            });
+
+            // each wave only schedules deeper ones, so one sweep settles everything decided
+            for (u32 plies = 0; plies <= values::kMaxPlies && !m_tooDeep; ++plies) {
+                runWave(plies);
+            }
+
+            if (m_tooDeep) {
+                std::cerr << "distances in " << signatures.front().name() << " exceed " << values::kMaxPlies
+                          << " plies" << std::endl;
+                return false;
+            }
+
+            const auto time = std::chrono::duration<f64>(std::chrono::steady_clock::now() - start).count();
+
+            for (auto* table : m_solving) {
+                usize wins = 0;
+                usize draws = 0;
+                usize losses = 0;
+
+                u32 longest = 0;
+
+                for (u64 index = 0; index < table->values.size(); ++index) {
+                    auto& value = table->values[index];
+
+                    // never probed, so take whatever extends the current run, for compression
+                    if (table->resolved[index] == resolution::kSymmetric) {
+                        value = index > 0 ? table->values[index - 1] : values::kDraw;
+                        continue;
+                    }
+
+                    // anything still unsettled can be held forever by both sides
+                    if (table->resolved[index] == resolution::kUnresolved) {
+                        value = values::kDraw;
+                    }
+
+                    if (values::isWin(value)) {
+                        ++wins;
+                    } else if (values::isLoss(value)) {
+                        ++losses;
+                    } else {
+                        ++draws;
+                    }
+
+                    longest = std::max(longest, values::plies(value));
+                }
+
+                table->resolved.clear();
+                table->resolved.shrink_to_fit();
+                table->remaining.clear();
+                table->remaining.shrink_to_fit();
+
+                const auto name = table->signature.name();
+                const auto path = m_directory + "/" + name + kFileExtension;
+
+                if (!writeTable(path, table->signature, table->values)) {
+                    std::cerr << "failed to write " << path << std::endl;
+                    return false;
+                }
+
+                std::cout << name << ": " << (wins + draws + losses) << " canonical positions, " << wins << " wins, "
+                          << draws << " draws, " << losses << " losses, longest " << longest << " plies" << std::endl;
+            }
+
+            std::cout << "solved " << pieces.name() << " in " << time << " s" << std::endl;
+
+            m_solvedPieces.insert(pieces.key());
+            m_solvedPieces.insert(flippedPieces.key());
+
+            return true;
+        }
+    } // namespace
+
+    bool generate(std::span<const Piece> pieces, const std::string& directory, u32 threads) {
+        Signature signature{};
+
+        for (const auto piece : pieces) {
+            if (piece.isStack() || !signature.add(piece)) {
+                return false;
+            }
+        }
+
+        Generator generator{directory, threads};
+        return generator.solve(signature);
+    }
+} // namespace octachoron::tb
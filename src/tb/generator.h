@@ -0,0 +1,48 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "../types.h"
+
+#include <span>
+#include <string>
+
+#include "../core.h"
+
+namespace octachoron::tb {
+    // Solves the tables for every arrangement of the given single pieces into stacks, after
+    // first solving every smaller set of pieces reachable through captures, and writes each
+    // to "<directory>/<signature name>.otb". Stacking and unstacking move between tables of
+    // the same pieces, so those are solved together, as are the colour-flipped pieces, since
+    // only one position of each symmetry class is solved.
+    //
+    // Solving is retrograde. Every position is decoded once, to settle the terminal ones, look
+    // its captures up in the smaller tables and count its other moves. From then on, each
+    // position settled at some distance is passed back to its predecessors through the quiet
+    // unmove generator, in waves of increasing distance: a loss wins them, and a win takes
+    // away one of their remaining moves, the last of which loses them. Whatever is never
+    // settled is a draw, and is never looked at again after the first visit.
+    //
+    // Tables follow the rules as implemented by movegen and Position::winner(), and additionally
+    // score a side without legal moves as lost. The no-capture and repetition draw rules are not
+    // modelled, so a position's distance may exceed what those rules allow.
+    //
+    // -> false if a table is too large, a distance does not fit in a table entry, or writing fails
+    bool generate(std::span<const Piece> pieces, const std::string& directory, u32 threads);
+} // namespace octachoron::tb
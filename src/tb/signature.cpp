@@ -0,0 +1,283 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "signature.h"
+
+#include <algorithm>
+#include <bit>
+
+namespace octachoron::tb {
+    namespace {
+        [[nodiscard]] constexpr u64 packKey(std::span<const u8> sortedIds) {
+            u64 key = 0;
+
+            for (usize i = 0; i < sortedIds.size(); ++i) {
+                key |= static_cast<u64>(sortedIds[i] + 1) << (i * 6);
+            }
+
+            return key;
+        }
+
+        [[nodiscard]] constexpr char roleChar(Piece piece) {
+            constexpr std::array kChars = {'w', 'r', 'p', 's'};
+            const auto c = kChars[piece.role().idx()];
+            return piece.color() == Colors::kWhite ? static_cast<char>(c - 'a' + 'A') : c;
+        }
+
+        // visits (piece, count, free cells before the group) for each run of identical units
+        template <typename F>
+        void forEachGroup(std::span<const Piece> units, F&& f) {
+            usize free = Cells::kCount;
+
+            for (usize i = 0; i < units.size();) {
+                usize count = 1;
+
+                while (i + count < units.size() && units[i + count] == units[i]) {
+                    ++count;
+                }
+
+                f(units[i], count, free);
+
+                free -= count;
+                i += count;
+            }
+        }
+    } // namespace
+
+    u64 signatureKey(const Position& pos) {
+        auto occupied = pos.occupancyBb();
+
+        if (occupied.popcount() > kMaxUnits) {
+            return kInvalidKey;
+        }
+
+        std::array<u8, kMaxUnits> ids{};
+        usize count = 0;
+
+        while (!occupied.empty()) {
+            ids[count++] = pos.pieceOn(occupied.popLowestCell()).raw();
+        }
+
+        std::sort(ids.begin(), ids.begin() + count);
+
+        return packKey({ids.data(), count});
+    }
+
+    bool Signature::add(Piece piece) {
+        assert(piece != Pieces::kNone);
+
+        if (m_unitCount == kMaxUnits) {
+            return false;
+        }
+
+        // insertion into the already sorted units
+        auto idx = m_unitCount++;
+
+        for (; idx > 0 && m_units[idx - 1].raw() > piece.raw(); --idx) {
+            m_units[idx] = m_units[idx - 1];
+        }
+
+        m_units[idx] = piece;
+
+        return true;
+    }
+
+    u64 Signature::key() const {
+        std::array<u8, kMaxUnits> ids{};
+
+        for (usize i = 0; i < m_unitCount; ++i) {
+            ids[i] = m_units[i].raw();
+        }
+
+        return packKey({ids.data(), m_unitCount});
+    }
+
+    std::string Signature::name() const {
+        std::string result{};
+
+        for (const auto color : {Colors::kWhite, Colors::kBlack}) {
+            if (color == Colors::kBlack) {
+                result += 'v';
+            }
+
+            for (const auto unit : units()) {
+                if (unit.color() != color) {
+                    continue;
+                }
+
+                if (unit.isStack()) {
+                    result += roleChar(unit.lower());
+                    result += roleChar(unit.upper());
+                } else {
+                    result += roleChar(unit);
+                    result += '-';
+                }
+            }
+        }
+
+        return result;
+    }
+
+    u64 Signature::size() const {
+        u64 size = 2;
+
+        forEachGroup(units(), [&](Piece, usize count, usize free) { size *= detail::binomial(free, count); });
+
+        return size;
+    }
+
+    u64 Signature::index(const Position& pos) const {
+        u64 index = 0;
+        u64 used = 0;
+
+        forEachGroup(units(), [&](Piece piece, usize count, usize free) {
+            auto cells = pos.pieceBb(piece);
+            assert(cells.popcount() == count);
+
+            u64 group = 0;
+
+            // cells are visited in ascending order, so their ranks among the free cells are too
+            for (usize k = 1; !cells.empty(); ++k) {
+                const auto cell = cells.popLowestCell();
+                const auto rank = cell.idx() - std::popcount(used & (cell.bit() - 1));
+
+                group += detail::binomial(rank, k);
+            }
+
+            index = index * detail::binomial(free, count) + group;
+            used |= pos.pieceBb(piece).raw();
+        });
+
+        return index * 2 + (pos.stm() == Colors::kBlack ? 1 : 0);
+    }
+
+    Position Signature::decode(u64 index) const {
+        assert(index < size());
+
+        const auto stm = (index & 1) ? Colors::kBlack : Colors::kWhite;
+        index >>= 1;
+
+        std::array<u64, kMaxUnits> radices{};
+        usize groupCount = 0;
+
+        forEachGroup(units(), [&](Piece, usize count, usize free) {
+            radices[groupCount++] = detail::binomial(free, count);
+        });
+
+        std::array<u64, kMaxUnits> digits{};
+
+        for (usize i = groupCount; i-- > 0;) {
+            digits[i] = index % radices[i];
+            index /= radices[i];
+        }
+
+        std::array<Piece, Cells::kCount> mailbox{};
+        mailbox.fill(Pieces::kNone);
+
+        usize groupIdx = 0;
+
+        forEachGroup(units(), [&](Piece piece, usize count, usize free) {
+            auto rest = digits[groupIdx++];
+
+            std::array<u8, kMaxUnits> ranks{};
+
+            // greedy combinadic decoding, largest rank first
+            for (usize k = count, limit = free; k > 0; --k) {
+                usize rank = limit - 1;
+
+                while (detail::binomial(rank, k) > rest) {
+                    --rank;
+                }
+
+                rest -= detail::binomial(rank, k);
+                ranks[k - 1] = static_cast<u8>(rank);
+
+                limit = rank;
+            }
+
+            // ranks are relative to the cells left by earlier groups,
+            // so only mark this group's cells once all of them are placed
+            std::array<u8, kMaxUnits> cells{};
+
+            for (usize k = 0; k < count; ++k) {
+                u32 seen = 0;
+
+                for (u8 cellIdx = 0; cellIdx < Cells::kCount; ++cellIdx) {
+                    if (mailbox[cellIdx] != Pieces::kNone) {
+                        continue;
+                    }
+
+                    if (seen++ == ranks[k]) {
+                        cells[k] = cellIdx;
+                        break;
+                    }
+                }
+            }
+
+            for (usize k = 0; k < count; ++k) {
+                mailbox[cells[k]] = piece;
+            }
+        });
+
+        return Position::fromMailbox(mailbox, stm);
+    }
+
+    std::optional<Signature> Signature::fromPosition(const Position& pos) {
+        Signature signature{};
+
+        auto occupied = pos.occupancyBb();
+
+        while (!occupied.empty()) {
+            if (!signature.add(pos.pieceOn(occupied.popLowestCell()))) {
+                return {};
+            }
+        }
+
+        return signature;
+    }
+
+    std::optional<Signature> Signature::fromName(std::string_view name) {
+        const auto separator = name.find('v');
+
+        if (separator == std::string_view::npos || separator % 2 != 0 || (name.size() - separator - 1) % 2 != 0) {
+            return {};
+        }
+
+        Signature signature{};
+
+        const auto addSide = [&](std::string_view units, Color color) {
+            for (usize i = 0; i < units.size(); i += 2) {
+                const auto piece = Piece::fromStr(units.substr(i, 2));
+
+                if (piece == Pieces::kNone || piece.color() != color || !signature.add(piece)) {
+                    return false;
+                }
+            }
+
+            return true;
+        };
+
+        if (!addSide(name.substr(0, separator), Colors::kWhite)
+            || !addSide(name.substr(separator + 1), Colors::kBlack))
+        {
+            return {};
+        }
+
+        return signature;
+    }
+} // namespace octachoron::tb
@@ -0,0 +1,117 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "../types.h"
+
+#include <array>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+
+#include "../core.h"
+#include "../position.h"
+
+namespace octachoron::tb {
+    // most units (single pieces or stacks) a table can cover
+    constexpr usize kMaxUnits = 8;
+
+    namespace detail {
+        constexpr auto kBinomials = [] {
+            std::array<std::array<u64, kMaxUnits + 1>, Cells::kCount + 1> binomials{};
+
+            for (usize n = 0; n <= Cells::kCount; ++n) {
+                for (usize k = 0; k <= kMaxUnits; ++k) {
+                    if (k == 0) {
+                        binomials[n][k] = 1;
+                    } else if (n == 0) {
+                        binomials[n][k] = 0;
+                    } else {
+                        binomials[n][k] = binomials[n - 1][k - 1] + binomials[n - 1][k];
+                    }
+                }
+            }
+
+            return binomials;
+        }();
+
+        [[nodiscard]] constexpr u64 binomial(usize n, usize k) {
+            assert(n <= Cells::kCount);
+            assert(k <= kMaxUnits);
+
+            return kBinomials[n][k];
+        }
+    } // namespace detail
+
+    // Packs up to kMaxUnits pieces, sorted by id, into a key. Zero never occurs, and
+    // kInvalidKey marks positions with too many units to be covered by any table.
+    constexpr u64 kInvalidKey = ~UINT64_C(0);
+
+    [[nodiscard]] u64 signatureKey(const Position& pos);
+
+    // The exact set of units on the board, stacks included. Every signature has its own table,
+    // indexed by placing each group of identical units on the cells left free by the groups
+    // before it, plus the side to move in the lowest bit. The index is perfect: every index
+    // decodes to a distinct position with exactly these units. Positions that are not their own
+    // canonical() form keep their index, but only hold filler in a generated table.
+    class Signature {
+    public:
+        Signature() = default;
+
+        // units in any order; fails if there are too many
+        bool add(Piece piece);
+
+        [[nodiscard]] inline usize unitCount() const {
+            return m_unitCount;
+        }
+
+        [[nodiscard]] inline Piece unit(usize idx) const {
+            return m_units[idx];
+        }
+
+        [[nodiscard]] u64 key() const;
+
+        // e.g. "R-WWvs-" - the units of each side in fen notation
+        [[nodiscard]] std::string name() const;
+
+        // number of entries in this signature's table
+        [[nodiscard]] u64 size() const;
+
+        // the position must contain exactly this signature's units
+        [[nodiscard]] u64 index(const Position& pos) const;
+        [[nodiscard]] Position decode(u64 index) const;
+
+        [[nodiscard]] bool operator==(const Signature& other) const {
+            return key() == other.key();
+        }
+
+        [[nodiscard]] static std::optional<Signature> fromPosition(const Position& pos);
+        [[nodiscard]] static std::optional<Signature> fromName(std::string_view name);
+
+    private:
+        // sorted by id
+        std::array<Piece, kMaxUnits> m_units{};
+        usize m_unitCount{};
+
+        [[nodiscard]] inline std::span<const Piece> units() const {
+            return {m_units.data(), m_unitCount};
+        }
+    };
+} // namespace octachoron::tb
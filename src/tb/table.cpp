@@ -0,0 +1,304 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "table.h"
+
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+namespace octachoron::tb {
+    namespace {
+        constexpr std::array kMagic = {'O', 'C', 'T', 'B'};
+        // 2: non-canonical entries hold filler
+        // 3: checkpoints in long run-length blocks
+        constexpr u32 kVersion = 3;
+
+        // set in the offsets of blocks stored as plain values
+        constexpr u64 kRawBlockFlag = UINT64_C(1) << 63;
+        // set in the offsets of run-length blocks that start with checkpoints
+        constexpr u64 kIndexedBlockFlag = UINT64_C(1) << 62;
+
+        constexpr u64 kOffsetMask = ~(kRawBlockFlag | kIndexedBlockFlag);
+
+        // A checkpoint is the index of the pair holding value n * kCheckpointInterval of the
+        // block (u16, little endian), then how many of that pair's values come before it.
+        // Blocks with no more pairs than that are scanned quickly enough without any.
+        constexpr u64 kCheckpointInterval = 128;
+        constexpr u64 kCheckpointBytes = 3;
+
+        static_assert(kBlockSize / kCheckpointInterval <= 256);
+
+        [[nodiscard]] constexpr u64 blockValues(u64 entryCount, u64 block) {
+            return std::min<u64>(kBlockSize, entryCount - block * kBlockSize);
+        }
+
+        [[nodiscard]] constexpr u64 checkpointPair(const u8* checkpoint) {
+            return checkpoint[0] | (static_cast<u64>(checkpoint[1]) << 8);
+        }
+
+        // the first value is always at the start of pair 0, so needs no checkpoint
+        [[nodiscard]] constexpr u64 checkpointCount(u64 values) {
+            return (values - 1) / kCheckpointInterval;
+        }
+
+        struct FileHeader {
+            std::array<char, 4> magic;
+            u32 version;
+            u64 entryCount;
+            u32 blockSize;
+            u32 unitCount;
+            std::array<u8, kMaxUnits> units;
+        };
+
+        static_assert(sizeof(FileHeader) % sizeof(u64) == 0);
+
+        void encodeBlock(std::vector<u8>& dst, std::span<const u8> values) {
+            for (usize i = 0; i < values.size();) {
+                const auto value = values[i];
+                usize run = 1;
+
+                while (run < 256 && i + run < values.size() && values[i + run] == value) {
+                    ++run;
+                }
+
+                dst.push_back(value);
+                dst.push_back(static_cast<u8>(run - 1));
+
+                i += run;
+            }
+        }
+
+        void addCheckpoints(std::vector<u8>& dst, std::span<const u8> pairs, usize count) {
+            usize pair = 0;
+            // values before the current pair
+            usize position = 0;
+
+            for (usize checkpoint = 1; checkpoint <= checkpointCount(count); ++checkpoint) {
+                const auto target = checkpoint * kCheckpointInterval;
+
+                while (position + pairs[pair * 2 + 1] + 1 <= target) {
+                    position += pairs[pair * 2 + 1] + 1;
+                    ++pair;
+                }
+
+                dst.push_back(static_cast<u8>(pair & 0xFF));
+                dst.push_back(static_cast<u8>(pair >> 8));
+                dst.push_back(static_cast<u8>(target - position));
+            }
+        }
+    } // namespace
+
+    bool writeTable(const std::string& path, const Signature& signature, std::span<const u8> values) {
+        assert(values.size() == signature.size());
+
+        FileHeader header{};
+
+        header.magic = kMagic;
+        header.version = kVersion;
+        header.entryCount = values.size();
+        header.blockSize = kBlockSize;
+        header.unitCount = static_cast<u32>(signature.unitCount());
+
+        for (usize i = 0; i < signature.unitCount(); ++i) {
+            header.units[i] = signature.unit(i).raw();
+        }
+
+        std::vector<u64> offsets{};
+        std::vector<u8> blocks{};
+
+        std::vector<u8> pairs{};
+
+        for (usize start = 0; start < values.size(); start += kBlockSize) {
+            const auto offset = blocks.size();
+
+            const auto count = std::min<usize>(kBlockSize, values.size() - start);
+            const auto block = values.subspan(start, count);
+
+            pairs.clear();
+            encodeBlock(pairs, block);
+
+            const bool indexed = pairs.size() / 2 > kCheckpointInterval;
+
+            if (indexed) {
+                addCheckpoints(blocks, pairs, count);
+            }
+
+            blocks.insert(blocks.end(), pairs.begin(), pairs.end());
+
+            // runs only pay off in quiet regions
+            if (blocks.size() - offset < count) {
+                offsets.push_back(indexed ? offset | kIndexedBlockFlag : offset);
+            } else {
+                blocks.resize(offset);
+                blocks.insert(blocks.end(), block.begin(), block.end());
+
+                offsets.push_back(offset | kRawBlockFlag);
+            }
+        }
+
+        offsets.push_back(blocks.size());
+
+        std::ofstream stream{path, std::ios::binary | std::ios::trunc};
+
+        if (!stream) {
+            return false;
+        }
+
+        stream.write(reinterpret_cast<const char*>(&header), sizeof(FileHeader));
+        stream.write(reinterpret_cast<const char*>(offsets.data()),
+            static_cast<std::streamsize>(offsets.size() * sizeof(u64)));
+        stream.write(reinterpret_cast<const char*>(blocks.data()), static_cast<std::streamsize>(blocks.size()));
+
+        return static_cast<bool>(stream);
+    }
+
+    bool Table::open(const std::string& path) {
+        if (!m_file.open(path)) {
+            return false;
+        }
+
+        const auto data = m_file.data();
+
+        if (data.size() < sizeof(FileHeader)) {
+            return false;
+        }
+
+        FileHeader header{};
+        std::memcpy(&header, data.data(), sizeof(FileHeader));
+
+        if (header.magic != kMagic || header.version != kVersion || header.blockSize != kBlockSize
+            || header.unitCount == 0 || header.unitCount > kMaxUnits)
+        {
+            return false;
+        }
+
+        m_signature = Signature{};
+
+        for (u32 i = 0; i < header.unitCount; ++i) {
+            if (header.units[i] >= Pieces::kCount || !m_signature.add(Piece::fromRaw(header.units[i]))) {
+                return false;
+            }
+        }
+
+        if (header.entryCount != m_signature.size()) {
+            return false;
+        }
+
+        const auto blockCount = (header.entryCount + kBlockSize - 1) / kBlockSize;
+        const auto offsetBytes = (blockCount + 1) * sizeof(u64);
+
+        if (data.size() < sizeof(FileHeader) + offsetBytes) {
+            return false;
+        }
+
+        // the header is a multiple of 8 bytes and mappings are page aligned
+        m_offsets = {reinterpret_cast<const u64*>(data.data() + sizeof(FileHeader)), blockCount + 1};
+
+        const auto blocks = data.subspan(sizeof(FileHeader) + offsetBytes);
+        m_blocks = {reinterpret_cast<const u8*>(blocks.data()), blocks.size()};
+
+        m_entryCount = header.entryCount;
+
+        if (m_offsets.back() != m_blocks.size()) {
+            return false;
+        }
+
+        // probes trust the offsets and checkpoints, so anything they could read out of bounds is checked here
+        for (u64 block = 0; block < blockCount; ++block) {
+            const auto flags = m_offsets[block] & ~kOffsetMask;
+
+            const auto start = m_offsets[block] & kOffsetMask;
+            const auto end = m_offsets[block + 1] & kOffsetMask;
+
+            if (start > end || end > m_blocks.size()) {
+                return false;
+            }
+
+            const auto length = end - start;
+            const auto count = blockValues(m_entryCount, block);
+
+            if (flags == kRawBlockFlag) {
+                if (length != count) {
+                    return false;
+                }
+            } else if (flags == kIndexedBlockFlag) {
+                const auto checkpointBytes = checkpointCount(count) * kCheckpointBytes;
+
+                if (length < checkpointBytes || (length - checkpointBytes) % 2 != 0) {
+                    return false;
+                }
+
+                const auto pairCount = (length - checkpointBytes) / 2;
+
+                for (u64 offset = start; offset < start + checkpointBytes; offset += kCheckpointBytes) {
+                    if (checkpointPair(&m_blocks[offset]) >= pairCount) {
+                        return false;
+                    }
+                }
+            } else if (flags != 0 || length == 0 || length % 2 != 0) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    u8 Table::probe(u64 index) const {
+        assert(index < m_entryCount);
+
+        const auto block = index / kBlockSize;
+        auto remaining = index % kBlockSize;
+
+        const auto start = m_offsets[block];
+        const auto end = m_offsets[block + 1] & kOffsetMask;
+
+        auto offset = start & kOffsetMask;
+
+        if (start & kRawBlockFlag) {
+            return m_blocks[offset + remaining];
+        }
+
+        if (start & kIndexedBlockFlag) {
+            const auto checkpoints = offset;
+            offset += checkpointCount(blockValues(m_entryCount, block)) * kCheckpointBytes;
+
+            // resume from the last checkpoint at or before the value
+            if (const auto checkpoint = remaining / kCheckpointInterval; checkpoint > 0) {
+                const auto* entry = &m_blocks[checkpoints + (checkpoint - 1) * kCheckpointBytes];
+
+                offset += checkpointPair(entry) * 2;
+                remaining = remaining - checkpoint * kCheckpointInterval + entry[2];
+            }
+        }
+
+        for (; offset + 1 < end; offset += 2) {
+            const u64 run = m_blocks[offset + 1] + 1;
+
+            if (remaining < run) {
+                return m_blocks[offset];
+            }
+
+            remaining -= run;
+        }
+
+        assert(false);
+        return values::kDraw;
+    }
+} // namespace octachoron::tb
@@ -0,0 +1,127 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "../types.h"
+
+#include <span>
+#include <string>
+
+#include "../util/mapped_file.h"
+#include "signature.h"
+
+namespace octachoron::tb {
+    enum class Wdl : i8 {
+        kLoss = -1,
+        kDraw = 0,
+        kWin = 1,
+    };
+
+    // from the point of view of the side to move. plies is the number of
+    // plies until the game is decided under optimal play, and 0 for draws
+    struct ProbeResult {
+        Wdl wdl;
+        u32 plies;
+    };
+
+    // Table entries are one byte: 0 for a draw, 1..127 for a win in that many plies,
+    // and 0x80 | n for a loss in n plies. A loss in 0 is a position that is already lost.
+    namespace values {
+        constexpr u8 kDraw = 0;
+        constexpr u32 kMaxPlies = 127;
+
+        [[nodiscard]] constexpr u8 win(u32 plies) {
+            assert(plies > 0 && plies <= kMaxPlies);
+            return static_cast<u8>(plies);
+        }
+
+        [[nodiscard]] constexpr u8 loss(u32 plies) {
+            assert(plies <= kMaxPlies);
+            return static_cast<u8>(0x80 | plies);
+        }
+
+        [[nodiscard]] constexpr bool isWin(u8 value) {
+            return value != kDraw && (value & 0x80) == 0;
+        }
+
+        [[nodiscard]] constexpr bool isLoss(u8 value) {
+            return (value & 0x80) != 0;
+        }
+
+        [[nodiscard]] constexpr u32 plies(u8 value) {
+            return value & 0x7F;
+        }
+
+        [[nodiscard]] constexpr ProbeResult decode(u8 value) {
+            if (isWin(value)) {
+                return {Wdl::kWin, plies(value)};
+            } else if (isLoss(value)) {
+                return {Wdl::kLoss, plies(value)};
+            } else {
+                return {Wdl::kDraw, 0};
+            }
+        }
+    } // namespace values
+
+    // Table files ("<signature name>.otb") hold a header, an offset table with one entry per
+    // block of kBlockSize values plus an end offset, then the blocks. Each block is either a
+    // list of (value, run length - 1) byte pairs or, where that would be larger, the plain
+    // values, so a probe decodes at most one block. Run-length blocks of many pairs start with a
+    // checkpoint every 128 values, so that a probe scans at most 128 pairs. Only canonical
+    // positions are meaningful; the others repeat the value before them, which costs next to
+    // nothing once compressed.
+    constexpr u32 kBlockSize = 4096;
+    constexpr const char* kFileExtension = ".otb";
+
+    bool writeTable(const std::string& path, const Signature& signature, std::span<const u8> values);
+
+    class Table {
+    public:
+        Table() = default;
+
+        Table(const Table&) = delete;
+        Table(Table&&) = default;
+
+        bool open(const std::string& path);
+
+        [[nodiscard]] inline const Signature& signature() const {
+            return m_signature;
+        }
+
+        // read-only, safe to call from any number of threads
+        [[nodiscard]] u8 probe(u64 index) const;
+
+        // pos must be canonical, see Tablebases::probe
+        [[nodiscard]] inline u8 probe(const Position& pos) const {
+            return probe(m_signature.index(pos));
+        }
+
+        Table& operator=(const Table&) = delete;
+        Table& operator=(Table&&) = default;
+
+    private:
+        util::MappedFile m_file{};
+
+        Signature m_signature{};
+
+        u64 m_entryCount{};
+        std::span<const u64> m_offsets{};
+        std::span<const u8> m_blocks{};
+    };
+} // namespace octachoron::tb
@@ -0,0 +1,77 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "tablebase.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <system_error>
+
+namespace octachoron::tb {
+    usize Tablebases::load(const std::string& directory) {
+        std::error_code error{};
+        std::filesystem::directory_iterator iterator{directory, error};
+
+        if (error) {
+            return 0;
+        }
+
+        usize loaded = 0;
+
+        for (const auto& entry : iterator) {
+            if (!entry.is_regular_file() || entry.path().extension() != kFileExtension) {
+                continue;
+            }
+
+            Table table{};
+
+            if (!table.open(entry.path().string())) {
+                continue;
+            }
+
+            const auto key = table.signature().key();
+            m_maxUnits = std::max(m_maxUnits, table.signature().unitCount());
+
+            m_tables.insert_or_assign(key, std::move(table));
+            ++loaded;
+        }
+
+        return loaded;
+    }
+
+    void Tablebases::clear() {
+        m_tables.clear();
+        m_maxUnits = 0;
+    }
+
+    std::optional<ProbeResult> Tablebases::probe(const Position& pos) const {
+        if (pos.occupancyBb().popcount() > m_maxUnits) {
+            return {};
+        }
+
+        // only canonical positions are stored, and symmetries preserve the result
+        const auto canonical = pos.transformed(pos.canonicalSymmetry());
+        const auto key = signatureKey(canonical);
+
+        if (const auto table = m_tables.find(key); table != m_tables.end()) {
+            return values::decode(table->second.probe(canonical));
+        }
+
+        return {};
+    }
+} // namespace octachoron::tb
@@ -0,0 +1,57 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "../types.h"
+
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+#include "../position.h"
+#include "table.h"
+
+namespace octachoron::tb {
+    // The set of tables found in a directory. Loading is not thread safe,
+    // but once loaded, probing only reads mapped memory and takes no locks.
+    class Tablebases {
+    public:
+        // -> number of tables loaded
+        usize load(const std::string& directory);
+        void clear();
+
+        [[nodiscard]] inline usize tableCount() const {
+            return m_tables.size();
+        }
+
+        // most units on the board for which a probe can succeed
+        [[nodiscard]] inline usize maxUnits() const {
+            return m_maxUnits;
+        }
+
+        // Cheap enough to call at every node: positions with more units than any loaded
+        // table are rejected with a popcount. Move counters are ignored, and the position is
+        // mapped to its canonical form, which may be in the colour-flipped table.
+        [[nodiscard]] std::optional<ProbeResult> probe(const Position& pos) const;
+
+    private:
+        std::unordered_map<u64, Table> m_tables{};
+        usize m_maxUnits{};
+    };
+} // namespace octachoron::tb
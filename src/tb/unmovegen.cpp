@@ -0,0 +1,162 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "unmovegen.h"
+
+#include <initializer_list>
+#include <utility>
+
+#include "../geometry.h"
+
+namespace octachoron::tb {
+    namespace {
+        // a wise may only be stacked onto another wise
+        [[nodiscard]] inline bool canStack(Piece upper, Piece lower) {
+            return upper.role() != Roles::kWise || lower.role() == Roles::kWise;
+        }
+
+        // cells a stack may have moved to `to` from: one step away, or two in a line over a
+        // cell that was empty at the time
+        [[nodiscard]] inline Bitboard stackOrigins(Cell to, Bitboard origins, Bitboard passable) {
+            auto result = geometry::neighbourBb(to) & origins;
+
+            for (const auto [mid, from] : geometry::twoSteps(to)) {
+                if (from != Cells::kNone && passable.getCell(mid)) {
+                    result |= Bitboard::fromCell(from) & origins;
+                }
+            }
+
+            return result;
+        }
+    } // namespace
+
+    // Mirrors generate() in movegen.cpp, one kind of move at a time, with captures left out.
+    // Cells are named after the move being undone: it went from `from`, possibly via `at`, to `to`
+    void generateQuietUnmoves(std::vector<Unmove>& dst, const Position& pos) {
+        // the side that made the move
+        const auto us = pos.stm().flip();
+
+        const auto ours = pos.colorBb(us);
+        const auto empty = ~pos.occupancyBb() & Bitboards::kAll;
+
+        const auto ourSingles = ours & ~pos.stackBb();
+        const auto ourStacks = ours & pos.stackBb();
+
+        // changes are applied in order, so later ones win where cells coincide
+        const auto emit = [&](Move move, std::initializer_list<std::pair<Cell, Piece>> changes) {
+            dst.push_back({pos.withCells({changes.begin(), changes.size()}, us), move});
+        };
+
+        auto singles = ourSingles;
+        while (!singles.empty()) {
+            const auto to = singles.popLowestCell();
+            const auto piece = pos.pieceOn(to);
+
+            auto froms = geometry::neighbourBb(to) & empty;
+            while (!froms.empty()) {
+                const auto from = froms.popLowestCell();
+                emit(Move::makeSingle(from, to), {{to, Pieces::kNone}, {from, piece}});
+            }
+
+            // unstacked off a neighbouring stack, whose lower piece was left behind
+            auto bases = geometry::neighbourBb(to) & ourSingles;
+            while (!bases.empty()) {
+                const auto at = bases.popLowestCell();
+                const auto lower = pos.pieceOn(at);
+
+                if (!canStack(piece, lower)) {
+                    continue;
+                }
+
+                const auto stack = piece.stackedOn(lower);
+
+                emit(Move::makeSingleUnstack(at, to), {{to, Pieces::kNone}, {at, stack}});
+
+                // or moved there first. `to` was empty then, so the stack may have started on it
+                const auto toBb = Bitboard::fromCell(to);
+
+                auto origins = stackOrigins(at, empty | toBb, empty | toBb);
+                while (!origins.empty()) {
+                    const auto from = origins.popLowestCell();
+                    emit(Move::makeDouble(from, at, to), {{to, Pieces::kNone}, {at, Pieces::kNone}, {from, stack}});
+                }
+            }
+        }
+
+        auto stacks = ourStacks;
+        while (!stacks.empty()) {
+            const auto to = stacks.popLowestCell();
+            const auto stack = pos.pieceOn(to);
+
+            const auto upper = stack.upper();
+            const auto lower = stack.lower();
+
+            // the upper piece stacked onto the lower one from a neighbouring cell
+            auto froms = geometry::neighbourBb(to) & empty;
+            while (!froms.empty()) {
+                const auto from = froms.popLowestCell();
+                emit(Move::makeSingle(from, to), {{to, lower}, {from, upper}});
+            }
+
+            // the whole stack moved
+            auto origins = stackOrigins(to, empty, empty);
+            while (!origins.empty()) {
+                const auto from = origins.popLowestCell();
+                emit(Move::makeSingle(from, to), {{to, Pieces::kNone}, {from, stack}});
+            }
+
+            // stacked elsewhere, then moved. `from` was already empty, so the stack
+            // may have passed over it, or come back to it
+            const auto toBb = Bitboard::fromCell(to);
+
+            auto ats = stackOrigins(to, empty, empty);
+            while (!ats.empty()) {
+                const auto at = ats.popLowestCell();
+
+                auto stackFroms = geometry::neighbourBb(at) & (empty | toBb);
+                while (!stackFroms.empty()) {
+                    const auto from = stackFroms.popLowestCell();
+                    emit(Move::makeDouble(from, at, to), {{to, Pieces::kNone}, {at, lower}, {from, upper}});
+                }
+            }
+
+            // the upper piece unstacked onto the lower one, off a neighbouring stack
+            auto bases = geometry::neighbourBb(to) & ourSingles;
+            while (!bases.empty()) {
+                const auto at = bases.popLowestCell();
+                const auto base = pos.pieceOn(at);
+
+                if (!canStack(upper, base)) {
+                    continue;
+                }
+
+                const auto previous = upper.stackedOn(base);
+
+                emit(Move::makeSingleUnstack(at, to), {{to, lower}, {at, previous}});
+
+                // or moved there first
+                auto stackOrigin = stackOrigins(at, empty, empty);
+                while (!stackOrigin.empty()) {
+                    const auto from = stackOrigin.popLowestCell();
+                    emit(Move::makeDouble(from, at, to), {{to, lower}, {at, Pieces::kNone}, {from, previous}});
+                }
+            }
+        }
+    }
+} // namespace octachoron::tb
@@ -0,0 +1,43 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "../types.h"
+
+#include <vector>
+
+#include "../move.h"
+#include "../position.h"
+
+namespace octachoron::tb {
+    struct Unmove {
+        // the position the move was played in
+        Position prev;
+        Move move;
+    };
+
+    // Appends every move that captures nothing and could have been played to reach pos, along
+    // with the position it was played in. Each such (position, move) pair appears exactly once,
+    // so counting them matches counting the quiet moves of every predecessor. Captures change
+    // the units on the board, so within one table's set of pieces these are all the ways in.
+    // Nothing is checked about the predecessors beyond the move being legal in them: one may
+    // well have had the game already over.
+    void generateQuietUnmoves(std::vector<Unmove>& dst, const Position& pos);
+} // namespace octachoron::tb
@@ -0,0 +1,195 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "telemetry.h"
+
+#include <iomanip>
+#include <sstream>
+#include <utility>
+
+#include <unistd.h>
+
+#include "util/parse.h"
+
+namespace octachoron::telemetry {
+    namespace {
+        u64 nps(u64 nodes, f64 timeMs) {
+            return timeMs > 0.0 ? static_cast<u64>(static_cast<f64>(nodes) * 1000.0 / timeMs) : 0;
+        }
+    } // namespace
+
+    std::string toJson(const SearchReport& report) {
+        std::ostringstream json{};
+        json << std::fixed << std::setprecision(3);
+
+        json << "{\"depth\":" << report.depth << ",\"seldepth\":" << report.seldepth << ",\"nodes\":" << report.nodes
+             << ",\"time_ms\":" << report.timeMs << ",\"nps\":" << nps(report.nodes, report.timeMs)
+             << ",\"hashfull\":" << report.hashfull << ",\"ebf\":" << report.ebf << ",\"iterations\":[";
+
+        for (usize i = 0; i < report.iterations.size(); ++i) {
+            const auto& iteration = report.iterations[i];
+
+            if (i > 0) {
+                json << ',';
+            }
+
+            json << "{\"depth\":" << iteration.depth << ",\"nodes\":" << iteration.nodes
+                 << ",\"time_ms\":" << iteration.timeMs << ",\"ebf\":" << iteration.ebf << '}';
+        }
+
+        json << "]}";
+
+        return json.str();
+    }
+
+    JsonLinesWriter::~JsonLinesWriter() {
+        close();
+    }
+
+    bool JsonLinesWriter::open(std::string_view target) {
+        close();
+
+        std::FILE* file{};
+
+        if (target.starts_with("fd:")) {
+            i32 fd{};
+
+            if (!util::tryParse(fd, target.substr(3)) || fd < 0) {
+                return false;
+            }
+
+            // a duplicate, so that close() leaves the caller's descriptor open
+            const auto duplicate = ::dup(fd);
+
+            if (duplicate < 0) {
+                return false;
+            }
+
+            file = fdopen(duplicate, "a");
+
+            if (!file) {
+                ::close(duplicate);
+            }
+        } else {
+            file = std::fopen(std::string{target}.c_str(), "a");
+        }
+
+        if (!file) {
+            return false;
+        }
+
+        {
+            const std::unique_lock lock{m_mutex};
+
+            m_file = file;
+            m_queue.clear();
+
+            m_quit = false;
+            m_dropped = 0;
+        }
+
+        m_thread = std::thread{[this] { run(); }};
+
+        return true;
+    }
+
+    void JsonLinesWriter::close() {
+        if (!m_thread.joinable()) {
+            return;
+        }
+
+        {
+            const std::unique_lock lock{m_mutex};
+            m_quit = true;
+        }
+
+        m_signal.notify_one();
+        m_thread.join();
+
+        std::FILE* file{};
+
+        // submit() checks m_file under the lock, so nothing is queued once it is cleared
+        {
+            const std::unique_lock lock{m_mutex};
+            file = std::exchange(m_file, nullptr);
+        }
+
+        std::fclose(file);
+    }
+
+    bool JsonLinesWriter::isOpen() {
+        const std::unique_lock lock{m_mutex};
+        return m_file != nullptr;
+    }
+
+    void JsonLinesWriter::submit(SearchReport report) {
+        {
+            const std::unique_lock lock{m_mutex};
+
+            if (!m_file) {
+                return;
+            }
+
+            if (m_queue.size() >= kMaxQueued) {
+                ++m_dropped;
+                return;
+            }
+
+            m_queue.push_back(std::move(report));
+        }
+
+        m_signal.notify_one();
+    }
+
+    u64 JsonLinesWriter::dropped() {
+        const std::unique_lock lock{m_mutex};
+        return m_dropped;
+    }
+
+    void JsonLinesWriter::run() {
+        std::deque<SearchReport> pending{};
+
+        while (true) {
+            bool quit;
+
+            {
+                std::unique_lock lock{m_mutex};
+                m_signal.wait(lock, [this] { return m_quit || !m_queue.empty(); });
+
+                pending.swap(m_queue);
+                quit = m_quit;
+            }
+
+            for (const auto& report : pending) {
+                const auto line = toJson(report);
+
+                std::fwrite(line.data(), 1, line.size(), m_file);
+                std::fputc('\n', m_file);
+            }
+
+            if (!pending.empty()) {
+                std::fflush(m_file);
+                pending.clear();
+            }
+
+            if (quit) {
+                break;
+            }
+        }
+    }
+} // namespace octachoron::telemetry
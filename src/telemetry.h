@@ -0,0 +1,99 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "types.h"
+
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace octachoron::telemetry {
+    // ebf is supplied by the search. MCTS has no iterative deepening, only info intervals with
+    // cumulative playout counts, so it reports the effective number of children searched along
+    // the pv instead of the growth in nodes between iterations.
+    struct IterationReport {
+        u32 depth;
+        u64 nodes;
+        f64 timeMs;
+        f64 ebf;
+    };
+
+    struct SearchReport {
+        u32 depth;
+        u32 seldepth;
+        u64 nodes;
+        f64 timeMs;
+        // permille, as in protocol output
+        u32 hashfull;
+        f64 ebf;
+        std::vector<IterationReport> iterations;
+    };
+
+    // formats one search as a single line of JSON, without the trailing newline
+    [[nodiscard]] std::string toJson(const SearchReport& report);
+
+    // Writes search reports as JSON lines on a background thread. submit() only
+    // moves the report into a bounded queue, so a slow sink never stalls the search;
+    // if the queue is full the report is dropped and counted instead.
+    class JsonLinesWriter {
+    public:
+        JsonLinesWriter() = default;
+        ~JsonLinesWriter();
+
+        JsonLinesWriter(const JsonLinesWriter&) = delete;
+        JsonLinesWriter(JsonLinesWriter&&) = delete;
+
+        // target is either a file path, which is appended to, or "fd:<n>" for an already open
+        // descriptor, which is duplicated and so stays open after close()
+        bool open(std::string_view target);
+        void close();
+
+        [[nodiscard]] bool isOpen();
+
+        // safe to call from any thread, and a no-op unless open
+        void submit(SearchReport report);
+
+        [[nodiscard]] u64 dropped();
+
+        JsonLinesWriter& operator=(const JsonLinesWriter&) = delete;
+        JsonLinesWriter& operator=(JsonLinesWriter&&) = delete;
+
+    private:
+        static constexpr usize kMaxQueued = 1024;
+
+        std::FILE* m_file{};
+
+        std::mutex m_mutex{};
+        std::condition_variable m_signal{};
+
+        std::deque<SearchReport> m_queue{};
+        bool m_quit{false};
+        u64 m_dropped{};
+
+        std::thread m_thread{};
+
+        void run();
+    };
+} // namespace octachoron::telemetry
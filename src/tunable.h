@@ -0,0 +1,128 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "types.h"
+
+#include <algorithm>
+#include <array>
+#include <string_view>
+
+#ifndef OC_TUNE
+    #define OC_TUNE 0
+#endif
+
+// Search parameters: name, default, min, max, and the SPSA perturbation size at the
+// end of a run. All values are integers; fractional parameters are scaled.
+#define OC_TUNABLE_PARAMS(X) \
+    /* PUCT exploration constant, in hundredths */ \
+    X(cpuct, 150, 25, 600, 15) \
+    /* how much worse unvisited children are assumed than their parent, in hundredths */ \
+    X(fpuReduction, 25, 0, 100, 4) \
+    /* eval scores map to values in (-1, 1) by tanh(score / valueScale) */ \
+    X(valueScale, 400, 100, 1600, 40) \
+    /* priors are a softmax over the children's scores divided by this */ \
+    X(policyTemperature, 100, 20, 500, 10) \
+    /* score given to immediately winning children when deriving priors. with a policy network, */ \
+    /* the margin above the network's best move instead, in the same units */ \
+    X(winPolicyScore, 1000, 100, 4000, 100)
+
+namespace octachoron::tunable {
+    enum class Id : usize {
+#define OC_TUNABLE_ID(Name, Default, Min, Max, Step) Name,
+        OC_TUNABLE_PARAMS(OC_TUNABLE_ID)
+#undef OC_TUNABLE_ID
+    };
+
+    struct ParamInfo {
+        std::string_view name;
+
+        i32 defaultValue;
+        i32 min;
+        i32 max;
+
+        i32 step;
+    };
+
+    constexpr std::array kParams = {
+#define OC_TUNABLE_INFO(Name, Default, Min, Max, Step) ParamInfo{#Name, Default, Min, Max, Step},
+        OC_TUNABLE_PARAMS(OC_TUNABLE_INFO)
+#undef OC_TUNABLE_INFO
+    };
+
+    constexpr usize kParamCount = kParams.size();
+
+    constexpr bool kEnabled = OC_TUNE != 0;
+
+    // One set of parameter values. Without OC_TUNE this holds nothing, and every accessor
+    // is a compile-time constant; with it, each search owns its own values, so differently
+    // tuned searchers can run side by side.
+    class Values {
+    public:
+#if OC_TUNE
+        [[nodiscard]] constexpr i32 get(Id id) const {
+            return m_values[static_cast<usize>(id)];
+        }
+
+        // clamped to the parameter's range
+        constexpr void set(Id id, i32 value) {
+            const auto& info = kParams[static_cast<usize>(id)];
+            m_values[static_cast<usize>(id)] = std::clamp(value, info.min, info.max);
+        }
+#else
+        [[nodiscard]] constexpr i32 get(Id id) const {
+            return kParams[static_cast<usize>(id)].defaultValue;
+        }
+
+        constexpr void set(Id, i32) {}
+#endif
+
+        // -> false if there is no parameter by that name, or it cannot be changed in this build
+        constexpr bool set(std::string_view name, i32 value) {
+            for (usize idx = 0; idx < kParamCount; ++idx) {
+                if (kParams[idx].name == name) {
+                    set(static_cast<Id>(idx), value);
+                    return kEnabled;
+                }
+            }
+
+            return false;
+        }
+
+#define OC_TUNABLE_GETTER(Name, Default, Min, Max, Step) \
+    [[nodiscard]] constexpr i32 Name() const { \
+        return get(Id::Name); \
+    }
+        OC_TUNABLE_PARAMS(OC_TUNABLE_GETTER)
+#undef OC_TUNABLE_GETTER
+
+    private:
+#if OC_TUNE
+        std::array<i32, kParamCount> m_values = [] {
+            std::array<i32, kParamCount> values{};
+
+            for (usize idx = 0; idx < kParamCount; ++idx) {
+                values[idx] = kParams[idx].defaultValue;
+            }
+
+            return values;
+        }();
+#endif
+    };
+} // namespace octachoron::tunable
@@ -0,0 +1,271 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "tune.h"
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <span>
+
+#include "data/packed.h"
+#include "eval.h"
+#include "util/adam.h"
+#include "util/worker_pool.h"
+
+namespace octachoron::tune {
+    namespace {
+        using Params = std::array<f64, eval::terms::kCount>;
+
+        constexpr u32 kReportInterval = 100;
+
+        // one thread's share of the positions, with the term counts in compressed sparse rows,
+        // kept as separate term and count arrays so that the inner loops are plain streams
+        struct Shard {
+            std::vector<u16> terms{};
+            std::vector<i16> counts{};
+            // one past each position's last entry
+            std::vector<u32> ends{};
+
+            // both from white's point of view
+            std::vector<f32> results{};
+            std::vector<f32> scores{};
+        };
+
+        struct Batch {
+            Params gradient{};
+            f64 loss{};
+        };
+
+        [[nodiscard]] inline f64 sigmoid(f64 x) {
+            return 1.0 / (1.0 + std::exp(-x));
+        }
+
+        void extract(Shard& shard, std::span<const data::PackedPosition* const> records) {
+            shard.ends.reserve(records.size());
+            shard.results.reserve(records.size());
+            shard.scores.reserve(records.size());
+
+            for (const auto* record : records) {
+                const auto pos = record->unpack();
+
+                std::array<i32, eval::terms::kCount> counts{};
+
+                eval::forEachTerm(pos, Colors::kWhite, [&](usize term) { ++counts[term]; });
+                eval::forEachTerm(pos, Colors::kBlack, [&](usize term) { --counts[term]; });
+
+                for (usize term = 0; term < counts.size(); ++term) {
+                    if (counts[term] != 0) {
+                        shard.terms.push_back(static_cast<u16>(term));
+                        shard.counts.push_back(static_cast<i16>(counts[term]));
+                    }
+                }
+
+                shard.ends.push_back(static_cast<u32>(shard.terms.size()));
+                shard.results.push_back(static_cast<f32>(record->outcome()) / 2.0F);
+                shard.scores.push_back(static_cast<f32>(record->score()));
+            }
+        }
+
+        // squared error over a shard, and its gradient if requested
+        template <bool kGradient>
+        void accumulate(Batch& batch, const Shard& shard, const Params& weights, f64 scale, f64 lambda) {
+            const auto* terms = shard.terms.data();
+            const auto* counts = shard.counts.data();
+
+            u32 begin = 0;
+
+            for (usize i = 0; i < shard.ends.size(); ++i) {
+                const auto end = shard.ends[i];
+
+                f64 eval = 0.0;
+
+                for (auto idx = begin; idx < end; ++idx) {
+                    eval += weights[terms[idx]] * counts[idx];
+                }
+
+                const auto target = lambda * sigmoid(scale * shard.scores[i]) + (1.0 - lambda) * shard.results[i];
+
+                const auto predicted = sigmoid(scale * eval);
+                const auto error = predicted - target;
+
+                batch.loss += error * error;
+
+                if constexpr (kGradient) {
+                    const auto delta = 2.0 * error * predicted * (1.0 - predicted) * scale;
+
+                    for (auto idx = begin; idx < end; ++idx) {
+                        batch.gradient[terms[idx]] += delta * counts[idx];
+                    }
+                }
+
+                begin = end;
+            }
+        }
+
+        // one shard per pool thread
+        template <bool kGradient>
+        Batch evaluateAll(util::WorkerPool& pool, const std::vector<Shard>& shards, const Params& weights, f64 scale,
+            f64 lambda, u64 total) {
+            assert(shards.size() == pool.threadCount());
+
+            std::vector<Batch> batches(shards.size());
+
+            pool.run([&](u32 idx) { accumulate<kGradient>(batches[idx], shards[idx], weights, scale, lambda); });
+
+            Batch result{};
+
+            for (const auto& batch : batches) {
+                result.loss += batch.loss;
+
+                for (usize term = 0; term < result.gradient.size(); ++term) {
+                    result.gradient[term] += batch.gradient[term];
+                }
+            }
+
+            const auto n = static_cast<f64>(total);
+
+            result.loss /= n;
+
+            for (auto& gradient : result.gradient) {
+                gradient /= n;
+            }
+
+            return result;
+        }
+
+        // ternary search over the log of the scale, the loss being unimodal in it. fitted against
+        // game results alone: with search scores blended into the target, the scale that best
+        // predicts them collapses towards zero, since the target itself moves with the scale
+        f64 fitScale(util::WorkerPool& pool, const std::vector<Shard>& shards, const Params& weights, u64 total) {
+            constexpr f64 kLambda = 0.0;
+
+            f64 lo = std::log(1.0e-6);
+            f64 hi = std::log(1.0);
+
+            for (u32 i = 0; i < 40; ++i) {
+                const auto a = lo + (hi - lo) / 3.0;
+                const auto b = hi - (hi - lo) / 3.0;
+
+                const auto lossA = evaluateAll<false>(pool, shards, weights, std::exp(a), kLambda, total).loss;
+                const auto lossB = evaluateAll<false>(pool, shards, weights, std::exp(b), kLambda, total).loss;
+
+                if (lossA < lossB) {
+                    hi = b;
+                } else {
+                    lo = a;
+                }
+            }
+
+            return std::exp((lo + hi) / 2.0);
+        }
+
+        void printWeights(const Params& weights) {
+            std::cout << "role values:";
+
+            for (usize role = 0; role < Roles::kCount; ++role) {
+                std::cout << ' ' << std::lround(weights[eval::terms::kRoleValue + role]);
+            }
+
+            std::cout << "\nadvancement:";
+
+            for (usize term = eval::terms::kAdvancement; term < eval::terms::kCount; ++term) {
+                std::cout << ' ' << std::lround(weights[term]);
+            }
+
+            std::cout << std::endl;
+        }
+    } // namespace
+
+    bool run(const Config& config) {
+        std::vector<std::unique_ptr<data::PackedReader>> readers{};
+        std::vector<const data::PackedPosition*> records{};
+
+        u64 invalid = 0;
+
+        for (const auto& input : config.inputs) {
+            auto& reader = readers.emplace_back(std::make_unique<data::PackedReader>());
+
+            if (!reader->open(input)) {
+                std::cerr << "failed to open " << input << std::endl;
+                return false;
+            }
+
+            for (const auto& record : reader->records()) {
+                if (record.isValid()) {
+                    records.push_back(&record);
+                } else {
+                    ++invalid;
+                }
+            }
+        }
+
+        if (invalid > 0) {
+            std::cerr << "skipped " << invalid << " invalid records" << std::endl;
+        }
+
+        if (records.empty()) {
+            std::cerr << "no positions" << std::endl;
+            return false;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        const auto total = static_cast<u64>(records.size());
+
+        util::WorkerPool pool{config.threads};
+        std::vector<Shard> shards(config.threads);
+
+        pool.run([&](u32 idx) {
+            const auto begin = records.size() * idx / config.threads;
+            const auto end = records.size() * (idx + 1) / config.threads;
+
+            extract(shards[idx], std::span{records}.subspan(begin, end - begin));
+        });
+
+        records = {};
+        readers.clear();
+
+        Params weights{};
+        std::ranges::copy(eval::weights(), weights.begin());
+
+        const auto scale = fitScale(pool, shards, weights, total);
+
+        std::cout << "extracted " << total << " positions, scale " << scale << ", initial loss " << std::setprecision(8)
+                  << evaluateAll<false>(pool, shards, weights, scale, config.lambda, total).loss << std::endl;
+
+        util::Adam adam{weights.size()};
+
+        for (u32 epoch = 1; epoch <= config.epochs; ++epoch) {
+            const auto batch = evaluateAll<true>(pool, shards, weights, scale, config.lambda, total);
+            adam.step(weights, batch.gradient, config.learningRate);
+
+            if (epoch % kReportInterval == 0 || epoch == config.epochs) {
+                const auto time = std::chrono::duration<f64>(std::chrono::steady_clock::now() - start).count();
+                std::cout << "epoch " << epoch << " loss " << batch.loss << " time " << std::setprecision(3) << time
+                          << std::setprecision(8) << std::endl;
+            }
+        }
+
+        printWeights(weights);
+
+        return true;
+    }
+} // namespace octachoron::tune
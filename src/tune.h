@@ -0,0 +1,45 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "types.h"
+
+#include <string>
+#include <vector>
+
+namespace octachoron::tune {
+    struct Config {
+        std::vector<std::string> inputs{};
+
+        u32 threads{1};
+        u32 epochs{2000};
+        // in centipawns per step
+        f64 learningRate{1.0};
+        // how much the target follows the recorded score rather than the game result
+        f64 lambda{0.0};
+    };
+
+    // Texel tuning of the evaluation weights against packed training data. Every position is
+    // reduced once to its sparse, white-relative term counts, stored as separate term and count
+    // arrays; each epoch then only has to run a multiply-accumulate over those counts, split
+    // across a pool of threads that lives for the whole run, to get the full-batch
+    // gradient of the squared error between sigmoid(eval) and the target. The sigmoid scale
+    // is fitted to the current weights first, and Adam takes the steps.
+    bool run(const Config& config);
+} // namespace octachoron::tune
@@ -0,0 +1,67 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "../types.h"
+
+#include <cassert>
+#include <cmath>
+#include <span>
+#include <vector>
+
+namespace octachoron::util {
+    // Adam with the usual defaults, keeping its moment estimates
+    // for one set of parameters from one step to the next
+    class Adam {
+    public:
+        explicit Adam(usize size) :
+                m_momentum(size), m_velocity(size) {}
+
+        // gradient is of the loss, so the step goes against it
+        void step(std::span<f64> params, std::span<const f64> gradient, f64 learningRate) {
+            assert(params.size() == m_momentum.size());
+            assert(gradient.size() == m_momentum.size());
+
+            ++m_steps;
+
+            const auto correction1 = 1.0 - std::pow(kBeta1, m_steps);
+            const auto correction2 = 1.0 - std::pow(kBeta2, m_steps);
+
+            for (usize i = 0; i < params.size(); ++i) {
+                m_momentum[i] = kBeta1 * m_momentum[i] + (1.0 - kBeta1) * gradient[i];
+                m_velocity[i] = kBeta2 * m_velocity[i] + (1.0 - kBeta2) * gradient[i] * gradient[i];
+
+                const auto m = m_momentum[i] / correction1;
+                const auto v = m_velocity[i] / correction2;
+
+                params[i] -= learningRate * m / (std::sqrt(v) + kEpsilon);
+            }
+        }
+
+    private:
+        static constexpr f64 kBeta1 = 0.9;
+        static constexpr f64 kBeta2 = 0.999;
+        static constexpr f64 kEpsilon = 1.0e-8;
+
+        std::vector<f64> m_momentum;
+        std::vector<f64> m_velocity;
+
+        u32 m_steps{};
+    };
+} // namespace octachoron::util
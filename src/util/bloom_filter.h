@@ -0,0 +1,106 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "../types.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <memory>
+
+namespace octachoron::util {
+    // Split block Bloom filter, as in Parquet: every key sets one bit in each of the eight
+    // 32-bit words of a single 32-byte block, so a query touches one cache line. With 16 bits
+    // per key the false positive rate is about 0.1%. Keys must already be well mixed (zobrist
+    // keys are). Safe to use from multiple threads at once.
+    class BlockedBloomFilter {
+    public:
+        explicit BlockedBloomFilter(usize bytes) :
+                m_blockCount{std::max<usize>(bytes / sizeof(Block), 1)},
+                m_blocks{std::make_unique<Block[]>(m_blockCount)} {}
+
+        // sets the key's bits, -> true if they were all set already
+        bool testAndSet(u64 key) {
+            auto& block = m_blocks[blockIndex(key)];
+            const auto masks = makeMasks(key);
+
+            bool present = true;
+
+            for (usize i = 0; i < kWordsPerBlock; ++i) {
+                // skip the write when possible, most queries on a busy filter are hits
+                if ((block[i].load(std::memory_order::relaxed) & masks[i]) == 0) {
+                    present &= (block[i].fetch_or(masks[i], std::memory_order::relaxed) & masks[i]) != 0;
+                }
+            }
+
+            return present;
+        }
+
+        [[nodiscard]] bool contains(u64 key) const {
+            const auto& block = m_blocks[blockIndex(key)];
+            const auto masks = makeMasks(key);
+
+            for (usize i = 0; i < kWordsPerBlock; ++i) {
+                if ((block[i].load(std::memory_order::relaxed) & masks[i]) == 0) {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        [[nodiscard]] usize bytes() const {
+            return m_blockCount * sizeof(Block);
+        }
+
+    private:
+        static constexpr usize kWordsPerBlock = 8;
+
+        using Block = std::array<std::atomic<u32>, kWordsPerBlock>;
+
+        static constexpr std::array<u32, kWordsPerBlock> kSalts = {
+            0x47b6137b,
+            0x44974d91,
+            0x8824ad5b,
+            0xa2b7289d,
+            0x705495c7,
+            0x2df1424b,
+            0x9efc4947,
+            0x5c6bfb31,
+        };
+
+        usize m_blockCount;
+        std::unique_ptr<Block[]> m_blocks;
+
+        [[nodiscard]] usize blockIndex(u64 key) const {
+            return static_cast<usize>((static_cast<u128>(key >> 32) * m_blockCount) >> 32);
+        }
+
+        [[nodiscard]] static std::array<u32, kWordsPerBlock> makeMasks(u64 key) {
+            std::array<u32, kWordsPerBlock> masks{};
+
+            for (usize i = 0; i < kWordsPerBlock; ++i) {
+                masks[i] = u32{1} << ((static_cast<u32>(key) * kSalts[i]) >> 27);
+            }
+
+            return masks;
+        }
+    };
+} // namespace octachoron::util
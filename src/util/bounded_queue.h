@@ -0,0 +1,113 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "../types.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <memory>
+#include <utility>
+
+namespace octachoron::util {
+    // Dmitry Vyukov's bounded multi-producer multi-consumer queue. Lock free: each slot
+    // carries a sequence number telling producers and consumers whose turn it is.
+    template <typename T>
+    class BoundedQueue {
+    public:
+        // capacity is rounded up to a power of two
+        explicit BoundedQueue(usize capacity) :
+                m_mask{std::bit_ceil(std::max<usize>(capacity, 2)) - 1},
+                m_cells{std::make_unique<Cell[]>(m_mask + 1)} {
+            for (usize i = 0; i <= m_mask; ++i) {
+                m_cells[i].sequence.store(i, std::memory_order::relaxed);
+            }
+        }
+
+        BoundedQueue(const BoundedQueue&) = delete;
+        BoundedQueue(BoundedQueue&&) = delete;
+
+        // -> false if the queue is full, in which case value is left untouched
+        bool tryPush(T& value) {
+            auto pos = m_enqueuePos.load(std::memory_order::relaxed);
+
+            while (true) {
+                auto& cell = m_cells[pos & m_mask];
+
+                const auto sequence = cell.sequence.load(std::memory_order::acquire);
+                const auto diff = static_cast<i64>(sequence) - static_cast<i64>(pos);
+
+                if (diff == 0) {
+                    if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order::relaxed)) {
+                        cell.value = std::move(value);
+                        cell.sequence.store(pos + 1, std::memory_order::release);
+
+                        return true;
+                    }
+                } else if (diff < 0) {
+                    return false;
+                } else {
+                    pos = m_enqueuePos.load(std::memory_order::relaxed);
+                }
+            }
+        }
+
+        // -> false if the queue is empty
+        bool tryPop(T& value) {
+            auto pos = m_dequeuePos.load(std::memory_order::relaxed);
+
+            while (true) {
+                auto& cell = m_cells[pos & m_mask];
+
+                const auto sequence = cell.sequence.load(std::memory_order::acquire);
+                const auto diff = static_cast<i64>(sequence) - static_cast<i64>(pos + 1);
+
+                if (diff == 0) {
+                    if (m_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order::relaxed)) {
+                        value = std::move(cell.value);
+                        cell.sequence.store(pos + m_mask + 1, std::memory_order::release);
+
+                        return true;
+                    }
+                } else if (diff < 0) {
+                    return false;
+                } else {
+                    pos = m_dequeuePos.load(std::memory_order::relaxed);
+                }
+            }
+        }
+
+        BoundedQueue& operator=(const BoundedQueue&) = delete;
+        BoundedQueue& operator=(BoundedQueue&&) = delete;
+
+    private:
+        struct Cell {
+            std::atomic<usize> sequence;
+            T value;
+        };
+
+        usize m_mask;
+        std::unique_ptr<Cell[]> m_cells;
+
+        alignas(64) std::atomic<usize> m_enqueuePos{};
+        alignas(64) std::atomic<usize> m_dequeuePos{};
+    };
+} // namespace octachoron::util
@@ -0,0 +1,113 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "../types.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+
+namespace octachoron::util {
+    // Log-linear histogram of durations: values below 16 are counted exactly, and every power
+    // of two above that is split into 16 buckets, so percentiles come out within about 6% of
+    // the true value over the whole u64 range in under 8 KB. Not thread safe.
+    class LatencyHistogram {
+    public:
+        void record(u64 value) {
+            ++m_counts[bucketOf(value)];
+
+            ++m_count;
+            m_max = std::max(m_max, value);
+        }
+
+        [[nodiscard]] u64 count() const {
+            return m_count;
+        }
+
+        [[nodiscard]] u64 max() const {
+            return m_max;
+        }
+
+        // upper end of the bucket holding the p-th percentile, p in [0, 100]. 0 if empty
+        [[nodiscard]] u64 percentile(f64 p) const {
+            if (m_count == 0) {
+                return 0;
+            }
+
+            const auto rank = std::max<u64>(static_cast<u64>(std::ceil(p / 100.0 * static_cast<f64>(m_count))), 1);
+
+            u64 seen = 0;
+
+            for (usize bucket = 0; bucket < kBucketCount; ++bucket) {
+                seen += m_counts[bucket];
+
+                if (seen >= rank) {
+                    return std::min(bucketUpper(bucket), m_max);
+                }
+            }
+
+            return m_max;
+        }
+
+        void clear() {
+            m_counts.fill(0);
+
+            m_count = 0;
+            m_max = 0;
+        }
+
+    private:
+        static constexpr u32 kSubBucketBits = 4;
+        static constexpr u64 kSubBuckets = u64{1} << kSubBucketBits;
+
+        // one group of sub-buckets for the exact values, then one per power of two above them
+        static constexpr usize kBucketCount = (64 - kSubBucketBits + 1) * kSubBuckets;
+
+        std::array<u64, kBucketCount> m_counts{};
+
+        u64 m_count{};
+        u64 m_max{};
+
+        [[nodiscard]] static usize bucketOf(u64 value) {
+            if (value < kSubBuckets) {
+                return static_cast<usize>(value);
+            }
+
+            // the top kSubBucketBits + 1 bits of the value, the first of which is always set
+            const auto shift = static_cast<u32>(std::bit_width(value)) - kSubBucketBits - 1;
+            const auto sub = (value >> shift) & (kSubBuckets - 1);
+
+            return static_cast<usize>((shift + 1) * kSubBuckets + sub);
+        }
+
+        [[nodiscard]] static u64 bucketUpper(usize bucket) {
+            const auto group = bucket / kSubBuckets;
+            const auto sub = bucket % kSubBuckets;
+
+            if (group == 0) {
+                return sub;
+            }
+
+            const auto lower = (kSubBuckets + sub) << (group - 1);
+            return lower + (u64{1} << (group - 1)) - 1;
+        }
+    };
+} // namespace octachoron::util
@@ -0,0 +1,87 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "mapped_file.h"
+
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace octachoron::util {
+    MappedFile::~MappedFile() {
+        close();
+    }
+
+    MappedFile::MappedFile(MappedFile&& other) noexcept :
+            m_data{std::exchange(other.m_data, nullptr)}, m_size{std::exchange(other.m_size, 0)} {}
+
+    bool MappedFile::open(const std::string& path) {
+        close();
+
+        const auto fd = ::open(path.c_str(), O_RDONLY);
+
+        if (fd < 0) {
+            return false;
+        }
+
+        struct stat info {};
+
+        if (::fstat(fd, &info) != 0 || info.st_size <= 0) {
+            ::close(fd);
+            return false;
+        }
+
+        const auto size = static_cast<usize>(info.st_size);
+        auto* data = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+
+        // the mapping keeps its own reference to the file
+        ::close(fd);
+
+        if (data == MAP_FAILED) {
+            return false;
+        }
+
+        m_data = data;
+        m_size = size;
+
+        return true;
+    }
+
+    void MappedFile::close() {
+        if (m_data) {
+            ::munmap(m_data, m_size);
+        }
+
+        m_data = nullptr;
+        m_size = 0;
+    }
+
+    MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            close();
+
+            m_data = std::exchange(other.m_data, nullptr);
+            m_size = std::exchange(other.m_size, 0);
+        }
+
+        return *this;
+    }
+} // namespace octachoron::util
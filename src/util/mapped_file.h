@@ -0,0 +1,59 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "../types.h"
+
+#include <cstddef>
+#include <span>
+#include <string>
+
+namespace octachoron::util {
+    // read-only memory mapping of a whole file. empty files cannot be mapped
+    class MappedFile {
+    public:
+        MappedFile() = default;
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile(MappedFile&& other) noexcept;
+
+        bool open(const std::string& path);
+        void close();
+
+        [[nodiscard]] inline bool isOpen() const {
+            return m_data != nullptr;
+        }
+
+        [[nodiscard]] inline std::span<const std::byte> data() const {
+            return {static_cast<const std::byte*>(m_data), m_size};
+        }
+
+        [[nodiscard]] inline usize size() const {
+            return m_size;
+        }
+
+        MappedFile& operator=(const MappedFile&) = delete;
+        MappedFile& operator=(MappedFile&& other) noexcept;
+
+    private:
+        void* m_data{};
+        usize m_size{};
+    };
+} // namespace octachoron::util
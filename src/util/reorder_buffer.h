@@ -0,0 +1,93 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "../types.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <memory>
+#include <utility>
+
+namespace octachoron::util {
+    // Hands values out in sequence order, whatever order they come in. Any number of producers,
+    // one consumer. Lock free: each slot carries the sequence number it holds a value for, and
+    // a value may only go in once the one capacity before it has been taken out.
+    template <typename T>
+    class ReorderBuffer {
+    public:
+        // capacity is rounded up to a power of two
+        explicit ReorderBuffer(usize capacity) :
+                m_mask{std::bit_ceil(std::max<usize>(capacity, 2)) - 1},
+                m_slots{std::make_unique<Slot[]>(m_mask + 1)} {}
+
+        ReorderBuffer(const ReorderBuffer&) = delete;
+        ReorderBuffer(ReorderBuffer&&) = delete;
+
+        // -> false if seq is too far ahead of the consumer, in which case value is left untouched
+        bool tryPut(u64 seq, T& value) {
+            if (seq > m_next.load(std::memory_order::acquire) + m_mask) {
+                return false;
+            }
+
+            auto& slot = m_slots[seq & m_mask];
+
+            slot.value = std::move(value);
+            slot.filled.store(seq + 1, std::memory_order::release);
+
+            return true;
+        }
+
+        // -> false if the next value in sequence is not in yet
+        bool tryTake(T& value) {
+            const auto next = m_next.load(std::memory_order::relaxed);
+            auto& slot = m_slots[next & m_mask];
+
+            if (slot.filled.load(std::memory_order::acquire) != next + 1) {
+                return false;
+            }
+
+            value = std::move(slot.value);
+            m_next.store(next + 1, std::memory_order::release);
+
+            return true;
+        }
+
+        // sequence number of the next value out
+        [[nodiscard]] u64 next() const {
+            return m_next.load(std::memory_order::relaxed);
+        }
+
+        ReorderBuffer& operator=(const ReorderBuffer&) = delete;
+        ReorderBuffer& operator=(ReorderBuffer&&) = delete;
+
+    private:
+        struct Slot {
+            // one past the sequence number of the value in the slot
+            std::atomic<u64> filled{};
+            T value{};
+        };
+
+        usize m_mask;
+        std::unique_ptr<Slot[]> m_slots;
+
+        alignas(64) std::atomic<u64> m_next{};
+    };
+} // namespace octachoron::util
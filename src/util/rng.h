@@ -0,0 +1,66 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "../types.h"
+
+#include <bit>
+
+namespace octachoron::util::rng {
+    // Bob Jenkins' small fast noncryptographic prng
+    class Jsf64Rng {
+    public:
+        explicit constexpr Jsf64Rng(u64 seed) :
+                m_b{seed}, m_c{seed}, m_d{seed} {
+            for (usize i = 0; i < 20; ++i) {
+                nextU64();
+            }
+        }
+
+        constexpr u64 nextU64() {
+            const auto e = m_a - std::rotl(m_b, 7);
+
+            m_a = m_b ^ std::rotl(m_c, 13);
+            m_b = m_c + std::rotl(m_d, 37);
+            m_c = m_d + e;
+            m_d = e + m_a;
+
+            return m_d;
+        }
+
+        constexpr u32 nextU32() {
+            return static_cast<u32>(nextU64() >> 32);
+        }
+
+        // [0, bound), with negligible bias for the small bounds this is used with
+        constexpr u32 nextU32(u32 bound) {
+            return static_cast<u32>((static_cast<u64>(nextU32()) * bound) >> 32);
+        }
+
+        constexpr f64 nextF64() {
+            return static_cast<f64>(nextU64() >> 11) * 0x1.0p-53;
+        }
+
+    private:
+        u64 m_a{0xf1ea5eed};
+        u64 m_b;
+        u64 m_c;
+        u64 m_d;
+    };
+} // namespace octachoron::util::rng
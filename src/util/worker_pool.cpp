@@ -0,0 +1,98 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "worker_pool.h"
+
+#include <algorithm>
+
+namespace octachoron::util {
+    WorkerPool::WorkerPool(u32 threads) :
+            m_threadCount{std::max<u32>(threads, 1)} {
+        for (u32 idx = 1; idx < m_threadCount; ++idx) {
+            m_threads.emplace_back([this, idx] { work(idx); });
+        }
+    }
+
+    WorkerPool::~WorkerPool() {
+        {
+            const std::unique_lock lock{m_mutex};
+            m_quit = true;
+        }
+
+        m_started.notify_all();
+
+        for (auto& thread : m_threads) {
+            thread.join();
+        }
+    }
+
+    void WorkerPool::runJob(Job job, const void* context) {
+        {
+            const std::unique_lock lock{m_mutex};
+
+            m_job = job;
+            m_context = context;
+
+            m_running = m_threadCount - 1;
+            ++m_generation;
+        }
+
+        m_started.notify_all();
+
+        job(context, 0);
+
+        std::unique_lock lock{m_mutex};
+        m_finished.wait(lock, [this] { return m_running == 0; });
+    }
+
+    void WorkerPool::work(u32 idx) {
+        u64 generation = 0;
+
+        while (true) {
+            Job job;
+            const void* context;
+
+            {
+                std::unique_lock lock{m_mutex};
+                m_started.wait(lock, [&] { return m_quit || m_generation != generation; });
+
+                if (m_quit) {
+                    return;
+                }
+
+                generation = m_generation;
+
+                job = m_job;
+                context = m_context;
+            }
+
+            job(context, idx);
+
+            bool last;
+
+            {
+                const std::unique_lock lock{m_mutex};
+                last = --m_running == 0;
+            }
+
+            if (last) {
+                m_finished.notify_one();
+            }
+        }
+    }
+} // namespace octachoron::util
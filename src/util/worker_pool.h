@@ -0,0 +1,77 @@
+/*
+ * Octachoron, a Pijersi engine
+ * Copyright (C) 2024 Ciekce
+ *
+ * Octachoron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Octachoron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Octachoron. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "../types.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace octachoron::util {
+    // A fixed set of threads that all run the same job together, for work split into one part
+    // per thread and repeated many times, such as every epoch of a full-batch optimiser. The
+    // threads are started once and wait for the next job in between, instead of being spawned
+    // and joined for every call.
+    class WorkerPool {
+    public:
+        explicit WorkerPool(u32 threads);
+        ~WorkerPool();
+
+        WorkerPool(const WorkerPool&) = delete;
+        WorkerPool(WorkerPool&&) = delete;
+
+        [[nodiscard]] inline u32 threadCount() const {
+            return m_threadCount;
+        }
+
+        // Calls f(idx) once for every idx below threadCount(), the calling thread taking 0, and
+        // returns once they have all returned. Not reentrant, and only one thread may call it.
+        template <typename F>
+        void run(const F& f) {
+            runJob([](const void* context, u32 idx) { (*static_cast<const F*>(context))(idx); }, &f);
+        }
+
+        WorkerPool& operator=(const WorkerPool&) = delete;
+        WorkerPool& operator=(WorkerPool&&) = delete;
+
+    private:
+        using Job = void (*)(const void*, u32);
+
+        u32 m_threadCount;
+
+        std::mutex m_mutex{};
+        std::condition_variable m_started{};
+        std::condition_variable m_finished{};
+
+        Job m_job{};
+        const void* m_context{};
+
+        // bumped for every job, so that each worker runs it exactly once
+        u64 m_generation{};
+        u32 m_running{};
+        bool m_quit{false};
+
+        std::vector<std::thread> m_threads{};
+
+        void runJob(Job job, const void* context);
+        void work(u32 idx);
+    };
+} // namespace octachoron::util